@@ -265,6 +265,8 @@ void {name}::GetEvent(std::shared_ptr <JEvent> event) {{
     /// If you are streaming events and there are no new events in the message queue,
     /// tell JANA that GetEvent() was temporarily unsuccessful like this:
     // throw RETURN_STATUS::kBUSY;
+    /// If that happens often, e.g. because you are polling a socket, implement TryGetEvent() instead of GetEvent()
+    /// and return ReturnStatus::TryAgain or ReturnStatus::Finished, which avoids the cost of throwing.
 }}
 
 std::string {name}::GetDescription() {{
@@ -34,10 +34,10 @@ class BlockExampleSource : public JBlockedEventSource<MyBlock> {
 		return Status::Success;
 	}
 
-	virtual std::vector<std::shared_ptr<JEvent>> DisentangleBlock(MyBlock& block, JEventPool& pool) {
+	virtual std::vector<JEvent*> DisentangleBlock(MyBlock& block, JEventPool& pool) {
 
 		LOG_DEBUG(m_logger) <<  "JBlockedEventSource::DisentangleBlock" << LOG_END;
-		std::vector<std::shared_ptr<JEvent>> events;
+		std::vector<JEvent*> events;
 		for (auto datum : block.data) {
 			auto event = pool.get(0);  // TODO: Make location be transparent to end user
 			event->Insert(new MyObject(datum));
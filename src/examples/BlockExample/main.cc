@@ -21,7 +21,7 @@ int main(int argc, char* argv[]) {
 	auto topology = new JArrowTopology;
 
 	auto block_queue = new JMailbox<MyBlock*>;
-	auto event_queue = new JMailbox<std::shared_ptr<JEvent>>;
+	auto event_queue = new JMailbox<JEvent*>;
 
 	topology->component_manager = app.GetService<JComponentManager>();  // Ensure the lifespan of the component manager exceeds that of the topology
 	topology->event_pool = std::make_shared<JEventPool>(&topology->component_manager->get_fac_gens(), false, 20, 1, true);
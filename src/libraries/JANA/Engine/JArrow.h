@@ -11,12 +11,13 @@
 
 #include "JActivable.h"
 #include "JArrowMetrics.h"
+#include "JIdlePolicy.h"
 
 class JArrow : public JActivable {
 
 public:
     enum class NodeType {Source, Sink, Stage, Group};
-    enum class BackoffStrategy { Constant, Linear, Exponential };
+    enum class BackoffStrategy { Constant, Linear, Exponential, Adaptive };
     using duration_t = std::chrono::steady_clock::duration;
 
 private:
@@ -27,7 +28,7 @@ private:
 
     // Statuses
     JArrowMetrics m_metrics;      // Performance information accumulated over all workers
-    size_t m_thread_count = 0;    // Current number of threads assigned to this arrow
+    std::atomic<size_t> m_thread_count {0};  // Current number of threads assigned to this arrow
     std::atomic_bool m_is_upstream_finished {false };  // TODO: Deprecated. Use m_status instead.
     //Status m_status = Status::Unopened;  // Lives in JActivable for now
 
@@ -37,6 +38,7 @@ private:
     duration_t m_initial_backoff_time = std::chrono::microseconds(1);
     duration_t m_checkin_time = std::chrono::milliseconds(500);
     unsigned m_backoff_tries = 4;
+    JIdlePolicy m_idle_policy;    // Only used when m_backoff_strategy == Adaptive
 
     mutable std::mutex m_mutex;   // Protects access to arrow properties.
                                  // TODO: Consider storing and protect thread count differently,
@@ -108,6 +110,16 @@ public:
         m_initial_backoff_time = initial_backoff_time;
     }
 
+    JIdlePolicy get_idle_policy() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_idle_policy;
+    }
+
+    void set_idle_policy(const JIdlePolicy& idle_policy) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_idle_policy = idle_policy;
+    }
+
     const duration_t& get_checkin_time() const {
         std::lock_guard<std::mutex> lock(m_mutex);
         return m_checkin_time;
@@ -119,15 +131,31 @@ public:
     }
 
     void update_thread_count(int thread_count_delta) {
-        std::lock_guard<std::mutex> lock(m_mutex);
         m_thread_count += thread_count_delta;
     }
 
     size_t get_thread_count() {
-        std::lock_guard<std::mutex> lock(m_mutex);
         return m_thread_count;
     }
 
+    /// Atomically claims a thread slot on this arrow. Parallel arrows always succeed;
+    /// sequential arrows succeed only if no other thread currently holds them.
+    /// This lets schedulers assign arrows without holding a global lock.
+    bool try_acquire_thread() {
+        if (m_is_parallel) {
+            m_thread_count.fetch_add(1);
+            return true;
+        }
+        size_t expected = 0;
+        return m_thread_count.compare_exchange_strong(expected, 1);
+    }
+
+    /// Releases a thread slot claimed via try_acquire_thread() or update_thread_count(1).
+    /// Returns the number of threads still assigned to this arrow afterwards.
+    size_t release_thread() {
+        return m_thread_count.fetch_sub(1) - 1;
+    }
+
     // TODO: Metrics should be encapsulated so that only actions are to update, clear, or summarize
     JArrowMetrics& get_metrics() {
         return m_metrics;
@@ -167,6 +195,11 @@ public:
 
     virtual void set_threshold(size_t /* threshold */) {}
 
+    /// Occupancy of the mailbox this arrow pushes into, if any. Schedulers use this to detect backpressure.
+    virtual size_t get_output_pending() { return 0; }
+
+    virtual size_t get_output_threshold() { return 0; }
+
     void set_active(bool is_active) override {
         if (is_active) {
             assert(m_status != Status::Closed);
@@ -165,6 +165,13 @@ public:
         return m_last_status;
     }
 
+    /// Average latency per message over the most recent execute() which processed anything
+    duration_t get_last_latency_per_message() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_last_message_count == 0) return duration_t::zero();
+        return m_last_latency / m_last_message_count;
+    }
+
     void summarize() {
 
     }
@@ -20,6 +20,16 @@ std::ostream& operator<<(std::ostream& os, const JArrowPerfSummary& s) {
     os << "  Sequential bottleneck [Hz]:  " << std::setprecision(3) << s.avg_seq_bottleneck_hz << std::endl;
     os << "  Parallel bottleneck [Hz]:    " << std::setprecision(3) << s.avg_par_bottleneck_hz << std::endl;
     os << "  Efficiency [0..1]:           " << std::setprecision(3) << s.avg_efficiency_frac << std::endl;
+    if (s.arena_allocations_per_event != 0) {
+        os << "  Arena allocations/event:     " << std::setprecision(4) << s.arena_allocations_per_event
+           << " (" << s.arena_bytes_per_event << " bytes)" << std::endl;
+    }
+    if (s.reorder_window_capacity != 0) {
+        os << "  Reorder window [count]:      " << s.reorder_window_occupancy << " / " << s.reorder_window_capacity
+           << " (max " << s.reorder_window_max_occupancy << ")" << std::endl;
+        os << "  Reorder stall time [ms]:     " << std::setprecision(4) << s.reorder_window_stall_time_ms << std::endl;
+        os << "  Reorder backpressure [count]: " << s.reorder_window_backpressure_count << std::endl;
+    }
     os << std::endl;
 
     os << "  +--------------------------+------------+--------+-----+---------+-------+--------+---------+-------------+" << std::endl;
@@ -68,10 +78,10 @@ std::ostream& operator<<(std::ostream& os, const JArrowPerfSummary& s) {
     os << "  +--------------------------+-------------+--------------+----------------+--------------+----------------+" << std::endl;
 
 
-    os << "  +----+----------------------+-------------+------------+-----------+----------------+------------------+" << std::endl;
-    os << "  | ID | Last arrow name      | Useful time | Retry time | Idle time | Scheduler time | Scheduler visits |" << std::endl;
-    os << "  |    |                      |     [ms]    |    [ms]    |    [ms]   |      [ms]      |     [count]      |" << std::endl;
-    os << "  +----+----------------------+-------------+------------+-----------+----------------+------------------+" << std::endl;
+    os << "  +----+----------------------+-------------+------------+-----------+-----------+----------------+------------------+" << std::endl;
+    os << "  | ID | Last arrow name      | Useful time | Retry time | Idle time | Spin time | Scheduler time | Scheduler visits |" << std::endl;
+    os << "  |    |                      |     [ms]    |    [ms]    |    [ms]   |    [ms]   |      [ms]      |     [count]      |" << std::endl;
+    os << "  +----+----------------------+-------------+------------+-----------+-----------+----------------+------------------+" << std::endl;
 
     for (auto ws : s.workers) {
         os << "  |"
@@ -80,11 +90,31 @@ std::ostream& operator<<(std::ostream& os, const JArrowPerfSummary& s) {
            << std::setw(12) << std::right << ws.last_useful_time_ms << " |"
            << std::setw(11) << ws.last_retry_time_ms << " |"
            << std::setw(10) << ws.last_idle_time_ms << " |"
+           << std::setw(10) << ws.last_spin_time_ms << " |"
            << std::setw(15) << ws.last_scheduler_time_ms << " |"
            << std::setw(17) << ws.scheduler_visit_count << " |"
            << std::endl;
     }
-    os << "  +----+----------------------+-------------+------------+-----------+----------------+------------------+" << std::endl;
+    os << "  +----+----------------------+-------------+------------+-----------+-----------+----------------+------------------+" << std::endl;
+
+    if (s.steals_per_location.size() > 1) {
+        auto get_count = [](const std::vector<size_t>& counts, size_t loc_id) -> size_t {
+            return (loc_id < counts.size()) ? counts[loc_id] : 0;
+        };
+        os << "  +----------+---------------+--------------+---------------+" << std::endl;
+        os << "  | Location | Stolen events | Local events | Remote events |" << std::endl;
+        os << "  |          |    [count]    |    [count]   |    [count]    |" << std::endl;
+        os << "  +----------+---------------+--------------+---------------+" << std::endl;
+        for (size_t loc_id=0; loc_id<s.steals_per_location.size(); ++loc_id) {
+            os << "  |"
+               << std::setw(9) << std::right << loc_id << " |"
+               << std::setw(14) << s.steals_per_location[loc_id] << " |"
+               << std::setw(13) << get_count(s.local_events_per_location, loc_id) << " |"
+               << std::setw(14) << get_count(s.remote_events_per_location, loc_id) << " |"
+               << std::endl;
+        }
+        os << "  +----------+---------------+--------------+---------------+" << std::endl;
+    }
     return os;
 }
 
@@ -44,10 +44,12 @@ struct WorkerSummary {
     double total_useful_time_ms;
     double total_retry_time_ms;
     double total_idle_time_ms;
+    double total_spin_time_ms;
     double total_scheduler_time_ms;
     double last_useful_time_ms;
     double last_retry_time_ms;
     double last_idle_time_ms;
+    double last_spin_time_ms;
     double last_scheduler_time_ms;
     long scheduler_visit_count;
     std::string last_arrow_name;
@@ -66,6 +68,20 @@ struct JArrowPerfSummary : public JPerfSummary {
 
     std::vector<WorkerSummary> workers;
     std::vector<ArrowSummary> arrows;
+    std::vector<size_t> steals_per_location;  // Items stolen by each location from its siblings, summed over all mailboxes
+    std::vector<size_t> local_events_per_location;   // Events owned by each location which were used by that location
+    std::vector<size_t> remote_events_per_location;  // Events owned by each location which were used by another location
+
+    // Per-event arena usage, averaged over all events recycled so far
+    double arena_allocations_per_event = 0;
+    double arena_bytes_per_event = 0;
+
+    // Reordering ahead of processors which want ordered events. Capacity is 0 if there are none.
+    size_t reorder_window_capacity = 0;
+    size_t reorder_window_occupancy = 0;
+    size_t reorder_window_max_occupancy = 0;
+    size_t reorder_window_backpressure_count = 0;
+    double reorder_window_stall_time_ms = 0;
 
     JArrowPerfSummary() = default;
     JArrowPerfSummary(const JArrowPerfSummary&) = default;
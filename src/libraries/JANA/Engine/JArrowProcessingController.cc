@@ -4,6 +4,8 @@
 
 #include <JANA/Engine/JArrowProcessingController.h>
 #include <JANA/Engine/JArrowPerfSummary.h>
+#include <JANA/Engine/JWorkStealingScheduler.h>
+#include <JANA/Engine/JBackpressureScheduler.h>
 #include <JANA/Utils/JCpuInfo.h>
 #include <JANA/JLogger.h>
 
@@ -23,11 +25,27 @@ void JArrowProcessingController::acquire_services(JServiceLocator * sl) {
     params->SetDefaultParameter("jana:timeout", m_timeout_s, "Max. time (in seconds) system will wait for a thread to update its heartbeat before killing it and launching a new one.");
     params->SetDefaultParameter("jana:warmup_timeout", m_warmup_timeout_s, "Max. time (in seconds) system will wait for the initial events to complete before killing program.");
     // Originally "THREAD_TIMEOUT" and "THREAD_TIMEOUT_FIRST_EVENT"
+
+    params->SetDefaultParameter("jana:scheduler", m_scheduler_choice, "0: Round-robin scheduler, 1: Work-stealing scheduler, 2: Backpressure-aware scheduler");
+
+    int idle_park_timeout_us = std::chrono::duration_cast<std::chrono::microseconds>(m_idle_policy.park_timeout).count();
+    params->SetDefaultParameter("jana:idle_spin_tries", m_idle_policy.spin_tries, "Number of times an idle worker spins before it starts yielding");
+    params->SetDefaultParameter("jana:idle_yield_tries", m_idle_policy.yield_tries, "Number of times an idle worker yields before it starts parking");
+    params->SetDefaultParameter("jana:idle_park_timeout_us", idle_park_timeout_us, "Max. time (in microseconds) an idle worker stays parked before checking in again");
+    m_idle_policy.park_timeout = std::chrono::microseconds(idle_park_timeout_us);
 }
 
 void JArrowProcessingController::initialize() {
 
-    m_scheduler = new JScheduler(m_topology->arrows);
+    if (m_scheduler_choice == 1) {
+        m_scheduler = new JWorkStealingScheduler(m_topology->arrows);
+    }
+    else if (m_scheduler_choice == 2) {
+        m_scheduler = new JBackpressureScheduler(m_topology->arrows);
+    }
+    else {
+        m_scheduler = new JScheduler(m_topology->arrows);
+    }
     m_scheduler->logger = m_scheduler_logger;
     LOG_INFO(m_logger) << m_topology->mapping << LOG_END;
 }
@@ -50,6 +68,8 @@ void JArrowProcessingController::scale(size_t nthreads) {
 
         auto worker = new JWorker(m_scheduler, next_worker_id, next_cpu_id, next_loc_id, pin_to_cpu);
         worker->logger = m_worker_logger;
+        worker->set_idle_policy(m_idle_policy);
+        worker->set_wakeup_signal(m_topology->wakeup_signal.get());
         m_workers.push_back(worker);
         next_worker_id++;
     }
@@ -231,6 +251,44 @@ std::unique_ptr<const JArrowPerfSummary> JArrowProcessingController::measure_int
         m_perf_summary.arrows.push_back(summary);
     }
 
+    // Work stealing across locations
+    m_perf_summary.steals_per_location.assign(m_topology->mapping.get_loc_count(), 0);
+    for (auto queue : m_topology->queues) {
+        for (size_t loc_id=0; loc_id<queue->get_locations_count() && loc_id<m_perf_summary.steals_per_location.size(); ++loc_id) {
+            m_perf_summary.steals_per_location[loc_id] += queue->get_steal_count(loc_id);
+        }
+    }
+
+    // Local vs remote use of each location's events
+    m_perf_summary.local_events_per_location.clear();
+    m_perf_summary.remote_events_per_location.clear();
+    if (m_topology->event_pool != nullptr) {
+        for (size_t loc_id=0; loc_id<m_topology->event_pool->get_location_count(); ++loc_id) {
+            m_perf_summary.local_events_per_location.push_back(m_topology->event_pool->get_local_use_count(loc_id));
+            m_perf_summary.remote_events_per_location.push_back(m_topology->event_pool->get_remote_use_count(loc_id));
+        }
+    }
+
+    // Arena usage
+    if (m_topology->event_pool != nullptr) {
+        size_t recycled_count, allocation_count, byte_count;
+        m_topology->event_pool->get_arena_usage(recycled_count, allocation_count, byte_count);
+        if (recycled_count != 0) {
+            m_perf_summary.arena_allocations_per_event = double(allocation_count) / recycled_count;
+            m_perf_summary.arena_bytes_per_event = double(byte_count) / recycled_count;
+        }
+    }
+
+    // Reordering
+    auto reorder_window = m_topology->reorder_window;
+    if (reorder_window != nullptr) {
+        m_perf_summary.reorder_window_capacity = reorder_window->get_capacity();
+        m_perf_summary.reorder_window_occupancy = reorder_window->get_occupancy();
+        m_perf_summary.reorder_window_max_occupancy = reorder_window->get_max_occupancy();
+        m_perf_summary.reorder_window_backpressure_count = reorder_window->get_backpressure_count();
+        m_perf_summary.reorder_window_stall_time_ms = millisecs(reorder_window->get_stall_time()).count();
+    }
+
     // bottlenecks
     m_perf_summary.avg_seq_bottleneck_hz = 1e3 / worst_seq_latency;
     m_perf_summary.avg_par_bottleneck_hz = 1e3 * m_perf_summary.thread_count / worst_par_latency;
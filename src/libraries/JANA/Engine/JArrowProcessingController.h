@@ -43,6 +43,8 @@ private:
     using jclock_t = std::chrono::steady_clock;
     int m_timeout_s = 8;
     int m_warmup_timeout_s = 30;
+    int m_scheduler_choice = 0;
+    JIdlePolicy m_idle_policy;
 
     JArrowPerfSummary m_perf_summary;
     JArrowTopology* m_topology;       // Owned by JArrowProcessingController
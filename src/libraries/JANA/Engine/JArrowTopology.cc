@@ -49,6 +49,7 @@ void JArrowTopology::set_active(bool active) {
                 arrow->finalize();
             }
         }
+        wakeup_signal->notify();
     }
 }
 
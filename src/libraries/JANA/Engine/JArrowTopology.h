@@ -13,13 +13,16 @@
 #include <JANA/Utils/JProcessorMapping.h>
 
 #include "JActivable.h"
+#include "JFactoryPrefetcher.h"
 #include "JArrow.h"
 #include "JMailbox.h"
+#include "JReorderWindow.h"
+#include "JWakeupSignal.h"
 
 
 struct JArrowTopology : public JActivable {
 
-    using Event = std::shared_ptr<JEvent>;
+    using Event = JEvent*;
     using EventQueue = JMailbox<Event>;
 
     enum Status { Inactive, Running, Draining, Finished };
@@ -40,6 +43,9 @@ struct JArrowTopology : public JActivable {
     std::vector<JArrow*> sinks;             // Sinks needed for finished message count // TODO: Not anymore
     std::vector<EventQueue*> queues;        // Queues shared between arrows
     JProcessorMapping mapping;
+    std::unique_ptr<JWakeupSignal> wakeup_signal {new JWakeupSignal};  // Notified by queues and the event pool, so that idle workers can park
+    std::shared_ptr<JReorderWindow<Event>> reorder_window;  // Only present if some processor wants ordered events
+    std::shared_ptr<JFactoryPrefetcher> prefetcher;         // Only present if jana:intra_event_threads > 0
 
     size_t event_pool_size;                 //  Will be defaulted to nthreads later
     bool limit_total_events_in_flight = true;
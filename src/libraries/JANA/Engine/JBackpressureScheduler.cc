@@ -0,0 +1,120 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include <JANA/Engine/JBackpressureScheduler.h>
+
+#include <algorithm>
+
+
+JBackpressureScheduler::JBackpressureScheduler(const std::vector<JArrow*>& arrows)
+    : JScheduler(arrows) {}
+
+
+double JBackpressureScheduler::score(JArrow* arrow, double max_latency_ms) {
+    using millis = std::chrono::duration<double, std::milli>;
+    return score(arrow, millis(arrow->get_metrics().get_last_latency_per_message()).count(), max_latency_ms);
+}
+
+
+double JBackpressureScheduler::score(JArrow* arrow, double latency_ms, double max_latency_ms) {
+
+    // Upstream backlog: Is there anything in our input mailbox, and how full is it? Any backlog at all
+    // outranks an idle source, so that events get drained before new ones get emitted. Sources don't
+    // have an input mailbox, so as far as we are concerned they always have work available.
+    double backlog = 1.0;
+    size_t threshold = arrow->get_threshold();
+    if (arrow->get_type() != JArrow::NodeType::Source && threshold != 0) {
+        size_t pending = arrow->get_pending();
+        backlog = (pending == 0) ? 0.0 : 1.0 + std::min(1.0, static_cast<double>(pending) / threshold);
+    }
+
+    // Downstream free capacity: How much room is left in our output mailbox?
+    // Sinks don't have one, so they are never backpressured.
+    double free_capacity = 1.0;
+    size_t output_threshold = arrow->get_output_threshold();
+    if (output_threshold != 0) {
+        free_capacity = std::max(0.0, 1.0 - static_cast<double>(arrow->get_output_pending()) / output_threshold);
+    }
+
+    // Recent latency: Slow arrows are the bottleneck, so they deserve more threads
+    double latency_boost = 1.0;
+    if (max_latency_ms > 0) {
+        latency_boost += latency_ms / max_latency_ms;
+    }
+
+    double weight = (arrow->get_type() == JArrow::NodeType::Source) ? source_weight : 1.0;
+    return backlog * free_capacity * latency_boost * weight;
+}
+
+
+JArrow* JBackpressureScheduler::next_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status last_result) {
+
+    using millis = std::chrono::duration<double, std::milli>;
+
+    // Check latest arrow back in
+    if (assignment != nullptr) {
+        release(assignment);
+    }
+
+    // Each latency lives behind the arrow's metrics mutex, so read each of them only once.
+    // The scratch space is per thread, so that scheduling doesn't allocate.
+    size_t arrow_count = m_arrows.size();
+    if (arrow_count == 0) return nullptr;
+    thread_local std::vector<double> scores;
+    scores.resize(arrow_count);
+
+    double max_latency_ms = 0;
+    for (size_t i=0; i<arrow_count; ++i) {
+        scores[i] = millis(m_arrows[i]->get_metrics().get_last_latency_per_message()).count();
+        max_latency_ms = std::max(max_latency_ms, scores[i]);
+    }
+
+    // Score every arrow which could plausibly be assigned. Arrows which can't get a score of -1.
+    for (size_t i=0; i<arrow_count; ++i) {
+        JArrow* candidate = m_arrows[i];
+        if (candidate->is_upstream_finished() || (!candidate->is_parallel() && candidate->get_thread_count() != 0)) {
+            scores[i] = -1;
+            continue;
+        }
+        scores[i] = score(candidate, scores[i], max_latency_ms);
+        if (candidate == assignment && last_result != JArrowMetrics::Status::KeepGoing) {
+            scores[i] *= comebacklater_penalty;
+        }
+    }
+
+    // Pick the highest score. We scan starting from a rotating offset and only switch on a strictly higher
+    // score, so that ties are broken round-robin. Another worker may have claimed a sequential arrow since
+    // we looked, in which case we fall through to the runner-up.
+    size_t start_idx = m_rotation.fetch_add(1) % arrow_count;
+    while (true) {
+        size_t best_idx = arrow_count;
+        for (size_t i=0; i<arrow_count; ++i) {
+            size_t idx = (start_idx + i) % arrow_count;
+            if (scores[idx] >= 0 && (best_idx == arrow_count || scores[idx] > scores[best_idx])) {
+                best_idx = idx;
+            }
+        }
+        if (best_idx == arrow_count) return nullptr;
+
+        JArrow* best = m_arrows[best_idx];
+        if (try_assign(best)) {
+            LOG_DEBUG(logger) << "Worker " << worker_id << ", "
+                              << ((assignment == nullptr) ? "idle" : assignment->get_name())
+                              << ", " << to_string(last_result) << " => "
+                              << best->get_name() << "  [score=" << scores[best_idx] << "]" << LOG_END;
+            return best;
+        }
+        scores[best_idx] = -1;
+    }
+}
+
+
+void JBackpressureScheduler::last_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status result) {
+
+    LOG_DEBUG(logger) << "Worker " << worker_id << ", "
+                      << ((assignment == nullptr) ? "idle" : assignment->get_name())
+                      << ", " << to_string(result) << ") => Shutting down!" << LOG_END;
+    if (assignment != nullptr) {
+        release(assignment);  // We may be the last one out of a finished arrow, which then has to deactivate
+    }
+}
@@ -0,0 +1,50 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef JANA2_JBACKPRESSURESCHEDULER_H
+#define JANA2_JBACKPRESSURESCHEDULER_H
+
+#include <atomic>
+#include <vector>
+
+#include <JANA/Engine/JScheduler.h>
+
+
+/// JBackpressureScheduler assigns each Worker the eligible arrow with the highest score, where
+/// the score rewards a nonempty input mailbox (upstream backlog), penalizes a full output mailbox
+/// (downstream backpressure), and favors arrows whose recent per-event latency is high, since
+/// those are the ones which need the most threads to keep up. Sources are additionally
+/// down-weighted, so that workers drain the topology before they feed it. The net effect is
+/// that throughput stays high while the number of in-flight events stays small.
+///
+/// An arrow which just returned anything other than KeepGoing to this Worker is penalized, so the
+/// Worker doesn't immediately bounce back to it. Ties (including the all-zero case, which we need
+/// in order to discover that arrows have finished) are broken round-robin.
+///
+/// Like JWorkStealingScheduler, this doesn't take a global lock; assignments are claimed via
+/// JScheduler::try_assign(). Select it via `jana:scheduler=2`.
+class JBackpressureScheduler : public JScheduler {
+
+private:
+    std::atomic<size_t> m_rotation {0};  // Where the next tie-breaking pass over the arrows starts
+
+    double score(JArrow* arrow, double latency_ms, double max_latency_ms);
+
+public:
+    /// Multiplier applied to source arrows' scores
+    double source_weight = 0.5;
+
+    /// Multiplier applied to the arrow the Worker is checking in, unless it returned KeepGoing
+    double comebacklater_penalty = 0.25;
+
+    explicit JBackpressureScheduler(const std::vector<JArrow*>& arrows);
+
+    JArrow* next_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status result) override;
+    void last_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status result) override;
+
+    /// Score is in [0, 4]. Exposed so that it can be tested and reported.
+    double score(JArrow* arrow, double max_latency_ms);
+};
+
+
+#endif //JANA2_JBACKPRESSURESCHEDULER_H
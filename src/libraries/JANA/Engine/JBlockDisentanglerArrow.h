@@ -13,7 +13,7 @@ template <typename T>
 class JBlockDisentanglerArrow : public JArrow {
 	JBlockedEventSource<T>* m_source;  // non-owning
 	JMailbox<T*>* m_block_queue; // owning
-	JMailbox<std::shared_ptr<JEvent>>* m_event_queue; // non-owning
+	JMailbox<JEvent*>* m_event_queue; // non-owning
 	std::shared_ptr<JEventPool> m_pool;
 	JLogger m_logger {JLogger::Level::DEBUG};
 
@@ -23,7 +23,7 @@ public:
 	JBlockDisentanglerArrow(std::string name,
 							JBlockedEventSource<T>* source,
 							JMailbox<T*>* block_queue,
-							JMailbox<std::shared_ptr<JEvent>>* event_queue,
+							JMailbox<JEvent*>* event_queue,
 							std::shared_ptr<JEventPool> pool
 							)
 							: JArrow(std::move(name), true, NodeType::Stage, 1)
@@ -58,7 +58,7 @@ public:
 		int reserved_blocks = reserved_events / m_max_events_per_block; // truncate
 
 		std::vector<T*> block_buffer; // TODO: Get rid of allocations
-		std::vector<std::shared_ptr<JEvent>> event_buffer;
+		std::vector<JEvent*> event_buffer;
 
 		auto input_queue_status = m_block_queue->pop(block_buffer, reserved_blocks, location_id);
 		for (auto block : block_buffer) {
@@ -4,6 +4,7 @@
 
 
 #include <JANA/Engine/JEventProcessorArrow.h>
+#include <JANA/Engine/JFactoryPrefetcher.h>
 #include <JANA/Utils/JEventPool.h>
 #include <JANA/JEventProcessor.h>
 #include <JANA/JEventSource.h>
@@ -12,8 +13,9 @@
 JEventProcessorArrow::JEventProcessorArrow(std::string name,
                                            EventQueue *input_queue,
                                            EventQueue *output_queue,
-                                           std::shared_ptr<JEventPool> pool)
-        : JArrow(std::move(name), true, NodeType::Sink)
+                                           std::shared_ptr<JEventPool> pool,
+                                           bool is_parallel)
+        : JArrow(std::move(name), is_parallel, (output_queue == nullptr) ? NodeType::Sink : NodeType::Stage)
         , m_input_queue(input_queue)
         , m_output_queue(output_queue)
         , m_pool(std::move(pool)) {
@@ -32,40 +34,85 @@ void JEventProcessorArrow::add_processor(JEventProcessor* processor) {
     m_processors.push_back(processor);
 }
 
+void JEventProcessorArrow::set_reorder_window(std::shared_ptr<JReorderWindow<Event>> window) {
+    if (is_parallel()) {
+        throw JException("JEventProcessorArrow '%s' must be sequential in order to deliver events in order", get_name().c_str());
+    }
+    m_reorder_window = std::move(window);
+}
+
+void JEventProcessorArrow::set_prefetcher(std::shared_ptr<JFactoryPrefetcher> prefetcher, bool begins_events, bool ends_events) {
+    m_prefetcher = std::move(prefetcher);
+    m_begins_events = begins_events;
+    m_ends_events = ends_events;
+}
+
 void JEventProcessorArrow::execute(JArrowMetrics& result, size_t location_id) {
 
     auto start_total_time = std::chrono::steady_clock::now();
 
-    Event x;
-    bool success;
-    auto in_status = m_input_queue->pop(x, success, location_id);
+    // Process up to chunksize events per visit, so that the mailbox locks, the clock reads, and the
+    // scheduler round trip are paid once per batch rather than once per event.
+    auto chunksize = get_chunksize();
+    size_t reserved_count = 0;
+    if (m_output_queue != nullptr) {
+        reserved_count = m_output_queue->reserve(chunksize, location_id);
+        chunksize = reserved_count;
+    }
+
+    // Parallel arrows run on several workers at once, so each worker keeps a buffer of its own. Either way the
+    // buffer keeps its capacity from one batch to the next, so that steady-state batches don't allocate.
+    static thread_local std::vector<Event> worker_buffer;
+    auto& xs = is_parallel() ? worker_buffer : m_buffer;
+    xs.clear();  // In case a processor threw partway through the previous batch
+    auto in_status = EventQueue::Status::Full;  // If we can't reserve any output space, we have to come back later
+    if (chunksize != 0) {
+        in_status = m_input_queue->pop(xs, chunksize, location_id);
+    }
     LOG_DEBUG(m_logger) << "EventProcessorArrow '" << get_name() << "' [" << location_id << "]: "
-                        << "pop() returned " << ((success) ? "success" : "failure")
-                        << "; queue is now " << in_status << LOG_END;
+                        << "pop() returned " << xs.size() << " events; queue is now " << in_status << LOG_END;
+
+    if (m_reorder_window != nullptr) {
+        // Park whatever we just popped, and only process the events which are next in line
+        for (Event& x : xs) {
+            auto index = x->GetEventIndex();
+            m_reorder_window->insert(index, std::move(x));
+        }
+        xs.clear();
+        m_reorder_window->pop_ready(xs);
+    }
 
     auto start_latency_time = std::chrono::steady_clock::now();
-    if (success) {
+    for (Event& x : xs) {
         LOG_DEBUG(m_logger) << "EventProcessorArrow '" << get_name() << "': Starting event# " << x->GetEventNumber() << LOG_END;
+        if (m_prefetcher != nullptr && m_begins_events) {
+            m_prefetcher->begin_event(x);
+        }
         for (JEventProcessor* processor : m_processors) {
-            processor->DoMap(x);
+            processor->DoMap(x->mConstHandle);
+        }
+        if (m_prefetcher != nullptr && m_ends_events) {
+            m_prefetcher->end_event(x);
         }
         LOG_DEBUG(m_logger) << "EventProcessorArrow '" << get_name() << "': Finished event# " << x->GetEventNumber() << LOG_END;
     }
+    auto message_count = xs.size();
     auto end_latency_time = std::chrono::steady_clock::now();
 
     auto out_status = EventQueue::Status::Ready;
 
-    if (success) {
-        if (m_output_queue != nullptr) {
-            // This is NOT the last arrow in the topology. Pass the event onwards.
-            out_status = m_output_queue->push(x, location_id);
-        }
-        else {
-            // This IS the last arrow in the topology. Notify the event source and return event to the pool.
+    if (m_output_queue != nullptr) {
+        // This is NOT the last arrow in the topology. Pass the events onwards, releasing any unused reservation.
+        out_status = m_output_queue->push(xs, reserved_count, location_id);
+    }
+    else if (!xs.empty()) {
+        // This IS the last arrow in the topology. Notify the event sources and return the events to the pool.
+        for (Event& x : xs) {
             x->GetJEventSource()->DoFinish(*x);
-            m_pool->put(x, location_id);
         }
+        m_pool->put(xs, location_id);
     }
+    xs.clear();
     auto end_queue_time = std::chrono::steady_clock::now();
 
     JArrowMetrics::Status status;
@@ -81,7 +128,7 @@ void JEventProcessorArrow::execute(JArrowMetrics& result, size_t location_id) {
     }
     auto latency = (end_latency_time - start_latency_time);
     auto overhead = (end_queue_time - start_total_time) - latency;
-    result.update(status, success, 1, latency, overhead);
+    result.update(status, message_count, 1, latency, overhead);
 }
 
 void JEventProcessorArrow::initialize() {
@@ -109,3 +156,10 @@ void JEventProcessorArrow::set_threshold(size_t threshold) {
     m_input_queue->set_threshold(threshold);
 }
 
+size_t JEventProcessorArrow::get_output_pending() {
+    return (m_output_queue == nullptr) ? 0 : m_output_queue->size();
+}
+
+size_t JEventProcessorArrow::get_output_threshold() {
+    return (m_output_queue == nullptr) ? 0 : m_output_queue->get_threshold();
+}
@@ -9,13 +9,15 @@
 #include <JANA/JEventProcessor.h>
 #include <JANA/Engine/JArrow.h>
 #include <JANA/Engine/JMailbox.h>
+#include <JANA/Engine/JReorderWindow.h>
 
 class JEventPool;
+class JFactoryPrefetcher;
 
 class JEventProcessorArrow : public JArrow {
 
 public:
-    using Event = std::shared_ptr<JEvent>;
+    using Event = JEvent*;
     using EventQueue = JMailbox<Event>;
 
 private:
@@ -23,6 +25,11 @@ private:
     EventQueue* m_input_queue;
     EventQueue* m_output_queue;
     std::shared_ptr<JEventPool> m_pool;
+    std::shared_ptr<JReorderWindow<Event>> m_reorder_window;
+    std::shared_ptr<JFactoryPrefetcher> m_prefetcher;
+    std::vector<Event> m_buffer;    // Empty between calls to execute(). Only used if the arrow isn't parallel.
+    bool m_begins_events = false;
+    bool m_ends_events = false;
     JLogger m_logger;
 
 public:
@@ -30,10 +37,19 @@ public:
     JEventProcessorArrow(std::string name,
                          EventQueue *input_queue,
                          EventQueue *output_queue,
-                         std::shared_ptr<JEventPool> pool);
+                         std::shared_ptr<JEventPool> pool,
+                         bool is_parallel = true);
 
     void add_processor(JEventProcessor* processor);
 
+    /// set_reorder_window() makes this arrow hand events to its processors in the order they were emitted.
+    /// The event sources must share the same window, and this arrow must be sequential.
+    void set_reorder_window(std::shared_ptr<JReorderWindow<Event>> window);
+
+    /// set_prefetcher() lets this arrow run each event's factories ahead of its processors. In a pipeline,
+    /// only the first stage begins events and only the last stage ends them.
+    void set_prefetcher(std::shared_ptr<JFactoryPrefetcher> prefetcher, bool begins_events, bool ends_events);
+
     void initialize() final;
     void finalize() final;
     void execute(JArrowMetrics& result, size_t location_id) final;
@@ -41,6 +57,8 @@ public:
     size_t get_pending() final;
     size_t get_threshold() final;
     void set_threshold(size_t) final;
+    size_t get_output_pending() final;
+    size_t get_output_threshold() final;
 
 };
 
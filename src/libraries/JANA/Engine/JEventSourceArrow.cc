@@ -16,7 +16,7 @@ JEventSourceArrow::JEventSourceArrow(std::string name,
                                      EventQueue* output_queue,
                                      std::shared_ptr<JEventPool> pool
                                      )
-    : JArrow(name, false, NodeType::Source)
+    : JArrow(name, source->IsGetEventConcurrent(), NodeType::Source)
     , m_source(source)
     , m_output_queue(output_queue)
     , m_pool(pool) {
@@ -38,6 +38,12 @@ void JEventSourceArrow::execute(JArrowMetrics& result, size_t location_id) {
     JEventSource::ReturnStatus in_status = JEventSource::ReturnStatus::Success;
     auto start_time = std::chrono::steady_clock::now();
 
+    // Concurrent sources run on several workers at once, each of which needs buffers of its own. A worker only
+    // ever runs one arrow at a time, so all the concurrent source arrows on the same thread can share them.
+    static thread_local Buffers worker_buffers;
+    auto& buffers = is_parallel() ? worker_buffers : m_buffers;
+    auto& chunk_buffer = buffers.chunk;
+
     auto chunksize = get_chunksize();
     auto reserved_count = m_output_queue->reserve(chunksize, location_id);
     auto emit_count = reserved_count;
@@ -51,17 +57,23 @@ void JEventSourceArrow::execute(JArrowMetrics& result, size_t location_id) {
         LOG_DEBUG(m_logger) << "JEventSourceArrow asked for " << chunksize << ", but only reserved " << reserved_count << LOG_END;
     }
     else {
-        for (size_t i=0; i<emit_count && in_status==JEventSource::ReturnStatus::Success; ++i) {
-            auto event = m_pool->get(location_id);
+        // Take as many events from the pool as we have room for, and have the source fill them all in one go
+        for (size_t i=0; i<emit_count; ++i) {
+            auto event = m_pool->get(location_id, m_source);
             if (event == nullptr) {
                 in_status = JEventSource::ReturnStatus::TryAgain;
                 break;
             }
+            uint64_t event_index = 0;
+            if (m_reorder_window != nullptr && !m_reorder_window->try_issue(event_index)) {
+                // Ordered processors have fallen too far behind, so wait for them to catch up
+                m_pool->put(event, location_id);
+                in_status = JEventSource::ReturnStatus::TryAgain;
+                break;
+            }
             if (event->GetJEventSource() != m_source) {
-                // If we have multiple event sources, we need to make sure we are using
-                // event-source-specific factories on top of the default ones.
-                // This is obviously not the best way to handle this but I'll need to
-                // rejigger the whole thing anyway when we re-add parallel event sources.
+                // The pool normally hands us events which already carry our source-specific factories.
+                // If it doesn't know about our source, we have to add them on top of the default ones here.
                 auto factory_set = new JFactorySet();
                 auto src_fac_gen = m_source->GetFactoryGenerator();
                 if (src_fac_gen != nullptr) {
@@ -74,19 +86,55 @@ void JEventSourceArrow::execute(JArrowMetrics& result, size_t location_id) {
             event->SetSequential(false);
             event->SetJApplication(m_source->GetApplication());
             event->GetJCallGraphRecorder()->Reset();
-            in_status = m_source->DoNext(event);
-            if (in_status == JEventSource::ReturnStatus::Success) {
-                m_chunk_buffer.push_back(std::move(event));
+            event->mEventIndex = event_index;
+            buffers.events.push_back(event);
+            buffers.handles.push_back(event->mHandle);
+        }
+
+        if (!buffers.events.empty()) {
+            size_t skip_count, fill_count;
+            JEventSource::ReturnStatus status;
+            try {
+                status = m_source->DoNext(JSpan<const std::shared_ptr<JEvent>>(buffers.handles.data(), buffers.handles.size()),
+                                          skip_count, fill_count);
             }
-            else {
-                m_pool->put(event, location_id);
+            catch (...) {
+                // Leave the buffers empty, since the next call may well come from the same worker
+                if (m_reorder_window != nullptr) {
+                    for (auto event : buffers.events) m_reorder_window->skip(event->mEventIndex);
+                }
+                m_pool->put(buffers.events, location_id);
+                buffers.handles.clear();
+                m_output_queue->push(chunk_buffer, reserved_count, location_id);  // Only gives back the reservation
+                throw;
+            }
+            if (status != JEventSource::ReturnStatus::Success) {
+                in_status = status;
+            }
+            for (size_t i=0; i<buffers.events.size(); ++i) {
+                auto event = buffers.events[i];
+                if (i >= skip_count && i < skip_count + fill_count) {
+                    chunk_buffer.push_back(event);
+                }
+                else {
+                    if (m_reorder_window != nullptr) {
+                        m_reorder_window->skip(event->mEventIndex);
+                    }
+                    buffers.rejects.push_back(event);
+                }
+            }
+            if (!buffers.rejects.empty()) {
+                m_pool->put(buffers.rejects, location_id);
             }
+            buffers.events.clear();
+            buffers.handles.clear();
+            buffers.rejects.clear();
         }
     }
 
     auto latency_time = std::chrono::steady_clock::now();
-    auto message_count = m_chunk_buffer.size();
-    auto out_status = m_output_queue->push(m_chunk_buffer, reserved_count, location_id);
+    auto message_count = chunk_buffer.size();
+    auto out_status = m_output_queue->push(chunk_buffer, reserved_count, location_id);
     auto finished_time = std::chrono::steady_clock::now();
 
     if (message_count != 0) {
@@ -10,8 +10,9 @@
 
 #include <JANA/Engine/JArrow.h>
 #include <JANA/Engine/JMailbox.h>
+#include <JANA/Engine/JReorderWindow.h>
 
-using Event = std::shared_ptr<JEvent>;
+using Event = JEvent*;
 using EventQueue = JMailbox<Event>;
 
 class JEventPool;
@@ -21,13 +22,29 @@ private:
     JEventSource* m_source;
     EventQueue* m_output_queue;
     std::shared_ptr<JEventPool> m_pool;
-    std::vector<Event> m_chunk_buffer;
+
+    /// Buffers are empty between calls to execute(), but keep their capacity, so that execute() doesn't allocate
+    struct Buffers {
+        std::vector<Event> chunk;                       // Events to emit
+        std::vector<Event> events;                      // Events handed to the source
+        std::vector<std::shared_ptr<JEvent>> handles;   // The same, as the source sees them
+        std::vector<Event> rejects;                     // Events to give back to the pool
+    };
+    Buffers m_buffers;                                  // Only used if the source isn't concurrent
+    std::shared_ptr<JReorderWindow<Event>> m_reorder_window;
     JLogger m_logger;
 
 public:
     JEventSourceArrow(std::string name, JEventSource* source, EventQueue* output_queue, std::shared_ptr<JEventPool> pool);
     void initialize() final;
     void execute(JArrowMetrics& result, size_t location_id) final;
+
+    /// set_reorder_window() makes this arrow number every event it emits, so that the stream can be put
+    /// back in order downstream. Emission stalls while the window is full.
+    void set_reorder_window(std::shared_ptr<JReorderWindow<Event>> window) { m_reorder_window = std::move(window); }
+
+    size_t get_output_pending() final { return m_output_queue->size(); }
+    size_t get_output_threshold() final { return m_output_queue->get_threshold(); }
 };
 
 #endif //JANA2_JEVENTSOURCEARROW_H
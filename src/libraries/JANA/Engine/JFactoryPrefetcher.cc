@@ -0,0 +1,233 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include "JFactoryPrefetcher.h"
+
+#include <JANA/JEvent.h>
+
+#include <functional>
+#include <sstream>
+
+
+const char* const JFactoryPrefetcher::ROOT_NAME = "<processors>";
+
+
+JFactoryPrefetcher::JFactoryPrefetcher(size_t learning_event_count, size_t thread_count, JLogger logger)
+    : m_learning_event_count(std::max<size_t>(1, learning_event_count))
+    , m_logger(std::move(logger)) {
+
+    for (size_t i=0; i<thread_count; ++i) {
+        m_threads.emplace_back(&JFactoryPrefetcher::loop, this);
+    }
+}
+
+JFactoryPrefetcher::~JFactoryPrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(m_queue_mutex);
+        m_stopping = true;
+    }
+    m_queue_cv.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+bool JFactoryPrefetcher::is_learning() {
+    std::lock_guard<std::mutex> lock(m_learning_mutex);
+    return m_schedule == nullptr;
+}
+
+std::vector<std::vector<JFactoryPrefetcher::FactoryKey>> JFactoryPrefetcher::get_schedule() {
+    std::lock_guard<std::mutex> lock(m_learning_mutex);
+    if (m_schedule == nullptr) return {};
+    return *m_schedule;
+}
+
+void JFactoryPrefetcher::begin_event(JEvent* event) {
+
+    auto recorder = event->GetJCallGraphRecorder();
+    if (recorder->IsEnabled()) {
+        // Somebody else is recording this event's call graph, so we neither learn from it nor share it between threads
+        return;
+    }
+
+    std::shared_ptr<const std::vector<std::vector<FactoryKey>>> schedule;
+    {
+        std::lock_guard<std::mutex> lock(m_learning_mutex);
+        schedule = m_schedule;
+        if (schedule == nullptr) {
+            // Record which factories get called, and by whom. Calls made directly by the processors show up
+            // as being made by ROOT_NAME.
+            m_recording_events.insert(event);
+            m_recording_event_count++;
+            recorder->SetEnabled(true);
+            recorder->StartFactoryCall(ROOT_NAME, "");
+        }
+    }
+    if (schedule != nullptr) {
+        prefetch(event, *schedule);
+    }
+}
+
+void JFactoryPrefetcher::end_event(JEvent* event) {
+
+    if (m_recording_event_count == 0) return;
+    {
+        std::lock_guard<std::mutex> lock(m_learning_mutex);
+        if (m_recording_events.erase(event) == 0) return;  // Not learning from this event
+        m_recording_event_count--;
+    }
+    auto recorder = event->GetJCallGraphRecorder();
+    recorder->FinishFactoryCall();
+    learn(*event);
+    recorder->SetEnabled(false);
+    recorder->Reset();
+}
+
+void JFactoryPrefetcher::learn(JEvent& event) {
+
+    std::lock_guard<std::mutex> lock(m_learning_mutex);
+    if (m_schedule != nullptr) return;  // Already learned enough from other events
+
+    for (const auto& node : event.GetJCallGraphRecorder()->GetCallGraph()) {
+        FactoryKey callee {node.callee_name, node.callee_tag};
+        FactoryKey caller {node.caller_name, node.caller_tag};
+        m_dependencies[callee];  // Make sure that leaves are present too
+        if (caller.first != ROOT_NAME) {
+            m_dependencies[caller].insert(callee);
+        }
+    }
+    if (++m_learned_event_count >= m_learning_event_count) {
+        build_schedule();
+    }
+}
+
+/// build_schedule() assigns each factory the level just above its highest dependency. Called with the lock held.
+void JFactoryPrefetcher::build_schedule() {
+
+    std::map<FactoryKey, size_t> levels;
+    std::set<FactoryKey> visiting;
+    std::function<size_t(const FactoryKey&)> level_of = [&](const FactoryKey& key) -> size_t {
+        auto it = levels.find(key);
+        if (it != levels.end()) return it->second;
+        if (!visiting.insert(key).second) return 0;  // A cycle can't happen with real factories; don't loop forever
+        size_t level = 0;
+        for (const auto& dependency : m_dependencies[key]) {
+            level = std::max(level, level_of(dependency) + 1);
+        }
+        visiting.erase(key);
+        levels[key] = level;
+        return level;
+    };
+
+    auto schedule = std::make_shared<std::vector<std::vector<FactoryKey>>>();
+    std::vector<FactoryKey> keys;
+    for (const auto& pair : m_dependencies) keys.push_back(pair.first);
+    for (const auto& key : keys) {
+        size_t level = level_of(key);
+        if (schedule->size() <= level) schedule->resize(level + 1);
+        (*schedule)[level].push_back(key);
+    }
+    m_schedule = schedule;
+
+    std::ostringstream os;
+    for (size_t level=0; level<schedule->size(); ++level) {
+        os << std::endl << "  " << level << ":";
+        for (const auto& key : (*schedule)[level]) {
+            os << " " << key.first;
+            if (!key.second.empty()) os << ":" << key.second;
+        }
+    }
+    LOG_INFO(m_logger) << "JFactoryPrefetcher: Learned from " << m_learned_event_count << " events to prefetch "
+                       << m_dependencies.size() << " factories in " << schedule->size() << " levels" << os.str() << LOG_END;
+}
+
+void JFactoryPrefetcher::prefetch(JEvent* event,
+                                  const std::vector<std::vector<FactoryKey>>& schedule) {
+
+    const auto& const_event = event->mConstHandle;
+    auto app = event->GetJApplication();
+    auto run_number = event->GetRunNumber();
+
+    for (const auto& level : schedule) {
+        auto batch = std::make_shared<Batch>();
+        for (const auto& key : level) {
+            auto factory = event->GetFactory(key.first, key.second);
+            if (factory != nullptr) batch->factories.push_back(factory);
+        }
+        if (batch->factories.size() == 1 || m_threads.empty()) {
+            for (auto factory : batch->factories) {
+                factory->Create(const_event, app, run_number);
+            }
+        }
+        else if (!batch->factories.empty()) {
+            batch->event = const_event;
+            batch->app = app;
+            batch->run_number = run_number;
+            event->GetArena()->SetConcurrent(true);
+            event->GetFactorySet()->SetConcurrent(true);
+            run_level(batch);
+            event->GetFactorySet()->SetConcurrent(false);
+            event->GetArena()->SetConcurrent(false);
+            if (batch->error) {
+                std::rethrow_exception(batch->error);
+            }
+        }
+    }
+    m_prefetched_event_count++;
+}
+
+/// run_level() hands batch to as many prefetch threads as can help, works on it too, and waits until it is done
+void JFactoryPrefetcher::run_level(const std::shared_ptr<Batch>& batch) {
+
+    size_t helper_count = std::min(m_threads.size(), batch->factories.size() - 1);
+    {
+        std::lock_guard<std::mutex> lock(m_queue_mutex);
+        for (size_t i=0; i<helper_count; ++i) {
+            m_queue.push_back(batch);
+        }
+    }
+    for (size_t i=0; i<helper_count; ++i) {
+        m_queue_cv.notify_one();
+    }
+
+    run_batch(*batch);
+
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->done.wait(lock, [&]() { return batch->finished == batch->factories.size(); });
+}
+
+/// run_batch() keeps taking factories from batch until there are none left. The first exception is kept for the caller.
+void JFactoryPrefetcher::run_batch(Batch& batch) {
+
+    size_t count = batch.factories.size();
+    size_t index;
+    while ((index = batch.next++) < count) {
+        try {
+            batch.factories[index]->Create(batch.event, batch.app, batch.run_number);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(batch.mutex);
+            if (!batch.error) batch.error = std::current_exception();
+        }
+        if (++batch.finished == count) {
+            std::lock_guard<std::mutex> lock(batch.mutex);
+            batch.done.notify_all();
+        }
+    }
+}
+
+void JFactoryPrefetcher::loop() {
+
+    while (true) {
+        std::shared_ptr<Batch> batch;
+        {
+            std::unique_lock<std::mutex> lock(m_queue_mutex);
+            m_queue_cv.wait(lock, [&]() { return m_stopping || !m_queue.empty(); });
+            if (m_stopping) return;
+            batch = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        run_batch(*batch);
+    }
+}
@@ -0,0 +1,109 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef JANA2_JFACTORYPREFETCHER_H
+#define JANA2_JFACTORYPREFETCHER_H
+
+#include <JANA/JLogger.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+class JApplication;
+class JEvent;
+class JFactory;
+
+/// JFactoryPrefetcher evaluates independent factories of the same event concurrently, so that each event
+/// spends less time in the processors. Factories are normally run lazily and strictly one after another,
+/// whenever somebody first asks for their data. The prefetcher instead learns which factories get used and
+/// how they depend on each other, by recording the call graph of the first few events. It then arranges them
+/// in levels, such that every factory only depends on factories in lower levels. For every later event,
+/// before the processors run, it evaluates the levels from the bottom up, running all factories within a
+/// level in parallel on its own threads (plus the calling worker). By the time the processors ask for
+/// anything, it is already there. User factories don't have to change.
+///
+/// If some event needs a factory in a different order than was learned, two threads may end up asking for it
+/// at the same time. That is still correct, because JFactoryT::GetOrCreate() lets only one of them run it, but
+/// it is slower. Factories which add new factories to the event while processing must not be prefetched.
+/// Prefetching is skipped while call graph recording is enabled, because the recorder cannot be shared
+/// between threads.
+class JFactoryPrefetcher {
+
+public:
+    using FactoryKey = std::pair<std::string, std::string>;  // (object name, tag)
+
+private:
+    /// A Batch is one level of one event, which the calling worker and the prefetch threads share. Helpers may
+    /// pick up a batch after it is finished, so they must not touch the event unless they claim a factory.
+    struct Batch {
+        std::vector<JFactory*> factories;
+        std::shared_ptr<const JEvent> event;
+        JApplication* app = nullptr;
+        int32_t run_number = 0;
+        std::atomic<size_t> next {0};
+        std::atomic<size_t> finished {0};
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+
+    size_t m_learning_event_count;
+    JLogger m_logger;
+
+    std::mutex m_learning_mutex;
+    size_t m_learned_event_count = 0;
+    std::map<FactoryKey, std::set<FactoryKey>> m_dependencies;   // {factory : factories it calls}
+    std::set<const JEvent*> m_recording_events;                 // Events we enabled the call graph recorder for
+    std::atomic<size_t> m_recording_event_count {0};            // Lets end_event() skip the lock once learning is over
+    std::shared_ptr<const std::vector<std::vector<FactoryKey>>> m_schedule;  // Levels, bottom up
+    std::atomic<size_t> m_prefetched_event_count {0};
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_queue_mutex;
+    std::condition_variable m_queue_cv;
+    std::deque<std::shared_ptr<Batch>> m_queue;
+    bool m_stopping = false;
+
+    void learn(JEvent& event);
+    void build_schedule();
+    void prefetch(JEvent* event, const std::vector<std::vector<FactoryKey>>& schedule);
+    void run_level(const std::shared_ptr<Batch>& batch);
+    static void run_batch(Batch& batch);
+    void loop();
+
+public:
+    /// Name of the caller which stands for the processors in the learned call graph
+    static const char* const ROOT_NAME;
+
+    JFactoryPrefetcher(size_t learning_event_count, size_t thread_count, JLogger logger = JLogger());
+    ~JFactoryPrefetcher();
+
+    JFactoryPrefetcher(const JFactoryPrefetcher&) = delete;
+    JFactoryPrefetcher& operator=(const JFactoryPrefetcher&) = delete;
+
+    /// begin_event() is called before the event reaches its first processor. While learning, it starts
+    /// recording the call graph; afterwards, it runs every learned factory.
+    void begin_event(JEvent* event);
+
+    /// end_event() is called after the event has been through all of its processors
+    void end_event(JEvent* event);
+
+    bool is_learning();
+
+    /// The learned levels, bottom up. Empty while still learning.
+    std::vector<std::vector<FactoryKey>> get_schedule();
+
+    size_t get_prefetched_event_count() const { return m_prefetched_event_count; }
+};
+
+
+#endif //JANA2_JFACTORYPREFETCHER_H
@@ -0,0 +1,55 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef JANA2_JIDLEPOLICY_H
+#define JANA2_JIDLEPOLICY_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+
+/// JIdlePolicy describes how a Worker waits when it has nothing to do: first it spins for
+/// spin_tries attempts, which costs CPU but reacts within nanoseconds; then it yields for
+/// yield_tries attempts, which lets other threads on the same core run; after that it parks on a
+/// JWakeupSignal for at most park_timeout, which costs nothing until a JMailbox::push() wakes it.
+///
+/// Workers use a default policy whenever the scheduler has no assignment for them. Arrows whose
+/// backoff strategy is Adaptive use their own policy while retrying after ComeBackLater.
+struct JIdlePolicy {
+
+    enum class Phase { Spin, Yield, Park };
+
+    uint32_t spin_tries = 64;
+    uint32_t yield_tries = 16;
+    std::chrono::steady_clock::duration park_timeout = std::chrono::milliseconds(1);
+
+    /// Number of pause instructions issued per spin attempt
+    static constexpr int SPIN_ITERATIONS = 32;
+
+    Phase get_phase(uint32_t attempt) const {
+        if (attempt < spin_tries) return Phase::Spin;
+        if (attempt < spin_tries + yield_tries) return Phase::Yield;
+        return Phase::Park;
+    }
+
+    static void spin() {
+        for (int i=0; i<SPIN_ITERATIONS; ++i) {
+#if defined(__x86_64__) || defined(__i386__)
+            _mm_pause();
+#elif defined(__aarch64__)
+            asm volatile("yield");
+#else
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+        }
+    }
+};
+
+
+#endif //JANA2_JIDLEPOLICY_H
@@ -8,8 +8,13 @@
 
 #include <queue>
 #include <mutex>
+#include <atomic>
+#include <iterator>
 #include <JANA/Engine/JActivable.h>
+#include <JANA/Engine/JRingBuffer.h>
+#include <JANA/Engine/JWakeupSignal.h>
 #include <JANA/Services/JLoggingService.h>
+#include <JANA/Utils/JCacheAligned.h>
 
 /// JMailbox is a threadsafe event queue designed for communication between Arrows.
 /// It is different from the standard data structure in the following ways:
@@ -19,41 +24,58 @@
 ///   - when the .reserve() method is used, the queue size is bounded
 ///   - the underlying queue may be shared by all threads, NUMA-domain-local, or thread-local
 ///   - the Arrow doesn't have to know anything about locality.
+///   - when work stealing is enabled, a domain whose queue is empty steals a batch from its
+///     siblings, visiting them in order of proximity.
 ///
 /// To handle memory locality at different granularities, we introduce the concept of a domain.
 /// Each thread belongs to exactly one domain. Domains are represented by contiguous unsigned
 /// ints starting at 0. While JArrows are wired to one logical JMailbox, JWorkers interact with
 /// the physical DomainLocalMailbox corresponding to their very own memory domain.
 ///
-/// \tparam T must be moveable. Usually this is unique_ptr<JEvent>.
+/// Each LocalMailbox is backed by one of two data structures:
+///   - Backend::Deque: a std::deque guarded by a mutex. Pops fail with Congested when the mutex is held.
+///   - Backend::Ring: a lock-free JRingBuffer sized from the threshold. Pushes and pops never block and
+///     pops never return Congested. Because pushes may not fail, items which don't fit in the ring (e.g.
+///     because the caller didn't reserve, or set_threshold() raised the threshold past the ring's capacity)
+///     spill into the mutex-guarded deque, which is drained once the ring is empty.
+///
+/// \tparam T must be moveable. Usually this is unique_ptr<JEvent>. The Ring backend additionally
+/// requires T to be default-constructible.
 ///
 /// Improvements:
 ///   1. Pad DomainLocalMailbox
-///   2. Enable work stealing
-///   3. Triple mutex trick to give push() priority?
-
-
-#ifndef CACHE_LINE_BYTES
-#define CACHE_LINE_BYTES 64
-#endif
+///   2. Triple mutex trick to give push() priority?
 
 
 template <typename T>
 class JMailbox : public JActivable {
 
+public:
+
+    enum class Backend {Deque, Ring};
+
 private:
 
-    struct alignas(CACHE_LINE_BYTES) LocalMailbox {
+    struct alignas(CACHE_LINE_BYTES) LocalMailbox : public JCacheAligned {
         std::mutex mutex;
-        std::deque<T> queue;
-        size_t reserved_count = 0;
+        std::deque<T> queue;                          // Deque backend, or Ring backend's overflow
+        std::atomic<size_t> reserved_count {0};
+        std::unique_ptr<JRingBuffer<T>> ring;         // Ring backend only
+        alignas(CACHE_LINE_BYTES) std::atomic<size_t> count {0};  // Ring backend only; never less than the true size
+        std::atomic<size_t> overflow_count {0};       // Ring backend only
+        std::atomic<size_t> steal_count {0};          // Items this location has stolen from its siblings
+        std::vector<size_t> steal_order;              // Sibling locations, nearest first
+        std::mutex steal_mutex;                       // Guards steal_buffer
+        std::vector<T> steal_buffer;                  // Scratch for single-item steals, empty in between
     };
 
     // TODO: Copy these params into DLMB for better locality
     size_t m_threshold;
     size_t m_locations_count;
     bool m_enable_work_stealing = false;
+    Backend m_backend = Backend::Deque;
     std::unique_ptr<LocalMailbox[]> m_mailboxes;
+    JWakeupSignal* m_wakeup_signal = nullptr;  // Non-owning
     JLogger m_logger;
 
 public:
@@ -76,12 +98,26 @@ public:
     /// threshold: the (soft) maximum number of items in the queue at any time
     /// domain_count: the number of domains
     /// enable_work_stealing: allow domains to pop from other domains' queues when theirs is empty
-    JMailbox(size_t threshold=100, size_t locations_count=1, bool enable_work_stealing=false)
+    /// backend: which data structure backs each domain's queue
+    JMailbox(size_t threshold=100, size_t locations_count=1, bool enable_work_stealing=false, Backend backend=Backend::Deque)
         : m_threshold(threshold)
         , m_locations_count(locations_count)
-        , m_enable_work_stealing(enable_work_stealing) {
+        , m_enable_work_stealing(enable_work_stealing)
+        , m_backend(backend) {
 
         m_mailboxes = std::unique_ptr<LocalMailbox[]>(new LocalMailbox[locations_count]);
+        for (size_t i = 0; i<m_locations_count; ++i) {
+            // Until we are told anything about the topology, visit siblings round-robin
+            for (size_t j = 1; j<m_locations_count; ++j) {
+                m_mailboxes[i].steal_order.push_back((i + j) % m_locations_count);
+            }
+        }
+        if (m_backend == Backend::Ring) {
+            // Leave headroom for pushes which exceed the threshold
+            for (size_t i = 0; i<m_locations_count; ++i) {
+                m_mailboxes[i].ring = std::unique_ptr<JRingBuffer<T>>(new JRingBuffer<T>(2 * threshold));
+            }
+        }
     }
 
     virtual ~JMailbox() {
@@ -94,6 +130,10 @@ public:
     size_t size() {
         size_t result = 0;
         for (size_t i = 0; i<m_locations_count; ++i) {
+            if (m_backend == Backend::Ring) {
+                result += m_mailboxes[i].count.load(std::memory_order_relaxed);
+                continue;
+            }
             std::lock_guard<std::mutex> lock(m_mailboxes[i].mutex);
             result += m_mailboxes[i].queue.size();
         }
@@ -103,6 +143,9 @@ public:
     /// size(domain) counts the number of items in the queue for a particular domain
     /// Meant to be used by Scheduler::next_assignment() and measure_perf(), eventually
     size_t size(size_t domain) {
+        if (m_backend == Backend::Ring) {
+            return m_mailboxes[domain].count.load(std::memory_order_relaxed);
+        }
         return m_mailboxes[domain].queue.size();
     }
 
@@ -116,6 +159,17 @@ public:
     size_t reserve(size_t requested_count, size_t domain = 0) {
 
         LocalMailbox& mb = m_mailboxes[domain];
+        if (m_backend == Backend::Ring) {
+            size_t reserved = mb.reserved_count.load();
+            while (true) {
+                size_t used = mb.count.load() + reserved;
+                if (used >= m_threshold) return 0;
+                size_t reservation = std::min(m_threshold - used, requested_count);
+                if (mb.reserved_count.compare_exchange_weak(reserved, reserved + reservation)) {
+                    return reservation;
+                }
+            }
+        }
         std::lock_guard<std::mutex> lock(mb.mutex);
         size_t doable_count = m_threshold - mb.queue.size() - mb.reserved_count;
         if (doable_count > 0) {
@@ -130,24 +184,77 @@ public:
     /// succeed, although it may exceed the threshold if the caller didn't reserve
     /// space, and it may take a long time because it will wait on a mutex.
     /// Note that if the caller had called reserve(), they must pass in the reserved_count here.
+    /// Any Workers parked on the wakeup signal are woken afterwards.
     Status push(std::vector<T>& buffer, size_t reserved_count = 0, size_t domain = 0) {
+        auto status = push_local(buffer, reserved_count, domain);
+        if (m_wakeup_signal != nullptr) {
+            m_wakeup_signal->notify();
+        }
+        return status;
+    }
+
+    Status push(T& item, size_t reserved_count = 0, size_t domain = 0) {
+        auto status = push_local(item, reserved_count, domain);
+        if (m_wakeup_signal != nullptr) {
+            m_wakeup_signal->notify();
+        }
+        return status;
+    }
+
+    /// set_active(false) also wakes any parked Workers, so that they notice promptly that we are finished
+    void set_active(bool is_active) override {
+        JActivable::set_active(is_active);
+        if (m_wakeup_signal != nullptr) {
+            m_wakeup_signal->notify();
+        }
+    }
+
+    /// set_wakeup_signal() tells the mailbox whom to notify on push. This is meant to be called
+    /// during topology construction, before any worker touches the mailbox.
+    void set_wakeup_signal(JWakeupSignal* wakeup_signal) { m_wakeup_signal = wakeup_signal; }
+
+private:
+
+    Status push_local(std::vector<T>& buffer, size_t reserved_count, size_t domain) {
+        auto status = push_local(buffer.begin(), buffer.end(), reserved_count, domain);
+        buffer.clear();
+        return status;
+    }
+
+    /// Moves the items in [first, last) into domain's queue. The caller is responsible for clearing them.
+    template <typename Iterator>
+    Status push_local(Iterator first, Iterator last, size_t reserved_count, size_t domain) {
 
         auto& mb = m_mailboxes[domain];
+        if (m_backend == Backend::Ring) {
+            size_t count = std::distance(first, last);
+            size_t size = mb.count.fetch_add(count) + count;
+            for (auto it = first; it != last; ++it) {
+                push_to_ring(mb, *it);
+            }
+            mb.reserved_count -= reserved_count;
+            return (size > m_threshold) ? Status::Full : Status::Ready;
+        }
         std::lock_guard<std::mutex> lock(mb.mutex);
         mb.reserved_count -= reserved_count;
-        for (const T& t : buffer) {
-             mb.queue.push_back(std::move(t));
+        for (auto it = first; it != last; ++it) {
+             mb.queue.push_back(std::move(*it));
         }
-        buffer.clear();
         if (mb.queue.size() > m_threshold) {
             return Status::Full;
         }
         return Status::Ready;
     }
 
-    Status push(T& item, size_t reserved_count = 0, size_t domain = 0) {
+    Status push_local(T& item, size_t reserved_count, size_t domain) {
 
         auto& mb = m_mailboxes[domain];
+        if (m_backend == Backend::Ring) {
+            size_t size = mb.count.fetch_add(1) + 1;
+            push_to_ring(mb, item);
+            mb.reserved_count -= reserved_count;
+            return (size > m_threshold) ? Status::Full : Status::Ready;
+        }
         std::lock_guard<std::mutex> lock(mb.mutex);
         mb.reserved_count -= reserved_count;
         mb.queue.push_back(std::move(item));
@@ -159,12 +266,76 @@ public:
     }
 
 
+public:
+
     /// pop() will pop up to requested_count items for the desired domain.
     /// If many threads are contending for the queue, this will fail with Status::Contention,
     /// in which case the caller should probably consult the Scheduler.
+    /// If the domain's queue is empty and work stealing is enabled, this steals from a sibling domain instead.
     Status pop(std::vector<T>& buffer, size_t requested_count, size_t location_id = 0) {
 
+        size_t original_size = buffer.size();
+        auto status = pop_local(buffer, requested_count, location_id);
+        if (buffer.size() == original_size && (status == Status::Empty || status == Status::Finished)) {
+            if (steal(buffer, requested_count, location_id) > 0) {
+                return Status::Ready;
+            }
+        }
+        return status;
+    }
+
+
+    Status pop(T& item, bool& success, size_t location_id = 0) {
+
+        auto status = pop_local(item, success, location_id);
+        if (!success && m_enable_work_stealing && (status == Status::Empty || status == Status::Finished)) {
+            // Workers at the same location share its scratch buffer. If another one is already stealing,
+            // it is about to refill our queue anyway.
+            auto& mb = m_mailboxes[location_id];
+            std::unique_lock<std::mutex> lock(mb.steal_mutex, std::try_to_lock);
+            if (lock.owns_lock() && steal(mb.steal_buffer, 1, location_id) > 0) {
+                item = std::move(mb.steal_buffer.front());
+                mb.steal_buffer.clear();
+                success = true;
+                return Status::Ready;
+            }
+        }
+        return status;
+    }
+
+
+    size_t get_threshold() { return m_threshold; }
+    void set_threshold(size_t threshold) { m_threshold = threshold; }
+    Backend get_backend() { return m_backend; }
+    size_t get_locations_count() { return m_locations_count; }
+    bool is_work_stealing_enabled() { return m_enable_work_stealing; }
+
+    /// get_steal_count(location_id) counts the items which location_id has stolen from its siblings so far
+    size_t get_steal_count(size_t location_id) {
+        return m_mailboxes[location_id].steal_count.load(std::memory_order_relaxed);
+    }
+
+    /// set_steal_order(location_id, siblings) tells location_id which sibling locations to steal from, nearest first.
+    /// This is meant to be called during topology construction, before any worker touches the mailbox.
+    void set_steal_order(size_t location_id, std::vector<size_t> siblings) {
+        m_mailboxes[location_id].steal_order = std::move(siblings);
+    }
+
+private:
+
+    Status pop_local(std::vector<T>& buffer, size_t requested_count, size_t location_id) {
+
         auto& mb = m_mailboxes[location_id];
+        if (m_backend == Backend::Ring) {
+            size_t nitems = 0;
+            T item;
+            while (nitems < requested_count && pop_from_ring(mb, item)) {
+                buffer.push_back(std::move(item));
+                nitems++;
+            }
+            size_t size = mb.count.fetch_sub(nitems) - nitems;
+            return status_after_pop(size);
+        }
         if (!mb.mutex.try_lock()) {
             return Status::Congested;
         }
@@ -189,10 +360,18 @@ public:
     }
 
 
-    Status pop(T& item, bool& success, size_t location_id = 0) {
+    Status pop_local(T& item, bool& success, size_t location_id) {
 
         success = false;
         auto& mb = m_mailboxes[location_id];
+        if (m_backend == Backend::Ring) {
+            if (pop_from_ring(mb, item)) {
+                success = true;
+                size_t size = mb.count.fetch_sub(1) - 1;
+                return (size > 0) ? Status::Ready : Status::Empty;
+            }
+            return is_active() ? Status::Empty : Status::Finished;
+        }
         if (!mb.mutex.try_lock()) {
             return Status::Congested;
         }
@@ -220,8 +399,108 @@ public:
     }
 
 
-    size_t get_threshold() { return m_threshold; }
-    void set_threshold(size_t threshold) { m_threshold = threshold; }
+    /// steal() visits location_id's siblings, nearest first, and takes a batch from the first one
+    /// which has anything to spare: half of its queue, but at least requested_count items. Whatever
+    /// exceeds requested_count is pushed into location_id's own queue, so that subsequent pops stay
+    /// local. Siblings whose lock is held are skipped rather than waited on.
+    size_t steal(std::vector<T>& buffer, size_t requested_count, size_t location_id) {
+
+        if (!m_enable_work_stealing || m_locations_count < 2) {
+            return 0;
+        }
+        auto& thief = m_mailboxes[location_id];
+        for (size_t victim_id : thief.steal_order) {
+            size_t available = size(victim_id);
+            if (available == 0) continue;
+            size_t batch_size = std::max(requested_count, available / 2);
+
+            // Take the whole batch straight into the caller's buffer, and then move the surplus from its end
+            // into our own queue. The victim's lock has been released by then, so we never hold both.
+            size_t original_size = buffer.size();
+            size_t nitems = take(m_mailboxes[victim_id], buffer, batch_size);
+            if (nitems == 0) continue;
+
+            thief.steal_count.fetch_add(nitems, std::memory_order_relaxed);
+            size_t keep = std::min(requested_count, nitems);
+            if (nitems > keep) {
+                auto surplus = buffer.begin() + original_size + keep;
+                push_local(surplus, buffer.end(), 0, location_id);
+                buffer.erase(surplus, buffer.end());
+                if (m_wakeup_signal != nullptr) {
+                    m_wakeup_signal->notify();
+                }
+            }
+            return keep;
+        }
+        return 0;
+    }
+
+    /// take() moves up to count items out of mb, without waiting on its mutex.
+    size_t take(LocalMailbox& mb, std::vector<T>& buffer, size_t count) {
+        size_t nitems = 0;
+        if (m_backend == Backend::Ring) {
+            T item;
+            while (nitems < count && pop_from_ring(mb, item)) {
+                buffer.push_back(std::move(item));
+                nitems++;
+            }
+            mb.count.fetch_sub(nitems);
+            return nitems;
+        }
+        if (!mb.mutex.try_lock()) {
+            return 0;
+        }
+        nitems = std::min(count, mb.queue.size());
+        for (size_t i=0; i<nitems; ++i) {
+            buffer.push_back(std::move(mb.queue.front()));
+            mb.queue.pop_front();
+        }
+        mb.mutex.unlock();
+        return nitems;
+    }
+
+    /// Ring backend: Items only go into the ring while there is no overflow, so that we stay FIFO
+    /// apart from transitions. The caller is responsible for updating mb.count.
+    void push_to_ring(LocalMailbox& mb, T& item) {
+        if (mb.overflow_count.load(std::memory_order_acquire) == 0 && mb.ring->try_push(item)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mb.mutex);
+        mb.queue.push_back(std::move(item));
+        mb.overflow_count.fetch_add(1, std::memory_order_release);
+    }
+
+    /// Ring backend: Overflow is only consulted once the ring has been drained.
+    /// The caller is responsible for updating mb.count.
+    bool pop_from_ring(LocalMailbox& mb, T& item) {
+        if (mb.ring->try_pop(item)) {
+            return true;
+        }
+        if (mb.overflow_count.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mb.mutex);
+        if (mb.queue.empty()) {
+            return false;
+        }
+        item = std::move(mb.queue.front());
+        mb.queue.pop_front();
+        mb.overflow_count.fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+
+    Status status_after_pop(size_t size) {
+        if (size >= m_threshold) {
+            return Status::Full;
+        }
+        else if (size != 0) {
+            return Status::Ready;
+        }
+        else if (is_active()) {
+            return Status::Empty;
+        }
+        return Status::Finished;
+    }
 
 };
 
@@ -0,0 +1,161 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef JANA2_JREORDERWINDOW_H
+#define JANA2_JREORDERWINDOW_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+
+/// JReorderWindow restores the order in which items were emitted after they have been processed out of
+/// order by parallel arrows. Each item is issued a consecutive index before it is emitted; downstream,
+/// insert() parks it in the slot for that index, and pop_ready() hands items back strictly in index order.
+///
+/// The window is bounded: try_issue() refuses to issue an index more than capacity ahead of the next
+/// index to be handed back. This is what provides backpressure to the emitter, and it also guarantees that
+/// every item in flight has a slot, so that the item everybody is waiting for can never get stuck behind
+/// items which don't fit. An emitter which was issued an index but then has nothing to emit must call
+/// skip() so that the window doesn't wait for it forever.
+///
+/// The window keeps track of its occupancy and of head-of-line stalls, i.e. how long it holds items while
+/// the next one in order is still missing.
+template <typename T>
+class JReorderWindow {
+
+public:
+    using clock_t = std::chrono::steady_clock;
+
+private:
+    enum class SlotStatus { Empty, Filled, Skipped };
+
+    struct Slot {
+        SlotStatus status = SlotStatus::Empty;
+        T item;
+    };
+
+    std::mutex m_mutex;
+    std::vector<Slot> m_slots;
+    uint64_t m_next_issued = 0;      // Index which try_issue() hands out next
+    uint64_t m_next_delivered = 0;   // Index which pop_ready() hands back next
+    size_t m_occupancy = 0;
+    size_t m_max_occupancy = 0;
+    size_t m_backpressure_count = 0;
+    bool m_is_stalled = false;
+    clock_t::time_point m_stall_start;
+    clock_t::duration m_total_stall_time = clock_t::duration::zero();
+
+    Slot& slot_for(uint64_t index) { return m_slots[index % m_slots.size()]; }
+
+    /// Called with the lock held whenever the occupancy or the head of the window changes
+    void update_stall(clock_t::time_point now) {
+        bool is_stalled = m_occupancy != 0 && slot_for(m_next_delivered).status == SlotStatus::Empty;
+        if (is_stalled && !m_is_stalled) {
+            m_stall_start = now;
+        }
+        else if (!is_stalled && m_is_stalled) {
+            m_total_stall_time += now - m_stall_start;
+        }
+        m_is_stalled = is_stalled;
+    }
+
+public:
+
+    explicit JReorderWindow(size_t capacity) : m_slots((capacity == 0) ? 1 : capacity) {}
+
+    JReorderWindow(const JReorderWindow&) = delete;
+    JReorderWindow& operator=(const JReorderWindow&) = delete;
+
+    /// try_issue() hands out the next index, or returns false if the window is full
+    bool try_issue(uint64_t& index) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_next_issued - m_next_delivered >= m_slots.size()) {
+            m_backpressure_count++;
+            return false;
+        }
+        index = m_next_issued++;
+        return true;
+    }
+
+    /// insert() parks item in the slot which try_issue() reserved for it under index
+    void insert(uint64_t index, T item) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Slot& slot = slot_for(index);
+        slot.item = std::move(item);
+        slot.status = SlotStatus::Filled;
+        m_occupancy++;
+        m_max_occupancy = std::max(m_max_occupancy, m_occupancy);
+        update_stall(clock_t::now());
+    }
+
+    /// skip() releases an index which was issued but won't be used
+    void skip(uint64_t index) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        slot_for(index).status = SlotStatus::Skipped;
+        m_occupancy++;
+        update_stall(clock_t::now());
+    }
+
+    /// pop_ready() appends every item which is next in order to buffer, and returns how many it appended
+    size_t pop_ready(std::vector<T>& buffer) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t count = 0;
+        while (true) {
+            Slot& slot = slot_for(m_next_delivered);
+            if (slot.status == SlotStatus::Empty) break;
+            if (slot.status == SlotStatus::Filled) {
+                buffer.push_back(std::move(slot.item));
+                slot.item = T();
+                count++;
+            }
+            slot.status = SlotStatus::Empty;
+            m_occupancy--;
+            m_next_delivered++;
+        }
+        update_stall(clock_t::now());
+        return count;
+    }
+
+    size_t get_capacity() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_slots.size();
+    }
+
+    /// Items (and skipped indices) which are waiting for an earlier index
+    size_t get_occupancy() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_occupancy;
+    }
+
+    size_t get_max_occupancy() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_max_occupancy;
+    }
+
+    /// Number of times try_issue() refused an index because the window was full
+    size_t get_backpressure_count() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_backpressure_count;
+    }
+
+    /// Total time spent holding items while the next one in order was missing, including any ongoing stall
+    clock_t::duration get_stall_time() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto total = m_total_stall_time;
+        if (m_is_stalled) {
+            total += clock_t::now() - m_stall_start;
+        }
+        return total;
+    }
+
+    uint64_t get_next_delivered() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_next_delivered;
+    }
+};
+
+
+#endif //JANA2_JREORDERWINDOW_H
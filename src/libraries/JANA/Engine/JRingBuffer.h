@@ -0,0 +1,114 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef JANA2_JRINGBUFFER_H
+#define JANA2_JRINGBUFFER_H
+
+#include <JANA/Utils/JCacheAligned.h>
+
+#include <atomic>
+#include <memory>
+
+
+/// JRingBuffer is a bounded, lock-free, multi-producer multi-consumer FIFO, following Vyukov's
+/// design: each slot carries a sequence number which tells producers and consumers whether the
+/// slot is theirs to fill or drain on the current lap around the ring. A push or pop costs a
+/// single CAS on the shared head or tail index in the uncontended case, and a thread which loses
+/// that race simply retries with the next index instead of blocking.
+///
+/// Capacity is fixed at construction and rounded up to a power of two. Both try_push() and
+/// try_pop() fail rather than wait, leaving the caller to decide what to do about a full or
+/// empty ring. The head and tail indices each get their own cache line so that producers and
+/// consumers don't false-share; the slots themselves are left unpadded so that the ring stays small
+/// enough to live in cache.
+///
+/// \tparam T must be default-constructible and moveable.
+template <typename T>
+class JRingBuffer : public JCacheAligned {
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_mask;
+    alignas(CACHE_LINE_BYTES) std::atomic<size_t> m_head {0};  // Next slot to push into
+    alignas(CACHE_LINE_BYTES) std::atomic<size_t> m_tail {0};  // Next slot to pop from
+
+public:
+
+    explicit JRingBuffer(size_t capacity) {
+        size_t rounded = 2;
+        while (rounded < capacity) rounded *= 2;
+        m_slots = std::unique_ptr<Slot[]>(new Slot[rounded]);
+        for (size_t i=0; i<rounded; ++i) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        m_mask = rounded - 1;
+    }
+
+    JRingBuffer(const JRingBuffer&) = delete;
+    JRingBuffer& operator=(const JRingBuffer&) = delete;
+
+    size_t capacity() const { return m_mask + 1; }
+
+    /// size() is approximate while other threads are pushing or popping
+    size_t size() const {
+        size_t head = m_head.load(std::memory_order_acquire);
+        size_t tail = m_tail.load(std::memory_order_acquire);
+        return (head > tail) ? head - tail : 0;
+    }
+
+    /// try_push() moves item into the ring and returns true, or returns false and leaves item
+    /// untouched if the ring is full.
+    bool try_push(T& item) {
+        size_t pos = m_head.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = m_slots[pos & m_mask];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                // Slot is free on this lap; claim it
+                if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = std::move(item);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;  // Slot still holds an item from the previous lap, i.e. ring is full
+            }
+            else {
+                pos = m_head.load(std::memory_order_relaxed);  // Somebody else got there first
+            }
+        }
+    }
+
+    /// try_pop() moves the oldest item into item and returns true, or returns false if the ring is empty.
+    bool try_pop(T& item) {
+        size_t pos = m_tail.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = m_slots[pos & m_mask];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                // Slot has been filled on this lap; claim it
+                if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    item = std::move(slot.value);
+                    slot.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;  // Slot hasn't been filled yet, i.e. ring is empty
+            }
+            else {
+                pos = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+
+#endif //JANA2_JRINGBUFFER_H
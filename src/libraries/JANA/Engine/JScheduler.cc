@@ -8,8 +8,12 @@
 
 JScheduler::JScheduler(const std::vector<JArrow*>& arrows)
     : m_arrows(arrows)
-    , m_next_idx(0)
-    {}
+    , m_next_idx(0) {
+
+    for (JArrow* arrow : arrows) {
+        m_is_deactivated[arrow] = std::unique_ptr<std::atomic_bool>(new std::atomic_bool(false));
+    }
+}
 
 
 JArrow* JScheduler::next_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status last_result) {
@@ -77,4 +81,32 @@ void JScheduler::last_assignment(uint32_t worker_id, JArrow* assignment, JArrowM
 }
 
 
+bool JScheduler::try_assign(JArrow* candidate) {
+    if (candidate->is_upstream_finished()) return false;
+    if (!candidate->try_acquire_thread()) return false;
+    if (candidate->is_upstream_finished()) {
+        // Upstream finished between the check and the claim, so give it back.
+        // We may be the last one out, in which case release() will deactivate the arrow.
+        release(candidate);
+        return false;
+    }
+    return true;
+}
+
+
+void JScheduler::release(JArrow* assignment) {
+
+    size_t remaining = assignment->release_thread();
+    if (remaining == 0 && assignment->is_upstream_finished()) {
+
+        // This was the last worker running this arrow, so it can now deactivate.
+        // Several workers may observe this simultaneously, so only the first one
+        // to flip is_deactivated gets to notify downstream.
+        if (!m_is_deactivated.at(assignment)->exchange(true)) {
+            assignment->set_active(false);
+            LOG_INFO(logger) << "Deactivating arrow " << assignment->get_name() << LOG_END;
+            assignment->notify_downstream(false);
+        }
+    }
+}
 
@@ -6,6 +6,8 @@
 #define _JSCHEDULER_H_
 
 #include <mutex>
+#include <memory>
+#include <unordered_map>
 
 #include <JANA/Engine/JArrow.h>
 #include <JANA/Services/JLoggingService.h>
@@ -13,10 +15,22 @@
 
     /// Scheduler assigns Arrows to Workers in a first-come-first-serve manner,
     /// not unlike OpenMP's `schedule dynamic`.
+    /// Alternative scheduling policies (see JWorkStealingScheduler) extend this class and may be
+    /// selected via the `jana:scheduler` parameter.
     class JScheduler {
 
-    private:
+    protected:
         std::vector<JArrow*> m_arrows;
+
+        /// Lock-free building blocks for subclasses which don't want to hold m_mutex.
+        /// try_assign() claims a thread slot on an arrow which is still schedulable; release() gives
+        /// the slot back and, if it was the last one and upstream has finished, deactivates the arrow.
+        bool try_assign(JArrow* candidate);
+        void release(JArrow* assignment);
+
+    private:
+        std::unordered_map<JArrow*, std::unique_ptr<std::atomic_bool>> m_is_deactivated;  // Immutable after construction
+
         size_t m_next_idx;
         std::mutex m_mutex;
 
@@ -24,16 +38,17 @@
 
         /// Constructor. Note that a Scheduler operates on a vector of Arrow*s.
         JScheduler(const std::vector<JArrow*>& arrows);
+        virtual ~JScheduler() = default;
 
         /// Lets a Worker ask the Scheduler for another assignment. If no assignments make sense,
         /// Scheduler returns nullptr, which tells that Worker to idle until his next checkin.
         /// If next_assignment() makes any changes to internal Scheduler state or to any of its arrows,
         /// it must be synchronized.
-        JArrow* next_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status result);
+        virtual JArrow* next_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status result);
 
         /// Lets a Worker tell the scheduler that he is shutting down and won't be working on his assignment
         /// any more. The scheduler is thus free to reassign the arrow to one of the remaining workers.
-        void last_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status result);
+        virtual void last_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status result);
 
         /// Logger is public so that somebody else can configure it
         JLogger logger;
@@ -10,7 +10,7 @@
 #include "JArrow.h"
 #include <JANA/JEvent.h>
 
-using Event = std::shared_ptr<JEvent>;
+using Event = JEvent*;
 
 
 /// Data structure containing all of the metadata needed to merge subevents
@@ -8,6 +8,7 @@
 #include <JANA/Engine/JArrowTopology.h>
 #include "JEventSourceArrow.h"
 #include "JEventProcessorArrow.h"
+#include <algorithm>
 #include <memory>
 
 
@@ -39,23 +40,66 @@ public:
 		m_params = sl->get<JParameterManager>();
 	};
 
+	struct ProcessorGroup {
+		std::string resource_name;
+		bool is_ordered = false;
+		std::vector<JEventProcessor*> processors;
+	};
+
+	/// group_processors_by_resource() puts every processor without a resource name into one group, which
+	/// comes first, followed by one group per distinct resource name, in order of first appearance.
+	/// Processors which want their events in order all go into one last group, regardless of resource name.
+	/// There is always at least one group, even if it is empty.
+	static std::vector<ProcessorGroup> group_processors_by_resource(const std::vector<JEventProcessor*>& processors) {
+		std::vector<ProcessorGroup> groups(1);
+		ProcessorGroup ordered_group {"", true, {}};
+		for (auto proc : processors) {
+			if (proc->AreEventsOrdered()) {
+				ordered_group.processors.push_back(proc);
+				continue;
+			}
+			auto resource_name = proc->GetResourceName();
+			auto it = std::find_if(groups.begin(), groups.end(),
+			                       [&](const ProcessorGroup& g) { return g.resource_name == resource_name; });
+			if (it == groups.end()) {
+				groups.push_back({resource_name, false, {proc}});
+			}
+			else {
+				it->processors.push_back(proc);
+			}
+		}
+		if (!ordered_group.processors.empty()) {
+			groups.push_back(std::move(ordered_group));
+		}
+		if (groups.size() > 1 && groups[0].processors.empty()) {
+			groups.erase(groups.begin());
+		}
+		return groups;
+	}
+
 	inline virtual JArrowTopology* build(int nthreads) {
 
 		auto topology = new JArrowTopology;
 		topology->component_manager = m_components;  // Ensure the lifespan of the component manager exceeds that of the topology
 
 		size_t event_pool_size = nthreads;
+		size_t event_pool_partition_size = 0;
 		size_t event_queue_threshold = 80;
 		size_t event_source_chunksize = 40;
 		size_t event_processor_chunksize = 1;
-		size_t location_count = 1;
                 bool enable_call_graph_recording = false;
                 bool enable_stealing = false;
 		bool limit_total_events_in_flight = true;
 		int affinity = 2;
 		int locality = 0;
+		int mailbox_backend = 0;
+		size_t event_reorder_window = 0;
+		size_t intra_event_threads = 0;
+		size_t intra_event_learning_events = 10;
 
 		m_params->SetDefaultParameter("jana:event_pool_size", event_pool_size);
+		m_params->SetDefaultParameter("jana:event_pool_partition_size", event_pool_partition_size,
+		                              "Events per event source and location. 0: event_pool_size split evenly among them");
 		m_params->SetDefaultParameter("jana:limit_total_events_in_flight", limit_total_events_in_flight);
 		m_params->SetDefaultParameter("jana:event_queue_threshold", event_queue_threshold);
 		m_params->SetDefaultParameter("jana:event_source_chunksize", event_source_chunksize);
@@ -63,6 +107,13 @@ public:
 		m_params->SetDefaultParameter("jana:enable_stealing", enable_stealing);
 		m_params->SetDefaultParameter("jana:affinity", affinity);
 		m_params->SetDefaultParameter("jana:locality", locality);
+		m_params->SetDefaultParameter("jana:mailbox_backend", mailbox_backend, "0: Mutex-guarded deque, 1: Lock-free ring buffer");
+		m_params->SetDefaultParameter("jana:event_reorder_window", event_reorder_window,
+		                              "Max events held back for processors which want them in order. 0: Total events in the pool");
+		m_params->SetDefaultParameter("jana:intra_event_threads", intra_event_threads,
+		                              "Extra threads for running independent factories of the same event in parallel. 0: Off");
+		m_params->SetDefaultParameter("jana:intra_event_learning_events", intra_event_learning_events,
+		                              "Events to learn the factory dependencies from, before prefetching begins");
 		m_params->SetDefaultParameter("RECORD_CALL_STACK", enable_call_graph_recording);
 
 
@@ -70,37 +121,94 @@ public:
 		topology->mapping.initialize(static_cast<JProcessorMapping::AffinityStrategy>(affinity),
 		                             static_cast<JProcessorMapping::LocalityStrategy>(locality));
 
+		// The pool has one partition per event source and location. jana:event_pool_size still bounds the total.
+		size_t partition_count = std::max<size_t>(1, m_components->get_evt_srces().size()) * topology->mapping.get_loc_count();
+		if (event_pool_partition_size == 0) {
+			event_pool_partition_size = std::max<size_t>(1, event_pool_size / partition_count);
+		}
 		topology->event_pool = std::make_shared<JEventPool>(&m_components->get_fac_gens(),
                                                                     enable_call_graph_recording,
-                                                                    event_pool_size,
-		                                                    location_count,
-                                                                    limit_total_events_in_flight);
+                                                                    event_pool_partition_size,
+		                                                    topology->mapping.get_loc_count(),
+                                                                    limit_total_events_in_flight,
+                                                                    &topology->mapping,
+                                                                    m_components->get_evt_srces());
+		topology->event_pool->set_wakeup_signal(topology->wakeup_signal.get());
+
+		if (intra_event_threads > 0) {
+			if (enable_call_graph_recording) {
+				LOG_WARN(topology->m_logger) << "Ignoring jana:intra_event_threads, because RECORD_CALL_STACK is enabled" << LOG_END;
+			}
+			else {
+				topology->prefetcher = std::make_shared<JFactoryPrefetcher>(intra_event_learning_events, intra_event_threads, topology->m_logger);
+			}
+		}
 
-		// Assume the simplest possible topology for now, complicate later
-		auto queue = new EventQueue(event_queue_threshold, topology->mapping.get_loc_count(), enable_stealing);
-		topology->queues.push_back(queue);
+		auto make_queue = [&]() {
+			auto queue = new EventQueue(event_queue_threshold, topology->mapping.get_loc_count(), enable_stealing,
+			                            static_cast<EventQueue::Backend>(mailbox_backend));
+			queue->set_wakeup_signal(topology->wakeup_signal.get());
+			if (enable_stealing) {
+				for (size_t loc_id=0; loc_id<topology->mapping.get_loc_count(); ++loc_id) {
+					queue->set_steal_order(loc_id, topology->mapping.get_nearest_locations(loc_id));
+				}
+			}
+			topology->queues.push_back(queue);
+			return queue;
+		};
+
+		auto queue = make_queue();
+
+		// Each group of processors becomes one stage of a pipeline, connected by mailboxes.
+		std::vector<ProcessorGroup> groups = group_processors_by_resource(m_components->get_evt_procs());
+
+		if (groups.back().is_ordered) {
+			// Sources number the events they emit, and the last stage puts them back in that order
+			if (event_reorder_window == 0) {
+				event_reorder_window = event_pool_partition_size * partition_count;
+			}
+			topology->reorder_window = std::make_shared<JReorderWindow<Event>>(event_reorder_window);
+		}
 
 		for (auto src : m_components->get_evt_srces()) {
 
 			// create arrow for each source. Don't open until arrow.activate() called
-			JArrow *arrow = new JEventSourceArrow(src->GetName(), src, queue, topology->event_pool);
+			auto arrow = new JEventSourceArrow(src->GetName(), src, queue, topology->event_pool);
+			arrow->set_reorder_window(topology->reorder_window);
 			arrow->set_backoff_tries(0);
 			topology->arrows.push_back(arrow);
 			topology->sources.push_back(arrow);
 			arrow->set_chunksize(event_source_chunksize);
 		}
 
-		auto proc_arrow = new JEventProcessorArrow("processors", queue, nullptr, topology->event_pool);
-		proc_arrow->set_chunksize(event_processor_chunksize);
-		topology->arrows.push_back(proc_arrow);
+		JEventProcessorArrow* proc_arrow = nullptr;
+		for (size_t i=0; i<groups.size(); ++i) {
+			bool is_last = (i+1 == groups.size());
+			EventQueue* output_queue = is_last ? nullptr : make_queue();
+			std::string name = groups[i].is_ordered ? "processors:ordered"
+			                   : groups[i].resource_name.empty() ? "processors"
+			                   : "processors:" + groups[i].resource_name;
+
+			// Processors sharing a resource are run sequentially, so that they needn't lock it themselves
+			bool is_parallel = groups[i].resource_name.empty() && !groups[i].is_ordered;
+			proc_arrow = new JEventProcessorArrow(name, queue, output_queue, topology->event_pool, is_parallel);
+			proc_arrow->set_chunksize(event_processor_chunksize);
+			if (groups[i].is_ordered) {
+				proc_arrow->set_reorder_window(topology->reorder_window);
+			}
+			if (topology->prefetcher != nullptr) {
+				proc_arrow->set_prefetcher(topology->prefetcher, i == 0, is_last);
+			}
+			for (auto proc : groups[i].processors) {
+				proc_arrow->add_processor(proc);
+			}
+			topology->arrows.push_back(proc_arrow);
+			queue = output_queue;
+		}
 
-		// Receive notifications when sinks finish
+		// Receive notifications when the last stage finishes
 		proc_arrow->attach_downstream(topology);   // TODO: Simplify shutdown process using upstream count instead
 		topology->attach_upstream(proc_arrow);
-
-		for (auto proc : m_components->get_evt_procs()) {
-			proc_arrow->add_processor(proc);
-		}
 		topology->sinks.push_back(proc_arrow);
 
 		return topology;
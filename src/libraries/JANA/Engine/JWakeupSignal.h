@@ -0,0 +1,72 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef JANA2_JWAKEUPSIGNAL_H
+#define JANA2_JWAKEUPSIGNAL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include <JANA/Utils/JCacheAligned.h>
+
+
+/// JWakeupSignal lets idle Workers park until a JMailbox receives new items, instead of polling.
+/// It is an event count: a Worker which is about to park first calls prepare_wait(), then checks
+/// one last time whether there is any work, and only then calls wait() with the ticket it got back.
+/// Anything pushed after prepare_wait() bumps the epoch, so the Worker can't miss it. If the Worker
+/// found work after all, it calls cancel_wait() instead.
+///
+/// notify() is on the JMailbox::push() hot path, so it only touches the mutex and condition
+/// variable when somebody is actually parked.
+class JWakeupSignal : public JCacheAligned {
+
+    alignas(CACHE_LINE_BYTES) std::atomic<uint64_t> m_epoch {0};
+    alignas(CACHE_LINE_BYTES) std::atomic<int> m_waiter_count {0};
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+
+public:
+
+    uint64_t prepare_wait() {
+        m_waiter_count.fetch_add(1, std::memory_order_seq_cst);
+        return m_epoch.load(std::memory_order_seq_cst);
+    }
+
+    void cancel_wait() {
+        m_waiter_count.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /// Blocks until notify() has been called since prepare_wait() returned ticket, or until timeout elapses.
+    /// Returns true if we were woken up, false if we timed out.
+    template <typename Rep, typename Period>
+    bool wait(uint64_t ticket, const std::chrono::duration<Rep, Period>& timeout) {
+        bool woken;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            woken = m_cv.wait_for(lock, timeout, [&]{ return m_epoch.load(std::memory_order_acquire) != ticket; });
+        }
+        m_waiter_count.fetch_sub(1, std::memory_order_relaxed);
+        return woken;
+    }
+
+    void notify() {
+        // The fence orders the caller's publication of new items before our read of m_waiter_count,
+        // pairing with the seq_cst increment in prepare_wait()
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_waiter_count.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_epoch.fetch_add(1, std::memory_order_release);
+        }
+        m_cv.notify_all();
+    }
+
+    int get_waiter_count() { return m_waiter_count.load(std::memory_order_relaxed); }
+};
+
+
+#endif //JANA2_JWAKEUPSIGNAL_H
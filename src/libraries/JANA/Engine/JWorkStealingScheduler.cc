@@ -0,0 +1,177 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include <JANA/Engine/JWorkStealingScheduler.h>
+#include <JANA/JException.h>
+
+
+JWorkStealingScheduler::WorkerDeque::WorkerDeque(size_t capacity) {
+    size_t rounded = 2;
+    while (rounded < capacity) rounded *= 2;
+    m_buffer = std::unique_ptr<std::atomic<JArrow*>[]>(new std::atomic<JArrow*>[rounded]);
+    for (size_t i=0; i<rounded; ++i) {
+        m_buffer[i].store(nullptr, std::memory_order_relaxed);
+    }
+    m_mask = static_cast<int64_t>(rounded) - 1;
+}
+
+bool JWorkStealingScheduler::WorkerDeque::push(JArrow* arrow) {
+    int64_t b = m_bottom.load(std::memory_order_relaxed);
+    int64_t t = m_top.load(std::memory_order_acquire);
+    if (b - t > m_mask) {
+        return false;  // Full
+    }
+    m_buffer[b & m_mask].store(arrow, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_bottom.store(b + 1, std::memory_order_relaxed);
+    return true;
+}
+
+JArrow* JWorkStealingScheduler::WorkerDeque::pop() {
+    int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = m_top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        // Deque was already empty
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    JArrow* arrow = m_buffer[b & m_mask].load(std::memory_order_relaxed);
+    if (t == b) {
+        // Last item: race against thieves for it
+        if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            arrow = nullptr;
+        }
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return arrow;
+}
+
+JArrow* JWorkStealingScheduler::WorkerDeque::steal() {
+    int64_t t = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = m_bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+        return nullptr;
+    }
+    JArrow* arrow = m_buffer[t & m_mask].load(std::memory_order_relaxed);
+    if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;  // Lost the race to the owner or to another thief
+    }
+    return arrow;
+}
+
+
+JWorkStealingScheduler::JWorkStealingScheduler(const std::vector<JArrow*>& arrows)
+    : JScheduler(arrows)
+    , m_deque_capacity(2 * arrows.size() + 2) {
+
+    m_deques = std::unique_ptr<std::atomic<WorkerDeque*>[]>(new std::atomic<WorkerDeque*>[MAX_WORKERS]);
+    for (size_t i=0; i<MAX_WORKERS; ++i) {
+        m_deques[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+JWorkStealingScheduler::~JWorkStealingScheduler() {
+    for (size_t i=0; i<MAX_WORKERS; ++i) {
+        delete m_deques[i].load();
+    }
+}
+
+
+JWorkStealingScheduler::WorkerDeque& JWorkStealingScheduler::get_or_create_deque(uint32_t worker_id) {
+
+    if (worker_id >= MAX_WORKERS) {
+        throw JException("JWorkStealingScheduler supports at most %d workers", (int) MAX_WORKERS);
+    }
+    WorkerDeque* deque = m_deques[worker_id].load(std::memory_order_acquire);
+    if (deque == nullptr) {
+        // Only the owning worker ever creates its deque, so this is a one-time slow path
+        auto created = new WorkerDeque(m_deque_capacity);
+        if (m_deques[worker_id].compare_exchange_strong(deque, created)) {
+            deque = created;
+        }
+        else {
+            delete created;
+        }
+        size_t high_water = m_worker_high_water.load();
+        while (high_water < worker_id + 1 && !m_worker_high_water.compare_exchange_weak(high_water, worker_id + 1)) {}
+    }
+    return *deque;
+}
+
+
+void JWorkStealingScheduler::refill(WorkerDeque& deque, uint32_t worker_id) {
+    // Push in reverse so that pops (LIFO) visit arrows in round-robin order, starting at an
+    // offset determined by worker_id. This spreads workers across the topology from the outset.
+    size_t n = m_arrows.size();
+    for (size_t i=0; i<n; ++i) {
+        deque.push(m_arrows[(worker_id + n - 1 - i) % n]);
+    }
+}
+
+
+JArrow* JWorkStealingScheduler::next_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status last_result) {
+
+    auto& deque = get_or_create_deque(worker_id);
+
+    // Check latest arrow back in
+    if (assignment != nullptr) {
+        bool keep = (last_result == JArrowMetrics::Status::KeepGoing);
+        release(assignment);
+        if (keep) {
+            // Arrow still has work, so we want to revisit it next
+            deque.push(assignment);
+        }
+    }
+
+    // 1. Continue our own pass
+    for (JArrow* candidate = deque.pop(); candidate != nullptr; candidate = deque.pop()) {
+        if (try_assign(candidate)) {
+            LOG_DEBUG(logger) << "Worker " << worker_id << ", "
+                              << ((assignment == nullptr) ? "idle" : assignment->get_name())
+                              << ", " << to_string(last_result) << " => "
+                              << candidate->get_name() << "  [" << candidate->get_thread_count() << "]" << LOG_END;
+            return candidate;
+        }
+    }
+
+    // 2. Steal from our siblings, taking at most one candidate from each
+    size_t worker_count = m_worker_high_water.load(std::memory_order_acquire);
+    for (size_t i=1; i<worker_count; ++i) {
+        WorkerDeque* victim = m_deques[(worker_id + i) % worker_count].load(std::memory_order_acquire);
+        if (victim == nullptr || victim == &deque) continue;
+        JArrow* candidate = victim->steal();
+        if (candidate != nullptr && try_assign(candidate)) {
+            LOG_DEBUG(logger) << "Worker " << worker_id << " stole " << candidate->get_name()
+                              << "  [" << candidate->get_thread_count() << "]" << LOG_END;
+            return candidate;
+        }
+    }
+
+    // 3. Start a fresh pass over the whole topology
+    refill(deque, worker_id);
+    for (JArrow* candidate = deque.pop(); candidate != nullptr; candidate = deque.pop()) {
+        if (try_assign(candidate)) {
+            LOG_DEBUG(logger) << "Worker " << worker_id << ", "
+                              << ((assignment == nullptr) ? "idle" : assignment->get_name())
+                              << ", " << to_string(last_result) << " => "
+                              << candidate->get_name() << "  [" << candidate->get_thread_count() << "]" << LOG_END;
+            return candidate;
+        }
+    }
+    return nullptr;  // We've looped through everything with no luck
+}
+
+
+void JWorkStealingScheduler::last_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status result) {
+
+    LOG_DEBUG(logger) << "Worker " << worker_id << ", "
+                      << ((assignment == nullptr) ? "idle" : assignment->get_name())
+                      << ", " << to_string(result) << ") => Shutting down!" << LOG_END;
+    if (assignment != nullptr) {
+        release(assignment);  // We may be the last one out of a finished arrow, which then has to deactivate
+    }
+}
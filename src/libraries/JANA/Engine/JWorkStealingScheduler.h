@@ -0,0 +1,68 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef JANA2_JWORKSTEALINGSCHEDULER_H
+#define JANA2_JWORKSTEALINGSCHEDULER_H
+
+#include <atomic>
+#include <memory>
+
+#include <JANA/Engine/JScheduler.h>
+#include <JANA/Utils/JCacheAligned.h>
+
+
+/// JWorkStealingScheduler assigns Arrows to Workers without a global lock. Each Worker owns a
+/// deque of candidate arrows, which it refills with its own round-robin pass over the topology
+/// whenever the deque runs dry. Workers pop candidates from the bottom of their own deque; a Worker
+/// whose own pass turns up nothing steals candidates from the top of its siblings' deques.
+/// Arrows which returned KeepGoing are pushed back onto the bottom of the Worker's deque so that
+/// hot arrows stay on the same thread, while remaining visible to idle thieves.
+///
+/// Whether a candidate may actually be assigned is decided by JScheduler::try_assign(), which
+/// keeps sequential arrows exclusive. The only shared writes on the hot path are therefore the
+/// per-arrow thread counts and the deque indices, all of which are atomic.
+///
+/// This preserves the next_assignment()/last_assignment() contract of JScheduler, so that
+/// JArrowProcessingController can swap it in via `jana:scheduler=1`.
+class JWorkStealingScheduler : public JScheduler {
+
+public:
+    /// The maximum number of distinct worker ids this scheduler can serve
+    static constexpr size_t MAX_WORKERS = 1024;
+
+private:
+
+    /// Bounded Chase-Lev deque. The owning Worker pushes and pops at the bottom, everyone
+    /// else steals from the top. Capacity is fixed at construction; a push which would
+    /// overflow is dropped, which is harmless because entries are only hints.
+    class alignas(CACHE_LINE_BYTES) WorkerDeque : public JCacheAligned {
+        std::atomic<int64_t> m_top {0};
+        alignas(CACHE_LINE_BYTES) std::atomic<int64_t> m_bottom {0};
+        alignas(CACHE_LINE_BYTES) std::unique_ptr<std::atomic<JArrow*>[]> m_buffer;
+        int64_t m_mask;
+
+    public:
+        explicit WorkerDeque(size_t capacity);
+        bool push(JArrow* arrow);
+        JArrow* pop();
+        JArrow* steal();
+    };
+
+    std::unique_ptr<std::atomic<WorkerDeque*>[]> m_deques;
+    std::atomic<size_t> m_worker_high_water {0};
+    size_t m_deque_capacity;
+
+    WorkerDeque& get_or_create_deque(uint32_t worker_id);
+    void refill(WorkerDeque& deque, uint32_t worker_id);
+
+public:
+
+    explicit JWorkStealingScheduler(const std::vector<JArrow*>& arrows);
+    ~JWorkStealingScheduler() override;
+
+    JArrow* next_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status result) override;
+    void last_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status result) override;
+};
+
+
+#endif //JANA2_JWORKSTEALINGSCHEDULER_H
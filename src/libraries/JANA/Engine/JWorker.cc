@@ -56,19 +56,23 @@ void JWorker::measure_perf(WorkerSummary& summary) {
     long scheduler_visit_count;
     JWorkerMetrics::duration_t total_useful_time, total_retry_time, total_scheduler_time, total_idle_time;
     JWorkerMetrics::duration_t last_useful_time, last_retry_time, last_scheduler_time, last_idle_time;
+    JWorkerMetrics::duration_t total_spin_time, last_spin_time;
     JWorkerMetrics::time_point_t last_heartbeat;
 
     latest_worker_metrics.get(last_heartbeat, scheduler_visit_count, total_useful_time, total_retry_time, total_scheduler_time,
-             total_idle_time, last_useful_time, last_retry_time, last_scheduler_time, last_idle_time);
+             total_idle_time, last_useful_time, last_retry_time, last_scheduler_time, last_idle_time,
+             total_spin_time, last_spin_time);
 
     summary.total_useful_time_ms = millis(total_useful_time).count();
     summary.total_retry_time_ms = millis(total_retry_time).count();
     summary.total_scheduler_time_ms = millis(total_scheduler_time).count();
     summary.total_idle_time_ms = millis(total_idle_time).count();
+    summary.total_spin_time_ms = millis(total_spin_time).count();
     summary.last_useful_time_ms = millis(last_useful_time).count();
     summary.last_retry_time_ms = millis(last_retry_time).count();
     summary.last_scheduler_time_ms = millis(last_scheduler_time).count();
     summary.last_idle_time_ms = millis(last_idle_time).count();
+    summary.last_spin_time_ms = millis(last_spin_time).count();
     summary.last_heartbeat_ms = millis(JWorkerMetrics::clock_t::now() - last_heartbeat).count();
 
     summary.worker_id = m_worker_id;
@@ -141,12 +145,18 @@ void JWorker::request_stop() {
     if (m_run_state == RunState::Running) {
         m_run_state = RunState::Stopping;
     }
+    if (m_wakeup_signal != nullptr) {
+        m_wakeup_signal->notify();
+    }
 }
 
 void JWorker::wait_for_stop() {
     if (m_run_state == RunState::Running) {
         m_run_state = RunState::Stopping;
     }
+    if (m_wakeup_signal != nullptr) {
+        m_wakeup_signal->notify();
+    }
     if (m_thread != nullptr) {
         if (m_run_state == RunState::TimedOut) {
             m_thread->detach();
@@ -166,6 +176,26 @@ void JWorker::wait_for_stop() {
     }
 }
 
+bool JWorker::idle(const JIdlePolicy& policy, uint32_t attempt, uint64_t ticket) {
+    switch (policy.get_phase(attempt)) {
+        case JIdlePolicy::Phase::Spin:
+            JIdlePolicy::spin();
+            return false;
+        case JIdlePolicy::Phase::Yield:
+            std::this_thread::yield();
+            return false;
+        case JIdlePolicy::Phase::Park:
+        default:
+            if (m_wakeup_signal != nullptr) {
+                m_wakeup_signal->wait(ticket, policy.park_timeout);
+            }
+            else {
+                std::this_thread::sleep_for(policy.park_timeout);
+            }
+            return true;
+    }
+}
+
 void JWorker::loop() {
     using jclock_t = JWorkerMetrics::clock_t;
     try {
@@ -177,6 +207,11 @@ void JWorker::loop() {
             LOG_DEBUG(logger) << "Worker " << m_worker_id << " is checking in" << LOG_END;
             auto start_time = jclock_t::now();
 
+            // If we are about to park, register with the wakeup signal _before_ asking the scheduler,
+            // so that anything pushed in the meantime wakes us up
+            bool parking = (m_wakeup_signal != nullptr && m_idle_policy.get_phase(m_idle_tries) == JIdlePolicy::Phase::Park);
+            uint64_t ticket = parking ? m_wakeup_signal->prepare_wait() : 0;
+
             {
                 std::lock_guard<std::mutex> lock(m_assignment_mutex);
                 m_assignment = m_scheduler->next_assignment(m_worker_id, m_assignment, last_result);
@@ -187,21 +222,27 @@ void JWorker::loop() {
 
             auto scheduler_duration = scheduler_time - start_time;
             auto idle_duration = jclock_t::duration::zero();
+            auto spin_duration = jclock_t::duration::zero();
             auto retry_duration = jclock_t::duration::zero();
             auto useful_duration = jclock_t::duration::zero();
 
             if (m_assignment == nullptr) {
 
                 LOG_DEBUG(logger) << "Worker " << m_worker_id << " idling due to lack of assignments" << LOG_END;
-                std::this_thread::sleep_for(std::chrono::microseconds(1));
-                idle_duration = jclock_t::now() - scheduler_time;
+                bool parked = idle(m_idle_policy, m_idle_tries++, ticket);
+                (parked ? idle_duration : spin_duration) = jclock_t::now() - scheduler_time;
             }
             else {
+                if (parking) {
+                    m_wakeup_signal->cancel_wait();
+                }
+                m_idle_tries = 0;
 
                 auto initial_backoff_time = m_assignment->get_initial_backoff_time();
                 auto backoff_strategy = m_assignment->get_backoff_strategy();
                 auto backoff_tries = m_assignment->get_backoff_tries();
                 auto checkin_time = m_assignment->get_checkin_time();
+                auto idle_policy = m_assignment->get_idle_policy();
 
                 uint32_t current_tries = 0;
                 auto backoff_duration = initial_backoff_time;
@@ -213,11 +254,23 @@ void JWorker::loop() {
 
                     LOG_TRACE(logger) << "Worker " << m_worker_id << " is executing "
                                       << m_assignment->get_name() << LOG_END;
+
+                    bool adaptive_parking = (backoff_strategy == JArrow::BackoffStrategy::Adaptive &&
+                                             m_wakeup_signal != nullptr &&
+                                             idle_policy.get_phase(current_tries) == JIdlePolicy::Phase::Park);
+                    uint64_t adaptive_ticket = adaptive_parking ? m_wakeup_signal->prepare_wait() : 0;
+
                     auto before_execute_time = jclock_t::now();
                     m_assignment->execute(m_arrow_metrics, m_location_id);
                     last_result = m_arrow_metrics.get_last_status();
                     useful_duration += (jclock_t::now() - before_execute_time);
 
+                    bool will_retry = (last_result == JArrowMetrics::Status::ComeBackLater && current_tries < backoff_tries);
+                    if (adaptive_parking && !will_retry) {
+                        // We aren't going to park after all
+                        m_wakeup_signal->cancel_wait();
+                    }
+
 
                     if (last_result == JArrowMetrics::Status::KeepGoing) {
                         LOG_DEBUG(logger) << "Worker " << m_worker_id << " succeeded at "
@@ -227,7 +280,14 @@ void JWorker::loop() {
                     }
                     else {
                         current_tries++;
-                        if (backoff_tries > 0) {
+                        if (backoff_strategy == JArrow::BackoffStrategy::Adaptive) {
+                            if (will_retry) {
+                                auto before_idle_time = jclock_t::now();
+                                bool parked = idle(idle_policy, current_tries - 1, adaptive_ticket);
+                                (parked ? retry_duration : spin_duration) += jclock_t::now() - before_idle_time;
+                            }
+                        }
+                        else if (backoff_tries > 0) {
                             if (backoff_strategy == JArrow::BackoffStrategy::Linear) {
                                 backoff_duration += initial_backoff_time;
                             }
@@ -244,7 +304,7 @@ void JWorker::loop() {
                     }
                 }
             }
-            m_worker_metrics.update(start_time, 1, useful_duration, retry_duration, scheduler_duration, idle_duration);
+            m_worker_metrics.update(start_time, 1, useful_duration, retry_duration, scheduler_duration, idle_duration, spin_duration);
             if (m_assignment != nullptr) {
                 JArrowMetrics latest_arrow_metrics;
                 latest_arrow_metrics.clear();
@@ -8,6 +8,8 @@
 #include <thread>
 #include <JANA/Services/JLoggingService.h>
 #include <JANA/Engine/JScheduler.h>
+#include <JANA/Engine/JIdlePolicy.h>
+#include <JANA/Engine/JWakeupSignal.h>
 #include <JANA/Engine/JWorkerMetrics.h>
 #include <JANA/Engine/JArrowPerfSummary.h>
 
@@ -39,6 +41,13 @@ private:
     JWorkerMetrics m_worker_metrics;
     JArrowMetrics m_arrow_metrics;
     std::mutex m_assignment_mutex;
+    JIdlePolicy m_idle_policy;                   // Used when the scheduler has nothing for us
+    JWakeupSignal* m_wakeup_signal = nullptr;    // Non-owning. If null, the Park phase sleeps instead.
+    uint32_t m_idle_tries = 0;
+
+    /// Spins, yields, or parks according to the policy's phase for this attempt. The caller must have called
+    /// m_wakeup_signal->prepare_wait() iff parking. Returns true if the time spent counts as idle rather than spin.
+    bool idle(const JIdlePolicy& policy, uint32_t attempt, uint64_t ticket);
 
 public:
     JWorker(JScheduler* scheduler, unsigned worker_id, unsigned cpu_id, unsigned domain_id, bool pin_to_cpu);
@@ -58,6 +67,10 @@ public:
     void wait_for_stop();
     void declare_timeout();
 
+    /// These are meant to be called before start()
+    void set_idle_policy(const JIdlePolicy& idle_policy) { m_idle_policy = idle_policy; }
+    void set_wakeup_signal(JWakeupSignal* wakeup_signal) { m_wakeup_signal = wakeup_signal; }
+
     /// This is what the encapsulated thread is supposed to be doing
     void loop();
 
@@ -32,11 +32,13 @@ private:
     duration_t m_total_useful_time;
     duration_t m_total_retry_time;
     duration_t m_total_scheduler_time;
-    duration_t m_total_idle_time;
+    duration_t m_total_idle_time;           // Parked or asleep, waiting for work
+    duration_t m_total_spin_time;           // Busy-waiting or yielding, waiting for work
     duration_t m_last_useful_time;
     duration_t m_last_retry_time;
     duration_t m_last_scheduler_time;
     duration_t m_last_idle_time;
+    duration_t m_last_spin_time;
 
 
 public:
@@ -49,10 +51,12 @@ public:
         m_total_retry_time = zero;
         m_total_scheduler_time = zero;
         m_total_idle_time = zero;
+        m_total_spin_time = zero;
         m_last_useful_time = zero;
         m_last_retry_time = zero;
         m_last_scheduler_time = zero;
         m_last_idle_time = zero;
+        m_last_spin_time = zero;
         m_mutex.unlock();
     }
 
@@ -65,10 +69,12 @@ public:
         m_total_retry_time = zero;
         m_total_scheduler_time = zero;
         m_total_idle_time = zero;
+        m_total_spin_time = zero;
         m_last_useful_time = zero;
         m_last_retry_time = zero;
         m_last_scheduler_time = zero;
         m_last_idle_time = zero;
+        m_last_spin_time = zero;
         m_mutex.unlock();
     }
 
@@ -83,10 +89,12 @@ public:
         m_total_retry_time += other.m_total_retry_time;
         m_total_scheduler_time += other.m_total_scheduler_time;
         m_total_idle_time += other.m_total_idle_time;
+        m_total_spin_time += other.m_total_spin_time;
         m_last_useful_time = other.m_last_useful_time;
         m_last_retry_time = other.m_last_retry_time;
         m_last_scheduler_time = other.m_last_scheduler_time;
         m_last_idle_time = other.m_last_idle_time;
+        m_last_spin_time = other.m_last_spin_time;
         other.m_mutex.unlock();
         m_mutex.unlock();
     }
@@ -98,7 +106,8 @@ public:
                 const duration_t& useful_time,
                 const duration_t& retry_time,
                 const duration_t& scheduler_time,
-                const duration_t& idle_time) {
+                const duration_t& idle_time,
+                const duration_t& spin_time = duration_t::zero()) {
 
         m_mutex.lock();
         m_scheduler_visit_count += scheduler_visit_count;
@@ -106,10 +115,12 @@ public:
         m_total_retry_time += retry_time;
         m_total_scheduler_time += scheduler_time;
         m_total_idle_time += idle_time;
+        m_total_spin_time += spin_time;
         m_last_useful_time = useful_time;
         m_last_retry_time = retry_time;
         m_last_scheduler_time = scheduler_time;
         m_last_idle_time = idle_time;
+        m_last_spin_time = spin_time;
         m_last_heartbeat = heartbeat;
         m_mutex.unlock();
     }
@@ -125,7 +136,9 @@ public:
              duration_t& last_useful_time,
              duration_t& last_retry_time,
              duration_t& last_scheduler_time,
-             duration_t& last_idle_time) {
+             duration_t& last_idle_time,
+             duration_t& total_spin_time,
+             duration_t& last_spin_time) {
 
         m_mutex.lock();
         scheduler_visit_count = m_scheduler_visit_count;
@@ -137,6 +150,8 @@ public:
         last_retry_time = m_last_retry_time;
         last_scheduler_time = m_last_scheduler_time;
         last_idle_time = m_last_idle_time;
+        total_spin_time = m_total_spin_time;
+        last_spin_time = m_last_spin_time;
         last_heartbeat = m_last_heartbeat;
         m_mutex.unlock();
     }
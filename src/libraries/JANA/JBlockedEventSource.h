@@ -18,7 +18,10 @@ public:
 
 	virtual Status NextBlock(BlockType& block) = 0;
 
-	virtual std::vector<std::shared_ptr<JEvent>> DisentangleBlock(BlockType& block, JEventPool& pool) = 0;
+	/// DisentangleBlock() gets events from pool, fills them from block, and returns them. It used to return
+	/// std::vector<std::shared_ptr<JEvent>>. Since the pool now hands out plain JEvent*, which it keeps owning,
+	/// existing overrides have to change their return type accordingly; their bodies usually don't have to change.
+	virtual std::vector<JEvent*> DisentangleBlock(BlockType& block, JEventPool& pool) = 0;
 };
 
 
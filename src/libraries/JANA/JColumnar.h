@@ -0,0 +1,151 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef _JColumnar_h_
+#define _JColumnar_h_
+
+#include <JANA/JObject.h>
+#include <JANA/JException.h>
+#include <JANA/Utils/JSpan.h>
+#include <JANA/Utils/JTypeInfo.h>
+
+#include <string>
+#include <vector>
+
+/// JColumnar is the base class for structure-of-arrays collections. Instead of one JObject per hit, a
+/// columnar collection keeps one contiguous JColumn per member, which is what tight numerical loops want.
+/// Columns register themselves with the collection they are declared in, like this:
+///
+///     struct CalorimeterHits : public JColumnar {
+///         JColumn<int> cell {this, "cell", "%d"};
+///         JColumn<float> energy {this, "energy", "%f", "GeV"};
+///     };
+///
+/// Every column must have the same length, i.e. each row is one hit. Collections are produced by a
+/// JColumnarFactoryT and read back through JEvent::GetColumns() or JEvent::GetColumn(). Tools which only
+/// understand JObjects see one lazily created JColumnarRow per row instead.
+
+class JColumnar;
+
+/// JColumnBase is the type-erased interface which lets a JColumnar manage its columns
+class JColumnBase {
+protected:
+    std::string m_name;
+    std::string m_format;
+    std::string m_description;
+
+public:
+    inline JColumnBase(JColumnar* owner, std::string name, std::string format, std::string description);
+
+    JColumnBase(const JColumnBase&) = delete;
+    JColumnBase& operator=(const JColumnBase&) = delete;
+    virtual ~JColumnBase() = default;
+
+    const std::string& GetName() const { return m_name; }
+    const std::string& GetDescription() const { return m_description; }
+
+    virtual size_t Size() const = 0;
+    virtual void Clear() = 0;
+    virtual void SummarizeRow(size_t row, JObjectSummary& summary) const = 0;
+};
+
+
+/// JColumn holds one member of a columnar collection, for all rows
+template <typename T>
+class JColumn : public JColumnBase {
+    std::vector<T> m_data;
+
+public:
+    JColumn(JColumnar* owner, std::string name, std::string format, std::string description = "")
+        : JColumnBase(owner, std::move(name), std::move(format), std::move(description)) {}
+
+    void push_back(const T& value) { m_data.push_back(value); }
+    void reserve(size_t capacity) { m_data.reserve(capacity); }
+    void resize(size_t size) { m_data.resize(size); }
+
+    size_t size() const { return m_data.size(); }
+    T* data() { return m_data.data(); }
+    const T* data() const { return m_data.data(); }
+    T& operator[](size_t row) { return m_data[row]; }
+    const T& operator[](size_t row) const { return m_data[row]; }
+    typename std::vector<T>::const_iterator begin() const { return m_data.begin(); }
+    typename std::vector<T>::const_iterator end() const { return m_data.end(); }
+
+    JSpan<T> Span() { return {m_data.data(), m_data.size()}; }
+    JSpan<const T> Span() const { return {m_data.data(), m_data.size()}; }
+
+    size_t Size() const override { return m_data.size(); }
+
+    /// Clear() keeps the capacity, so that the next event doesn't have to allocate again
+    void Clear() override { m_data.clear(); }
+
+    void SummarizeRow(size_t row, JObjectSummary& summary) const override {
+        summary.add(m_data[row], m_name.c_str(), m_format.c_str(), m_description.c_str());
+    }
+};
+
+
+class JColumnar {
+    std::vector<JColumnBase*> m_columns;
+    friend class JColumnBase;
+
+public:
+    JColumnar() = default;
+    JColumnar(const JColumnar&) = delete;  // Columns hold on to their collection
+    JColumnar& operator=(const JColumnar&) = delete;
+    virtual ~JColumnar() = default;
+
+    const std::vector<JColumnBase*>& GetColumns() const { return m_columns; }
+
+    /// Size() returns the number of rows, and throws if the columns don't agree on it
+    size_t Size() const {
+        if (m_columns.empty()) return 0;
+        size_t size = m_columns[0]->Size();
+        for (auto column : m_columns) {
+            if (column->Size() != size) {
+                throw JException("JColumnar: Column '%s' has %zu rows, but column '%s' has %zu",
+                                 column->GetName().c_str(), column->Size(), m_columns[0]->GetName().c_str(), size);
+            }
+        }
+        return size;
+    }
+
+    void Clear() {
+        for (auto column : m_columns) column->Clear();
+    }
+
+    void SummarizeRow(size_t row, JObjectSummary& summary) const {
+        for (auto column : m_columns) column->SummarizeRow(row, summary);
+    }
+};
+
+JColumnBase::JColumnBase(JColumnar* owner, std::string name, std::string format, std::string description)
+    : m_name(std::move(name)), m_format(std::move(format)), m_description(std::move(description)) {
+    owner->m_columns.push_back(this);
+}
+
+
+/// JColumnarRow is a lightweight JObject which stands for one row of a columnar collection. It lets
+/// JObject-based tools such as JInspector, janacontrol, and JCsvWriter summarize columnar data.
+template <typename T>
+class JColumnarRow : public JObject {
+    const T* m_columns;
+    size_t m_row;
+
+public:
+    JColumnarRow(const T* columns, size_t row) : m_columns(columns), m_row(row) {}
+
+    const T& GetColumns() const { return *m_columns; }
+    size_t GetRow() const { return m_row; }
+
+    const std::string className() const override {
+        return JTypeInfo::demangle_cached<T>();
+    }
+
+    void Summarize(JObjectSummary& summary) const override {
+        m_columns->SummarizeRow(m_row, summary);
+    }
+};
+
+
+#endif // _JColumnar_h_
@@ -0,0 +1,79 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef _JColumnarFactoryT_h_
+#define _JColumnarFactoryT_h_
+
+#include <JANA/JColumnar.h>
+#include <JANA/JFactoryT.h>
+
+#include <type_traits>
+
+/// JColumnarFactoryT produces a structure-of-arrays collection T (see JColumnar) instead of a vector of
+/// individually allocated objects. Users override ProcessColumns() and fill in the collection they are handed,
+/// which is cleared, but keeps its capacity, between events:
+///
+///     struct CalorimeterHitFactory : public JColumnarFactoryT<CalorimeterHits> {
+///         void ProcessColumns(const std::shared_ptr<const JEvent>& event, CalorimeterHits& hits) override {
+///             hits.cell.push_back(7);
+///             hits.energy.push_back(22.2);
+///         }
+///     };
+///
+/// To everyone else, the factory looks like a JFactoryT<T> containing exactly one object, the collection.
+/// JEvent::GetColumns<T>() and JEvent::GetColumn() build on that. For JObject-based tools, GetAs<JObject>()
+/// returns one JColumnarRow per row; these are only created when somebody actually asks for them.
+template <typename T>
+class JColumnarFactoryT : public JFactoryT<T> {
+    static_assert(std::is_base_of<JColumnar, T>::value, "JColumnarFactoryT<T> requires T to derive from JColumnar");
+
+    T mColumns;
+    std::vector<JColumnarRow<T>> mRows;
+
+public:
+    JColumnarFactoryT() {
+        // The collection is a member of the factory, so nobody else may delete it
+        this->SetFactoryFlag(JFactory::NOT_OBJECT_OWNER);
+
+        auto upcast_lambda = [this]() {
+            std::vector<JObject*> results;
+            if (this->mData.empty()) return results;
+            size_t row_count = mColumns.Size();
+            if (mRows.size() != row_count) {
+                mRows.clear();
+                mRows.reserve(row_count);
+                for (size_t row=0; row<row_count; ++row) {
+                    mRows.emplace_back(&mColumns, row);
+                }
+            }
+            results.reserve(row_count);
+            for (auto& row : mRows) {
+                results.push_back(&row);
+            }
+            return results;
+        };
+        using upcast_fn_t = std::function<std::vector<JObject*>()>;
+        this->mUpcastVTable[std::type_index(typeid(JObject))] =
+                std::unique_ptr<JAny>(new JAnyT<upcast_fn_t>(std::move(upcast_lambda)));
+    }
+
+    /// ProcessColumns() is where users fill in the collection, instead of Process()
+    virtual void ProcessColumns(const std::shared_ptr<const JEvent>&, T&) {}
+
+    void Process(const std::shared_ptr<const JEvent>& event) final {
+        ProcessColumns(event, mColumns);
+        mColumns.Size();  // Throws if the user left the columns with different lengths
+        this->mData.push_back(&mColumns);
+    }
+
+    void ClearData() override {
+        if (this->mStatus != JFactory::Status::Uninitialized && !this->TestFactoryFlag(JFactory::PERSISTENT)) {
+            mRows.clear();
+            mColumns.Clear();
+        }
+        JFactoryT<T>::ClearData();
+    }
+};
+
+
+#endif // _JColumnarFactoryT_h_
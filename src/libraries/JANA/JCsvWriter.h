@@ -44,7 +44,9 @@ public:
     void Process(const std::shared_ptr<const JEvent>& event) override {
 
         auto event_nr = event->GetEventNumber();
-        auto jobjs = event->Get<T>(m_tag);
+        event->GetIterators<T>(m_tag);  // Makes sure that the factory has run
+        // Going through GetAs<JObject>() means that columnar collections get written out row by row
+        auto jobjs = event->GetFactory<T>(m_tag, true)->template GetAs<JObject>();
 
         std::lock_guard<std::mutex> lock(m_mutex);
 
@@ -7,6 +7,7 @@
 
 
 #include <JANA/JObject.h>
+#include <JANA/JColumnar.h>
 #include <JANA/JException.h>
 #include <JANA/JFactoryT.h>
 #include <JANA/JFactorySet.h>
@@ -16,6 +17,8 @@
 #include <JANA/Utils/JTypeInfo.h>
 #include <JANA/Utils/JCpuInfo.h>
 #include <JANA/Utils/JCallGraphRecorder.h>
+#include <JANA/Utils/JEventArena.h>
+#include <JANA/Utils/JConcatSpan.h>
 
 #include <vector>
 #include <cstddef>
@@ -33,7 +36,10 @@ class JEvent : public JResettable, public std::enable_shared_from_this<JEvent>
 {
     public:
 
-        explicit JEvent(JApplication* aApplication=nullptr) : mInspector(&(*this)) {
+        explicit JEvent(JApplication* aApplication=nullptr)
+            : mInspector(&(*this))
+            , mHandle(std::shared_ptr<JEvent>(), this)
+            , mConstHandle(std::shared_ptr<const JEvent>(), this) {
             mApplication = aApplication;
         }
         virtual ~JEvent() {
@@ -44,6 +50,7 @@ class JEvent : public JResettable, public std::enable_shared_from_this<JEvent>
         void SetFactorySet(JFactorySet* aFactorySet) {
             delete mFactorySet;
             mFactorySet = aFactorySet;
+            if (mFactorySet != nullptr) mFactorySet->SetArena(&mArena);
         }
 
         JFactorySet* GetFactorySet() const { return mFactorySet; }
@@ -69,9 +76,21 @@ class JEvent : public JResettable, public std::enable_shared_from_this<JEvent>
         template<class T> std::vector<const T*> GetAll() const;
         template<class T> std::map<std::pair<std::string,std::string>,std::vector<T*>> GetAllChildren() const;
 
+        // Copy-free getters. The views are valid until the event is recycled.
+        template<class T> JSpan<const T* const> GetSpan(const std::string& tag = "") const;
+        template<class T> JConcatSpan<T> GetAllSpan() const;
+
+        // Columnar getters
+        template<class T> const T& GetColumns(const std::string& tag = "") const;
+        template<class T, class C> JSpan<const C> GetColumn(JColumn<C> T::* column, const std::string& tag = "") const;
+
         // JANA1 compatibility getters
         template<class T> JFactoryT<T>* GetSingle(const T* &t, const char *tag="", bool exception_if_not_one=true) const;
 
+        // Arena allocation
+        template <class T, typename... Args> T* Create(Args&&... args) const;
+        JEventArena* GetArena() const { return &mArena; }
+
         // Insert
         template <class T> JFactoryT<T>* Insert(T* item, const std::string& aTag = "") const;
         template <class T> JFactoryT<T>* Insert(const std::vector<T*>& items, const std::string& tag = "") const;
@@ -93,7 +112,13 @@ class JEvent : public JResettable, public std::enable_shared_from_this<JEvent>
         JInspector* GetJInspector() const {return &mInspector;}
         void Inspect() const { mInspector.Loop();} // TODO: Force this not to be inlined AND used so it is defined in libJANA.a
         bool GetSequential() const {return mIsBarrierEvent;}
+        /// GetEventIndex() tells the position of this event within the stream emitted by all event sources,
+        /// counting from zero. It is only assigned when some JEventProcessor has requested ordered events.
+        uint64_t GetEventIndex() const {return mEventIndex;}
         friend class JEventPool;
+        friend class JEventSourceArrow;
+        friend class JEventProcessorArrow;
+        friend class JFactoryPrefetcher;
 
     private:
         JApplication* mApplication = nullptr;
@@ -102,10 +127,32 @@ class JEvent : public JResettable, public std::enable_shared_from_this<JEvent>
         mutable JFactorySet* mFactorySet = nullptr;
         mutable JCallGraphRecorder mCallGraph;
         mutable JInspector mInspector;
+        mutable JEventArena mArena;
         JEventSource* mEventSource = nullptr;
         bool mIsBarrierEvent = false;
+        size_t mPoolLocation = 0;   // Location whose JEventPool partition owns (and first touched) this event
+        size_t mPoolSource = 0;     // Index of the event source whose JEventPool partition owns this event
+        size_t mPoolIndex = 0;      // Position within that partition's list of owned events
+        uint64_t mEventIndex = 0;   // Position in the emitted event stream, used for restoring order
+
+        // The shared_ptrs to this event which the engine hands to factories, processors and sources, by reference,
+        // so that passing them along never touches a reference count. A JEventPool makes them owning: the event
+        // then owns itself until the pool lets go of it, and stays alive for as long as user code holds a copy.
+        // Events which don't come from a JEventPool are owned by whoever created them, and their handles don't
+        // own anything, so user code must not keep those around.
+        std::shared_ptr<JEvent> mHandle;
+        std::shared_ptr<const JEvent> mConstHandle;
 };
 
+/// Create() constructs a T in the event's arena instead of on the heap. The object stays valid until the event is
+/// recycled, at which point it gets destroyed along with everything else in the arena, in one go. It can be
+/// handed to Insert() or to a factory like any other object, and owning factories won't try to delete it.
+/// Because of this, it must not end up in a PERSISTENT factory, or anywhere else that outlives the event.
+template <class T, typename... Args>
+inline T* JEvent::Create(Args&&... args) const {
+    return mArena.Create<T>(std::forward<Args>(args)...);
+}
+
 /// Insert() allows an EventSource to insert items directly into the JEvent,
 /// removing the need for user-extended JEvents and/or JEventSource::GetObjects(...)
 /// Repeated calls to Insert() will append to the previous data rather than overwrite it,
@@ -174,7 +221,7 @@ inline JMetadata<T> JEvent::GetMetadata(const std::string& tag) const {
         throw JException("Could not find JFactoryT<" + JTypeInfo::demangle<T>() + "> with tag=" + tag);
     };
     // Make sure that JFactoryT::Process has already been called before returning the metadata
-    factory->GetOrCreate(this->shared_from_this(), mApplication, mRunNumber);
+    factory->GetOrCreate(mConstHandle, mApplication, mRunNumber);
 
     return factory->GetMetadata();
 }
@@ -192,9 +239,9 @@ inline JMetadata<T> JEvent::GetMetadata(const std::string& tag) const {
 template<class T>
 JFactoryT<T>* JEvent::Get(const T** destination, const std::string& tag) const
 {
-    mCallGraph.StartFactoryCall(JTypeInfo::demangle<T>(), tag);
+    mCallGraph.StartFactoryCall(JTypeInfo::demangle_cached<T>(), tag);
     auto factory = GetFactory<T>(tag, true);
-    auto iterators = factory->GetOrCreate(this->shared_from_this(), mApplication, mRunNumber);
+    auto iterators = factory->GetOrCreate(mConstHandle, mApplication, mRunNumber);
     if (std::distance(iterators.first, iterators.second) == 0) {
         *destination = nullptr;
     }
@@ -209,12 +256,11 @@ JFactoryT<T>* JEvent::Get(const T** destination, const std::string& tag) const
 template<class T>
 JFactoryT<T>* JEvent::Get(std::vector<const T*>& destination, const std::string& tag) const
 {
-    mCallGraph.StartFactoryCall(JTypeInfo::demangle<T>(), tag);
+    mCallGraph.StartFactoryCall(JTypeInfo::demangle_cached<T>(), tag);
     auto factory = GetFactory<T>(tag, true);
-    auto iterators = factory->GetOrCreate(this->shared_from_this(), mApplication, mRunNumber);
-    for (auto it=iterators.first; it!=iterators.second; it++) {
-        destination.push_back(*it);
-    }
+    factory->GetOrCreate(mConstHandle, mApplication, mRunNumber);
+    auto span = factory->GetSpan();
+    destination.insert(destination.end(), span.begin(), span.end());
     mCallGraph.FinishFactoryCall();
     return factory;
 }
@@ -230,8 +276,8 @@ JFactoryT<T>* JEvent::Get(std::vector<const T*>& destination, const std::string&
 /// - If the factory contains more than one item, GetSingle returns the first item
 
 template<class T> const T* JEvent::GetSingle(const std::string& tag) const {
-    mCallGraph.StartFactoryCall(JTypeInfo::demangle<T>(), tag);
-    auto iterators = GetFactory<T>(tag, true)->GetOrCreate(this->shared_from_this(), mApplication, mRunNumber);
+    mCallGraph.StartFactoryCall(JTypeInfo::demangle_cached<T>(), tag);
+    auto iterators = GetFactory<T>(tag, true)->GetOrCreate(mConstHandle, mApplication, mRunNumber);
     if (std::distance(iterators.first, iterators.second) == 0) {
         mCallGraph.FinishFactoryCall();
         return nullptr;
@@ -247,8 +293,8 @@ template<class T> const T* JEvent::GetSingle(const std::string& tag) const {
 /// - If the factory exists but contains no items, GetSingleStrict throws an exception
 /// - If the factory contains more than one item, GetSingleStrict throws an exception
 template<class T> const T* JEvent::GetSingleStrict(const std::string& tag) const {
-    mCallGraph.StartFactoryCall(JTypeInfo::demangle<T>(), tag);
-    auto iterators = GetFactory<T>(tag, true)->GetOrCreate(this->shared_from_this(), mApplication, mRunNumber);
+    mCallGraph.StartFactoryCall(JTypeInfo::demangle_cached<T>(), tag);
+    auto iterators = GetFactory<T>(tag, true)->GetOrCreate(mConstHandle, mApplication, mRunNumber);
     mCallGraph.FinishFactoryCall();
     if (std::distance(iterators.first, iterators.second) == 0) {
         throw JException("GetSingle failed due to missing %d", NAME_OF(T));
@@ -260,17 +306,23 @@ template<class T> const T* JEvent::GetSingleStrict(const std::string& tag) const
 }
 
 
+/// Get returns a copy of the pointers held by the factory. GetSpan avoids the copy.
 template<class T>
 std::vector<const T*> JEvent::Get(const std::string& tag) const {
+    auto span = GetSpan<T>(tag);
+    return std::vector<const T*>(span.begin(), span.end());
+}
 
-    mCallGraph.StartFactoryCall(JTypeInfo::demangle<T>(), tag);
-    auto iters = GetFactory<T>(tag, true)->GetOrCreate(this->shared_from_this(), mApplication, mRunNumber);
-    std::vector<const T*> vec;
-    for (auto it=iters.first; it!=iters.second; ++it) {
-        vec.push_back(*it);
-    }
+/// GetSpan views the objects held by the factory, creating them if necessary, without copying anything.
+/// - If the factory is missing, GetSpan throws an exception
+/// - The span is valid until the event is recycled
+template<class T>
+JSpan<const T* const> JEvent::GetSpan(const std::string& tag) const {
+    mCallGraph.StartFactoryCall(JTypeInfo::demangle_cached<T>(), tag);
+    auto factory = GetFactory<T>(tag, true);
+    factory->GetOrCreate(mConstHandle, mApplication, mRunNumber);
     mCallGraph.FinishFactoryCall();
-    return vec; // Assumes RVO
+    return factory->GetSpan();
 }
 
 /// GetFactoryAll returns all JFactoryT's for type T (each corresponds to a different tag).
@@ -290,29 +342,32 @@ inline std::vector<JFactoryT<T>*> JEvent::GetFactoryAll(bool throw_on_missing) c
 /// GetAll returns all JObjects of (child) type T, regardless of tag.
 template<class T>
 void JEvent::GetAll(std::vector<const T*>& destination) const {
-    auto factories = GetFactoryAll<T>(true);
-    for (auto factory : factories) {
-        auto iterators = factory->GetOrCreate(this->shared_from_this(), mApplication, mRunNumber);
-        for (auto it = iterators.first; it != iterators.second; it++) {
-            destination.push_back(*it);
-        }
-    }
+    auto span = GetAllSpan<T>();
+    destination.insert(destination.end(), span.begin(), span.end());
 }
 
 /// GetAll returns all JObjects of (child) type T, regardless of tag.
 template<class T>
 std::vector<const T*> JEvent::GetAll() const {
     std::vector<const T*> vec;
-    auto factories = GetFactoryAll<T>(true);
+    GetAll(vec);
+    return vec; // Assumes RVO
+}
 
-    for (auto factory : factories) {
-        auto iters = factory->GetOrCreate(this->shared_from_this(), mApplication, mRunNumber);
-        std::vector<const T*> vec;
-        for (auto it = iters.first; it != iters.second; ++it) {
-            vec.push_back(*it);
-        }
+/// GetAllSpan views all JObjects of (child) type T, regardless of tag, creating them if necessary,
+/// without copying anything.
+/// - If there are no factories for T, GetAllSpan throws an exception
+/// - The view is valid until the event is recycled
+template<class T>
+JConcatSpan<T> JEvent::GetAllSpan() const {
+    auto range = mFactorySet->GetFactoryRange<T>();
+    if (range.first == range.second) {
+        throw JException("Could not find any JFactoryT<" + JTypeInfo::demangle<T>() + "> (from any tag)");
     }
-    return vec; // Assumes RVO
+    for (auto it = range.first; it != range.second; ++it) {
+        static_cast<JFactoryT<T>*>(it->second)->GetOrCreate(mConstHandle, mApplication, mRunNumber);
+    }
+    return JConcatSpan<T>(range.first, range.second);
 }
 
 
@@ -337,13 +392,36 @@ std::map<std::pair<std::string, std::string>, std::vector<S*>> JEvent::GetAllChi
 
 template<class T>
 typename JFactoryT<T>::PairType JEvent::GetIterators(const std::string& tag) const {
-    mCallGraph.StartFactoryCall(JTypeInfo::demangle<T>(), tag);
-    auto iters =GetFactory<T>(tag, true)->GetOrCreate(this->shared_from_this(), mApplication, mRunNumber);
+    mCallGraph.StartFactoryCall(JTypeInfo::demangle_cached<T>(), tag);
+    auto iters =GetFactory<T>(tag, true)->GetOrCreate(mConstHandle, mApplication, mRunNumber);
     mCallGraph.FinishFactoryCall();
     return iters;
 }
 
 
+/// GetColumns returns the structure-of-arrays collection T produced by a JColumnarFactoryT<T> (see JColumnar).
+/// - If the factory is missing, GetColumns throws an exception
+/// - If the factory doesn't contain exactly one collection, GetColumns throws an exception
+template<class T>
+const T& JEvent::GetColumns(const std::string& tag) const {
+    mCallGraph.StartFactoryCall(JTypeInfo::demangle_cached<T>(), tag);
+    auto iters = GetFactory<T>(tag, true)->GetOrCreate(mConstHandle, mApplication, mRunNumber);
+    mCallGraph.FinishFactoryCall();
+    if (std::distance(iters.first, iters.second) != 1) {
+        throw JException("GetColumns failed because JFactoryT<%s> with tag '%s' doesn't contain exactly one collection",
+                         JTypeInfo::demangle_cached<T>().c_str(), tag.c_str());
+    }
+    return **iters.first;
+}
+
+/// GetColumn returns a single column of a structure-of-arrays collection, e.g. GetColumn(&CalorimeterHits::energy).
+/// The span stays valid until the event is recycled.
+template<class T, class C>
+JSpan<const C> JEvent::GetColumn(JColumn<C> T::* column, const std::string& tag) const {
+    return (GetColumns<T>(tag).*column).Span();
+}
+
+
 template<class T>
 JFactoryT<T>* JEvent::GetSingle(const T* &t, const char *tag, bool exception_if_not_one) const
 {
@@ -359,7 +437,7 @@ JFactoryT<T>* JEvent::GetSingle(const T* &t, const char *tag, bool exception_if_
     /// exception_if_not_one to false. In that case, you will have to check if t==NULL to
     /// know if the call succeeded.
 
-    mCallGraph.StartFactoryCall(JTypeInfo::demangle<T>(), tag);
+    mCallGraph.StartFactoryCall(JTypeInfo::demangle_cached<T>(), tag);
     std::vector<const T*> v;
     JFactoryT<T> *fac = Get(v, tag);
     if(v.size()!=1){
@@ -164,13 +164,17 @@ protected:
     /// these two processors. If you don't set a resource name at all, the parallelization engine will
     /// assume that you are manually synchronizing access via your own mutex, which will be safe if and only
     /// if you use your locks correctly, and also may result in a performance penalty.
+    /// Concretely, all EventProcessors sharing a resource name are run one event at a time in their own
+    /// stage of the pipeline, downstream of the EventProcessors without a resource name, which run in parallel.
 
     void SetResourceName(std::string resource_name) { m_resource_name = std::move(resource_name); }
 
     /// SetEventsOrdered allows the user to tell the parallelization engine that it needs to see
-    /// the event stream ordered by increasing event IDs. (Note that this requires all EventSources
-    /// emit event IDs which are consecutive.) Ordering by event ID makes for cleaner output, but comes
-    /// with a performance penalty, so it is best if this is enabled during debugging, and disabled otherwise.
+    /// the event stream in the order the EventSources emitted it, which for a single EventSource emitting
+    /// consecutive event IDs is the order of increasing event IDs. All such EventProcessors run one event at
+    /// a time in the last stage of the pipeline, behind a bounded reordering window (jana:event_reorder_window).
+    /// Ordering makes for cleaner output, but comes with a performance penalty, so it is best if this is
+    /// enabled during debugging, and disabled otherwise.
 
     void SetEventsOrdered(bool receive_events_in_order) { m_receive_events_in_order = receive_events_in_order; }
 
@@ -9,11 +9,15 @@
 #include <JANA/JException.h>
 #include <JANA/Utils/JTypeInfo.h>
 #include <JANA/JEvent.h>
+#include <JANA/Utils/JSpan.h>
 
+#include <algorithm>
+#include <cassert>
 #include <string>
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 class JFactoryGenerator;
 class JApplication;
@@ -31,7 +35,8 @@ public:
     /// If GetEvent() reaches an error state, it should throw a JException instead.
     enum class ReturnStatus { Success, TryAgain, Finished };
 
-    /// The user is supposed to _throw_ RETURN_STATUS::kNO_MORE_EVENTS or kBUSY from GetEvent()
+    /// The user is supposed to _throw_ RETURN_STATUS::kNO_MORE_EVENTS or kBUSY from GetEvent(), or to return the
+    /// corresponding ReturnStatus from TryGetEvent()
     enum class RETURN_STATUS { kSUCCESS, kNO_MORE_EVENTS, kBUSY, kTRY_AGAIN, kERROR, kUNKNOWN };
 
 
@@ -73,8 +78,75 @@ public:
     /// If an event cannot be emitted, either because the resource is not ready or because we have reached the end of
     /// the event stream, the implementor should throw the corresponding `RETURN_STATUS`. The user should NEVER throw
     /// `RETURN_STATUS SUCCESS` because this will hurt performance. Instead, they should simply return normally.
+    /// Sources which often have nothing to emit, such as those polling a socket, should implement `TryGetEvent`
+    /// instead, since throwing is expensive.
 
-    virtual void GetEvent(std::shared_ptr<JEvent>) = 0;
+    virtual void GetEvent(std::shared_ptr<JEvent>) {
+        throw JException("JEventSource '%s' must implement either GetEvent() or TryGetEvent()", GetType().c_str());
+    }
+
+    /// `TryGetEvent` is the exception-free alternative to `GetEvent`. It fills the event exactly like `GetEvent`
+    /// does, but signals that there is nothing to emit right now by returning `ReturnStatus::TryAgain`, and the end of
+    /// the event stream by returning `ReturnStatus::Finished`, rather than by throwing a `RETURN_STATUS`. Errors
+    /// should still be thrown as JExceptions. The default implementation calls `GetEvent` and translates whatever
+    /// `RETURN_STATUS` it throws, so that sources written against the older interface keep working unchanged.
+
+    virtual ReturnStatus TryGetEvent(std::shared_ptr<JEvent> event) {
+        try {
+            GetEvent(std::move(event));
+            return ReturnStatus::Success;
+        }
+        catch (RETURN_STATUS rs) {
+
+            if (rs == RETURN_STATUS::kNO_MORE_EVENTS) {
+                return ReturnStatus::Finished;
+            }
+            else if (rs == RETURN_STATUS::kTRY_AGAIN || rs == RETURN_STATUS::kBUSY) {
+                return ReturnStatus::TryAgain;
+            }
+            else if (rs == RETURN_STATUS::kERROR || rs == RETURN_STATUS::kUNKNOWN) {
+                throw JException("JEventSource threw RETURN_STATUS::kERROR or kUNKNOWN");
+            }
+            else {
+                return ReturnStatus::Success;
+            }
+        }
+    }
+
+
+    /// `ReaderState` holds whatever a concurrent source needs to read on several threads at once, e.g. its own file
+    /// handle, decompression buffers, or ZMQ socket. See `EnableConcurrentGetEvent()`.
+    struct ReaderState {
+        virtual ~ReaderState() = default;
+    };
+
+    /// `CreateReaderState` is called by concurrent sources whenever more threads than ever before are calling
+    /// `GetEvent` at the same time. Sources which don't need any per-thread state keep the default, which returns
+    /// nullptr, and implement `GetEvent(event)` or `TryGetEvent(event)` as usual.
+    virtual std::unique_ptr<ReaderState> CreateReaderState() { return nullptr; }
+
+    /// `GetEventWithReader` is what concurrent sources which created a `ReaderState` implement instead of
+    /// `TryGetEvent(event)`, and it reports its status the same way. The reader belongs to the calling thread
+    /// until this returns, so it needs no locking.
+    virtual ReturnStatus GetEventWithReader(std::shared_ptr<JEvent> event, ReaderState&) {
+        return TryGetEvent(std::move(event));
+    }
+
+    /// `GetEvents` is the batched alternative to `TryGetEvent`, for sources which decode many events at once, such as
+    /// a file reader which reads whole blocks. JANA hands it all of the events it has room for at once. It fills
+    /// `events[0]`, `events[1]`, ... in order, stops at the first one it cannot fill, and sets `filled_count` to the
+    /// number it filled. It returns `Success` if it filled every event, and otherwise the status `TryGetEvent`
+    /// would have returned for the first one it couldn't fill. The default calls `TryGetEvent` once per event.
+    /// Concurrent sources which use a `ReaderState` are always called once per event instead.
+    virtual ReturnStatus GetEvents(JSpan<const std::shared_ptr<JEvent>> events, size_t& filled_count) {
+        filled_count = 0;
+        for (const auto& event : events) {
+            auto status = TryGetEvent(event);
+            if (status != ReturnStatus::Success) return status;
+            filled_count++;
+        }
+        return ReturnStatus::Success;
+    }
 
 
     /// `FinishEvent` is used to notify the `JEventSource` that an event has been completely processed. This is the final
@@ -100,7 +172,8 @@ public:
     virtual void DoInitialize() {
         try {
             std::call_once(m_init_flag, &JEventSource::Open, this);
-            m_status = SourceStatus::Opened;
+            auto status = SourceStatus::Unopened;
+            m_status.compare_exchange_strong(status, SourceStatus::Opened);  // Another thread may have finished already
         }
         catch (JException& ex) {
             ex.plugin_name = m_plugin_name;
@@ -119,71 +192,29 @@ public:
         }
     }
 
+    /// DoNext() emits the next event, respecting nskip and nevents. Unless the source has enabled concurrent
+    /// GetEvent, only one thread at a time gets in.
     ReturnStatus DoNext(std::shared_ptr<JEvent> event) {
-
-        std::lock_guard<std::mutex> lock(m_mutex); // In general, DoNext must be synchronized.
-        auto first_evt_nr = m_nskip;
-        auto last_evt_nr = m_nevents + m_nskip;
-        try {
-            switch (m_status.load()) {
-
-                case SourceStatus::Unopened: DoInitialize(); // Fall-through to Opened afterwards
-
-                case SourceStatus::Opened:
-
-                    if (m_event_count < first_evt_nr) {
-                        m_event_count += 1;
-                        GetEvent(event);
-                        return ReturnStatus::TryAgain;
-                    }
-                    else if (m_nevents != 0 && (m_event_count == last_evt_nr)) {
-                        m_status = SourceStatus::Finished; // TODO: This isn't threadsafe at the moment
-                        return ReturnStatus::Finished;
-                    }
-                    else {
-                        GetEvent(event);
-                        m_event_count += 1;
-                        return ReturnStatus::Success;
-                    }
-
-                default: //case SourceStatus::Finished:
-                    return ReturnStatus::Finished;
-            }
+        size_t skip_count, emit_count;
+        auto status = DoNext(JSpan<const std::shared_ptr<JEvent>>(&event, 1), skip_count, emit_count);
+        if (status == ReturnStatus::Success && emit_count == 0) {
+            return ReturnStatus::TryAgain;  // The event was skipped
         }
-        catch (RETURN_STATUS rs) {
+        return status;
+    }
 
-            if (rs == RETURN_STATUS::kNO_MORE_EVENTS) {
-                m_status = SourceStatus::Finished; // TODO: This isn't threadsafe at the moment
-                return ReturnStatus::Finished;
-            }
-            else if (rs == RETURN_STATUS::kTRY_AGAIN || rs == RETURN_STATUS::kBUSY) {
-                return ReturnStatus::TryAgain;
-            }
-            else if (rs == RETURN_STATUS::kERROR || rs == RETURN_STATUS::kUNKNOWN) {
-                JException ex ("JEventSource threw RETURN_STATUS::kERROR or kUNKNOWN");
-                ex.plugin_name = m_plugin_name;
-                ex.component_name = GetType();
-                throw ex;
-            }
-            else {
-                return ReturnStatus::Success;
-            }
-        }
-        catch (JException& ex) {
-            ex.plugin_name = m_plugin_name;
-            ex.component_name = GetType();
-            throw ex;
-        }
-        catch (std::runtime_error& e){
-            throw(JException(e.what()));
-        }
-        catch (...) {
-            auto ex = JException("Unknown exception in JEventSource::GetEvent()");
-            ex.nested_exception = std::current_exception();
-            ex.plugin_name = m_plugin_name;
-            ex.component_name = GetType();
-            throw ex;
+    /// This DoNext() has the source fill as many of events as it can in one go, respecting nskip and nevents.
+    /// Afterwards, events[skip_count, skip_count+emit_count) are ready to be emitted. The ones before were filled
+    /// but fall within nskip, and the ones after couldn't be filled. It returns Success if all of them were filled,
+    /// and otherwise why not.
+    ReturnStatus DoNext(JSpan<const std::shared_ptr<JEvent>> events, size_t& skip_count, size_t& emit_count) {
+        skip_count = 0;
+        emit_count = 0;
+        if (m_enable_concurrent_get_event) {
+            return DoNextUnlocked(events, skip_count, emit_count);
         }
+        std::lock_guard<std::mutex> lock(m_mutex); // In general, DoNext must be synchronized.
+        return DoNextUnlocked(events, skip_count, emit_count);
     }
 
     /// Calls the optional-and-discouraged user-provided FinishEvent virtual method, enforcing
@@ -244,6 +275,17 @@ public:
     /// which will hurt performance. Conceptually, FinishEvent isn't great, and so should be avoided when possible.
     void EnableFinishEvent() { m_enable_free_event = true; }
 
+    // Meant to be called by user
+    /// EnableConcurrentGetEvent() is intended to be called by the user in the constructor in order to tell JANA
+    /// that GetEvent may be called from several threads at once, e.g. because each of them reads a different part
+    /// of a random-access file, or has its own socket. JANA then runs this source on as many threads as it likes,
+    /// without the JEventSource mutex. State which each thread needs for itself goes into a ReaderState; everything
+    /// else the user has to synchronize on their own. nskip and nevents are still respected exactly. Events come out
+    /// in whatever order the threads finish them, unless some JEventProcessor asked for them to be ordered.
+    void EnableConcurrentGetEvent() { m_enable_concurrent_get_event = true; }
+
+    bool IsGetEventConcurrent() const { return m_enable_concurrent_get_event; }
+
     // Meant to be called by JANA
     void SetApplication(JApplication* app) { m_application = app; }
 
@@ -258,11 +300,139 @@ public:
 
 
 private:
+    ReturnStatus DoNextUnlocked(JSpan<const std::shared_ptr<JEvent>> events, size_t& skip_count, size_t& emit_count) {
+
+        try {
+            switch (m_status.load()) {
+
+                case SourceStatus::Unopened: DoInitialize(); // Fall-through to Opened afterwards
+
+                case SourceStatus::Opened: {
+
+                    // Claim slots before reading, so that concurrent threads never read more than nskip+nevents
+                    // between them. m_event_count only counts the events which were actually read, so whoever
+                    // finds every slot claimed but not every event read has to come back later instead of finishing.
+                    auto claimed_count = m_claimed_count.load();
+                    decltype(claimed_count) claim_size;
+                    do {
+                        claim_size = events.size();
+                        if (m_nevents != 0) {
+                            auto last_evt_nr = m_nskip + m_nevents;
+                            if (claimed_count >= last_evt_nr) {
+                                if (m_event_count < last_evt_nr) return ReturnStatus::TryAgain;
+                                m_status = SourceStatus::Finished;
+                                return ReturnStatus::Finished;
+                            }
+                            claim_size = std::min<decltype(claim_size)>(claim_size, last_evt_nr - claimed_count);
+                        }
+                    } while (!m_claimed_count.compare_exchange_weak(claimed_count, claimed_count + claim_size));
+
+                    ReturnStatus status;
+                    size_t filled_count = 0;
+                    try {
+                        status = CallGetEvents(JSpan<const std::shared_ptr<JEvent>>(events.data(), claim_size), filled_count);
+                    }
+                    catch (...) {
+                        // Whatever GetEvents() read before throwing has been consumed all the same, and still
+                        // counts towards nskip and nevents
+                        filled_count = std::min<size_t>(filled_count, claim_size);
+                        m_claimed_count -= claim_size - filled_count;
+                        m_event_count += filled_count;
+                        throw;
+                    }
+                    m_claimed_count -= claim_size - filled_count;
+
+                    // Whichever events are among the first nskip to be read get dropped
+                    auto event_count = m_event_count.fetch_add(filled_count);
+                    if (event_count < m_nskip) {
+                        skip_count = std::min<uint64_t>(filled_count, m_nskip - event_count);
+                    }
+                    emit_count = filled_count - skip_count;
+
+                    if (status == ReturnStatus::Success && claim_size < events.size()) {
+                        // We hit nevents partway through
+                        status = (m_event_count == m_nskip + m_nevents) ? ReturnStatus::Finished : ReturnStatus::TryAgain;
+                        if (status == ReturnStatus::Finished) m_status = SourceStatus::Finished;
+                    }
+                    return status;
+                }
+
+                default: //case SourceStatus::Finished:
+                    return ReturnStatus::Finished;
+            }
+        }
+        catch (JException& ex) {
+            ex.plugin_name = m_plugin_name;
+            ex.component_name = GetType();
+            throw ex;
+        }
+        catch (std::runtime_error& e){
+            throw(JException(e.what()));
+        }
+        catch (...) {
+            auto ex = JException("Unknown exception in JEventSource::GetEvent()");
+            ex.nested_exception = std::current_exception();
+            ex.plugin_name = m_plugin_name;
+            ex.component_name = GetType();
+            throw ex;
+        }
+    }
+
+    /// CallGetEvents() runs the user's GetEvents, or GetEventWithReader with a ReaderState of its own if the source has any
+    ReturnStatus CallGetEvents(JSpan<const std::shared_ptr<JEvent>> events, size_t& filled_count) {
+        ReturnStatus status = ReturnStatus::Success;
+        filled_count = 0;
+        if (!m_enable_concurrent_get_event || m_has_no_reader_state) {
+            status = GetEvents(events, filled_count);
+        }
+        else {
+            std::unique_ptr<ReaderState> reader;
+            {
+                std::lock_guard<std::mutex> lock(m_reader_mutex);
+                if (!m_idle_readers.empty()) {
+                    reader = std::move(m_idle_readers.back());
+                    m_idle_readers.pop_back();
+                }
+            }
+            if (reader == nullptr) reader = CreateReaderState();
+            if (reader == nullptr) {
+                m_has_no_reader_state = true;
+                status = GetEvents(events, filled_count);
+            }
+            else {
+                ReaderReturner returner {this, reader};
+                while (filled_count < events.size() &&
+                       (status = GetEventWithReader(events[filled_count], *reader)) == ReturnStatus::Success) {
+                    filled_count++;
+                }
+            }
+        }
+        assert(filled_count <= events.size());
+        if (status == ReturnStatus::Success && filled_count < events.size()) {
+            status = ReturnStatus::TryAgain;  // GetEvents() stopped early without saying why
+        }
+        if (status == ReturnStatus::Finished) {
+            m_status = SourceStatus::Finished;
+        }
+        return status;
+    }
+
+    /// Puts a ReaderState back for the next thread, however GetEventWithReader() returned
+    struct ReaderReturner {
+        JEventSource* source;
+        std::unique_ptr<ReaderState>& reader;
+        ~ReaderReturner() {
+            std::lock_guard<std::mutex> lock(source->m_reader_mutex);
+            source->m_idle_readers.push_back(std::move(reader));
+        }
+    };
+
     std::string m_resource_name;
     JApplication* m_application = nullptr;
     JFactoryGenerator* m_factory_generator = nullptr;
     std::atomic<SourceStatus> m_status;
-    std::atomic_ullong m_event_count {0};
+    std::atomic_ullong m_event_count {0};    // Events read, including the skipped ones
+    std::atomic_ullong m_claimed_count {0};  // Events read, plus those being read right now
     uint64_t m_nskip = 0;
     uint64_t m_nevents = 0;
     std::string m_plugin_name;
@@ -270,6 +440,10 @@ private:
     std::once_flag m_init_flag;
     std::mutex m_mutex;
     bool m_enable_free_event = false;
+    bool m_enable_concurrent_get_event = false;
+    std::atomic_bool m_has_no_reader_state {false};
+    std::mutex m_reader_mutex;
+    std::vector<std::unique_ptr<ReaderState>> m_idle_readers;
 };
 
 #endif // _JEventSource_h_
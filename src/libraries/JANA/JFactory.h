@@ -15,11 +15,14 @@
 #include <atomic>
 #include <vector>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
 #include <unordered_map>
 #include <functional>
 
 
 class JEvent;
+class JEventArena;
 class JObject;
 class JApplication;
 
@@ -133,6 +136,20 @@ public:
     /// acquire parameter values or services from JFactory::Init()
     JApplication* GetApplication() { return mApp; }
 
+    /// Arena of the JEvent which this factory belongs to. Owning factories never delete objects which were
+    /// created in the arena, because the arena destroys them itself once the event gets recycled.
+    /// This is set by the JFactorySet under the hood.
+    void SetArena(JEventArena* arena) { mArena = arena; }
+
+    /// List of the JFactorySet which this factory belongs to, which the factory adds itself to the first time its
+    /// data changes during an event, so that recycling the event only needs to clear the factories which were used.
+    /// This is set by the JFactorySet under the hood.
+    void SetTouchedList(std::atomic<JFactory*>* touched_list) { mTouchedList = touched_list; }
+
+    /// Flag of the JFactorySet which this factory belongs to, telling whether several threads may ask for the
+    /// factory's data at once (see JFactorySet::SetConcurrent). This is set by the JFactorySet under the hood.
+    void SetConcurrentFlag(const bool* is_concurrent) { mIsConcurrent = is_concurrent; }
+
 
     virtual void Set(const std::vector<JObject *> &data) = 0;
     virtual void Insert(JObject *data) = 0;
@@ -146,18 +163,141 @@ protected:
     uint32_t mFlags = 0;
     int32_t mPreviousRunNumber = -1;
     JApplication* mApp = nullptr;
+    JEventArena* mArena = nullptr;
+    std::atomic<JFactory*>* mTouchedList = nullptr;
+    const bool* mIsConcurrent = nullptr;
+    JFactory* mNextTouched = nullptr;
+    bool mIsTouched = false;
     std::unordered_map<std::type_index, std::unique_ptr<JAny>> mUpcastVTable;
 
-    enum class Status {Uninitialized, Unprocessed, Processed, Inserted};
-    mutable Status mStatus = Status::Uninitialized;
+    /// Processing means that some thread is running Process() right now. AwaitedProcessing means the same, except
+    /// that other threads are waiting for it to finish.
+    enum class Status {Uninitialized, Unprocessed, Processing, AwaitedProcessing, Processed, Inserted};
+    mutable std::atomic<Status> mStatus {Status::Uninitialized};
 
     CreationStatus mCreationStatus = CreationStatus::NotCreatedYet;
     mutable std::mutex mMutex;
 
+    // Used by BeginProcessing() and EndProcessing()
+    std::atomic<std::thread::id> mProcessingThread {};
+    std::condition_variable mStatusChanged;
+
+    static bool IsProcessing(Status status) {
+        return status == Status::Processing || status == Status::AwaitedProcessing;
+    }
+
+    bool IsConcurrent() const { return mIsConcurrent != nullptr && *mIsConcurrent; }
+
+    /// BeginProcessing() makes sure that the data for the current event is produced exactly once, even if several
+    /// threads ask for it at the same time. It returns false if the data is already there. Otherwise, the status moves
+    /// from Uninitialized or Unprocessed to Processing by compare-and-swap, so exactly one caller gets true back,
+    /// along with the status it replaced. That caller must produce the data and then call EndProcessing(). Everybody
+    /// else who arrives meanwhile blocks until it is done. Nobody touches the mutex unless somebody has to wait.
+    /// Unless the JFactorySet is concurrent, there is only ever one caller, so plain loads and stores suffice.
+    bool BeginProcessing(Status& previous_status);
+
+    /// EndProcessing() publishes the new status and wakes up whoever is waiting in BeginProcessing()
+    void EndProcessing(Status status);
+
+    // The concurrent halves of BeginProcessing() and EndProcessing(), kept apart so that the rest stays inlinable
+    bool BeginConcurrentProcessing(Status status, Status& previous_status);
+    void EndConcurrentProcessing(Status status);
+    [[noreturn]] void ThrowSelfDependency() const;
+
+    /// MarkTouched() adds this factory to its JFactorySet's list of factories to clear, unless it is on it already.
+    /// Factories only ever get touched by the one thread which produces or inserts their data, but different
+    /// factories may be touched concurrently, so the list is a lock-free stack.
+    void MarkTouched() {
+        if (mIsTouched || mTouchedList == nullptr) return;
+        mIsTouched = true;
+        mNextTouched = mTouchedList->load(std::memory_order_relaxed);
+        while (!mTouchedList->compare_exchange_weak(mNextTouched, this, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    /// MarkInserted() is for data which was inserted rather than produced. When called from inside Process(), it
+    /// leaves the status alone, because other threads must wait until Process() has returned.
+    void MarkInserted() {
+        if (!IsProcessing(mStatus.load(std::memory_order_relaxed))) {
+            mStatus.store(Status::Inserted, std::memory_order_release);
+        }
+        mCreationStatus = CreationStatus::Inserted;
+        MarkTouched();
+    }
+
     // Used to make sure Init is called only once
     std::once_flag mInitFlag;
+
+    friend class JFactorySet;
 };
 
+inline bool JFactory::BeginProcessing(Status& previous_status) {
+    Status status = mStatus.load(std::memory_order_acquire);
+    if (status == Status::Processed || status == Status::Inserted) {
+        return false;
+    }
+    if (IsConcurrent()) {
+        return BeginConcurrentProcessing(status, previous_status);
+    }
+    if (IsProcessing(status)) {
+        ThrowSelfDependency();
+    }
+    previous_status = status;
+    mStatus.store(Status::Processing, std::memory_order_relaxed);
+    return true;
+}
+
+inline void JFactory::EndProcessing(Status status) {
+    if (IsConcurrent()) {
+        EndConcurrentProcessing(status);
+    }
+    else {
+        mStatus.store(status, std::memory_order_release);
+    }
+}
+
+inline void JFactory::ThrowSelfDependency() const {
+    // Previously this recursed until the stack overflowed; now it would wait forever
+    throw JException("Factory '%s' with tag '%s' depends on itself", mObjectName.c_str(), mTag.c_str());
+}
+
+inline bool JFactory::BeginConcurrentProcessing(Status status, Status& previous_status) {
+    while (true) {
+        if (status == Status::Processed || status == Status::Inserted) {
+            return false;
+        }
+        if (!IsProcessing(status)) {
+            if (mStatus.compare_exchange_weak(status, Status::Processing, std::memory_order_acquire)) {
+                mProcessingThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+                previous_status = status;
+                return true;
+            }
+            continue;
+        }
+        if (mProcessingThread.load(std::memory_order_relaxed) == std::this_thread::get_id()) {
+            ThrowSelfDependency();
+        }
+        // Somebody else is producing the data right now. Let them know that they have to wake us up, then wait.
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (status == Status::AwaitedProcessing ||
+            mStatus.compare_exchange_strong(status, Status::AwaitedProcessing, std::memory_order_acquire)) {
+            mStatusChanged.wait(lock, [&]() {
+                status = mStatus.load(std::memory_order_acquire);
+                return !IsProcessing(status);
+            });
+        }
+    }
+}
+
+inline void JFactory::EndConcurrentProcessing(Status status) {
+    mProcessingThread.store(std::thread::id(), std::memory_order_relaxed);
+    if (mStatus.exchange(status, std::memory_order_acq_rel) == Status::AwaitedProcessing) {
+        // Somebody is waiting. They switched the status while holding the mutex, so once we hold it, they are
+        // either asleep or about to see the new status. Either way they can't miss this.
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStatusChanged.notify_all();
+    }
+}
+
 // Because C++ doesn't support templated virtual functions, we implement our own dispatch table, mUpcastVTable.
 // This means that the JFactoryT is forced to manually populate this table by calling JFactoryT<T>::EnableGetAs.
 // We have the option to make the vtable be a static member of JFactoryT<T>, but we have chosen not to because:
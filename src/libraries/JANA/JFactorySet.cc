@@ -2,14 +2,35 @@
 // Copyright 2020, Jefferson Science Associates, LLC.
 // Subject to the terms in the LICENSE file found in the top-level directory.
 
+#include <atomic>
 #include <iterator>
 #include <iostream>
+#include <mutex>
 
 #include "JApplication.h"
 #include "JFactorySet.h"
 #include "JFactory.h"
 #include "JFactoryGenerator.h"
 
+const size_t JFactorySet::NoFactoryId;
+
+namespace {
+
+/// Process-wide registry of dense factory ids. It is only consulted when a factory is added, or when a
+/// typed lookup misses its cached id, so a single mutex is enough.
+struct JFactoryIdRegistry {
+    std::mutex mutex;
+    std::map<std::pair<std::type_index, std::string>, size_t> ids;
+    std::atomic<size_t> id_count {0};   // ids.size(), readable without the lock
+};
+
+JFactoryIdRegistry& GetFactoryIdRegistry() {
+    static JFactoryIdRegistry registry;
+    return registry;
+}
+
+} // namespace
+
 //---------------------------------
 // JFactorySet    (Constructor)
 //---------------------------------
@@ -85,9 +106,56 @@ bool JFactorySet::Add(JFactory* aFactory)
 
     mFactories[typed_key] = aFactory;
     mFactoriesFromString[untyped_key] = aFactory;
+    AddToIndex(aFactory);
+    aFactory->SetArena(mArena);
+    aFactory->SetTouchedList(&mTouchedFactories);
+    aFactory->SetConcurrentFlag(&mIsConcurrent);
     return true;
 }
 
+//---------------------------------
+// AddToIndex
+//---------------------------------
+void JFactorySet::AddToIndex(JFactory* aFactory)
+{
+    size_t id = RegisterFactoryId(aFactory->GetObjectType(), aFactory->GetTag());
+    if (id >= mFactoriesById.size()) {
+        mFactoriesById.resize(id + 1, nullptr);
+    }
+    mFactoriesById[id] = aFactory;
+}
+
+//---------------------------------
+// RegisterFactoryId
+//---------------------------------
+size_t JFactorySet::RegisterFactoryId(std::type_index object_type, const std::string& tag)
+{
+    auto& registry = GetFactoryIdRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto result = registry.ids.emplace(std::make_pair(object_type, tag), registry.ids.size());
+    registry.id_count.store(registry.ids.size(), std::memory_order_release);
+    return result.first->second;
+}
+
+//---------------------------------
+// FindFactoryId
+//---------------------------------
+size_t JFactorySet::FindFactoryId(std::type_index object_type, const std::string& tag)
+{
+    auto& registry = GetFactoryIdRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto it = registry.ids.find(std::make_pair(object_type, tag));
+    return (it != std::end(registry.ids)) ? it->second : NoFactoryId;
+}
+
+//---------------------------------
+// GetFactoryIdCount
+//---------------------------------
+size_t JFactorySet::GetFactoryIdCount()
+{
+    return GetFactoryIdRegistry().id_count.load(std::memory_order_acquire);
+}
+
 //---------------------------------
 // GetFactory
 //---------------------------------
@@ -124,6 +192,9 @@ void JFactorySet::Merge(JFactorySet &aFactorySet)
     /// passed into this method upon return from it can be considered
     /// duplicates. It will be left to the caller to delete those.
 
+    // Factories which already hold data have to be cleared by whichever set ends up owning them
+    auto touched_factories = aFactorySet.TakeTouchedFactories();
+
     JFactorySet tmpSet; // keep track of duplicates to copy back into aFactorySet
     for( auto pair : aFactorySet.mFactories ){
         auto factory = pair.second;
@@ -141,12 +212,28 @@ void JFactorySet::Merge(JFactorySet &aFactorySet)
         else {
             mFactories[typed_key] = factory;
             mFactoriesFromString[untyped_key] = factory;
+            AddToIndex(factory);
+            factory->SetArena(mArena);
+            factory->SetTouchedList(&mTouchedFactories);
+            factory->SetConcurrentFlag(&mIsConcurrent);
         }
     }
+    for (auto factory : touched_factories) {
+        factory->MarkTouched();
+    }
 
     // Copy duplicates back to aFactorySet
     aFactorySet.mFactories.swap( tmpSet.mFactories );
     tmpSet.mFactories.clear(); // prevent ~JFactorySet from deleting any factories
+
+    // aFactorySet's other lookups must not keep pointing at the factories we took over
+    aFactorySet.mFactoriesFromString.clear();
+    aFactorySet.mFactoriesById.clear();
+    for (auto& pair : aFactorySet.mFactories) {
+        auto factory = pair.second;
+        aFactorySet.mFactoriesFromString[std::make_pair(factory->GetObjectName(), factory->GetTag())] = factory;
+        aFactorySet.AddToIndex(factory);
+    }
 }
 
 //---------------------------------
@@ -171,12 +258,38 @@ void JFactorySet::Print() const
     }
 }
 
-/// Release() loops over all contained factories, clearing their data
+/// Release() clears the data of every factory which was used since the last Release(). Factories which
+/// weren't touched have nothing to clear, so with hundreds of factories and a few dozen used per event,
+/// this is much cheaper than visiting all of them.
 void JFactorySet::Release() {
 
-    for (const auto& sFactoryPair : mFactories) {
-        auto sFactory = sFactoryPair.second;
-        sFactory->ClearData();
+    auto factory = mTouchedFactories.exchange(nullptr, std::memory_order_acquire);
+    while (factory != nullptr) {
+        auto next = factory->mNextTouched;
+        factory->mIsTouched = false;
+        factory->ClearData();
+        factory = next;
+    }
+}
+
+/// TakeTouchedFactories() empties the list of touched factories, and returns what was on it
+std::vector<JFactory*> JFactorySet::TakeTouchedFactories() {
+
+    std::vector<JFactory*> factories;
+    auto factory = mTouchedFactories.exchange(nullptr, std::memory_order_acquire);
+    while (factory != nullptr) {
+        factories.push_back(factory);
+        factory->mIsTouched = false;
+        factory = factory->mNextTouched;
+    }
+    return factories;
+}
+
+/// SetArena() hands the arena of the JEvent which owns this JFactorySet to all factories, present and future
+void JFactorySet::SetArena(JEventArena* arena) {
+    mArena = arena;
+    for (auto& pair : mFactories) {
+        pair.second->SetArena(arena);
     }
 }
 
@@ -8,6 +8,7 @@
 #include <string>
 #include <typeindex>
 #include <map>
+#include <vector>
 
 #include <JANA/JFactoryT.h>
 #include <JANA/Utils/JResettable.h>
@@ -20,6 +21,8 @@ class JFactory;
 class JFactorySet : public JResettable
 {
     public:
+        using FactoryMap = std::map<std::pair<std::type_index, std::string>, JFactory*>;  // {(typeid, tag) : factory}
+
         JFactorySet(void);
         JFactorySet(const std::vector<JFactoryGenerator*>& aFactoryGenerators);
         JFactorySet(JFactoryGenerator* source_gen, const std::vector<JFactoryGenerator*>& default_gens);
@@ -29,30 +32,91 @@ class JFactorySet : public JResettable
         void Merge(JFactorySet &aFactorySet);
         void Print(void) const;
         void Release(void);
+        void SetArena(JEventArena* arena);
+
+        /// SetConcurrent(true) lets several threads ask for the same factory's data at once, e.g. to evaluate
+        /// independent factories of one event in parallel. Otherwise, factories skip the atomic read-modify-writes
+        /// which make that safe. SetConcurrent() must only be called while no other thread is using the factory set.
+        void SetConcurrent(bool is_concurrent) { mIsConcurrent = is_concurrent; }
+        bool IsConcurrent() const { return mIsConcurrent; }
 
         JFactory* GetFactory(const std::string& object_name, const std::string& tag="") const;
         template<typename T> JFactoryT<T>* GetFactory(const std::string& tag = "") const;
         std::vector<JFactory*> GetAllFactories() const;
         template<typename T> std::vector<JFactoryT<T>*> GetAllFactories() const;
+        template<typename T> std::pair<FactoryMap::const_iterator, FactoryMap::const_iterator> GetFactoryRange() const;
 
         std::vector<JFactorySummary> Summarize() const;
 
+        /// Every (object type, tag) which is registered with any JFactorySet is assigned a dense integer id,
+        /// which is the same across all JFactorySets in the process. Typed lookups use it to index
+        /// mFactoriesById directly instead of searching mFactories.
+        static size_t RegisterFactoryId(std::type_index object_type, const std::string& tag);
+        static size_t FindFactoryId(std::type_index object_type, const std::string& tag);
+        static size_t GetFactoryIdCount();
+        template<typename T> static size_t GetFactoryId(const std::string& tag = "");
+        static const size_t NoFactoryId = static_cast<size_t>(-1);
+
     protected:
-        std::map<std::pair<std::type_index, std::string>, JFactory*> mFactories;        // {(typeid, tag) : factory}
+        void AddToIndex(JFactory* aFactory);
+
+        FactoryMap mFactories;
         std::map<std::pair<std::string, std::string>, JFactory*> mFactoriesFromString;  // {(objname, tag) : factory}
+        std::vector<JFactory*> mFactoriesById;                                          // {factory id : factory}
+        JEventArena* mArena = nullptr;                                                  // Handed to every factory we own
+        bool mIsConcurrent = false;                                                     // Every factory we own points here
+        std::atomic<JFactory*> mTouchedFactories {nullptr};                             // Factories to clear on Release()
+
+        std::vector<JFactory*> TakeTouchedFactories();
 };
 
 
+/// GetFactoryId() resolves (T, tag) to its dense id without touching the process-wide registry on the
+/// hot path: the id for the default tag lives in a static slot per T, and the ids for other tags are
+/// cached per thread and per T. Returns NoFactoryId if no factory for (T, tag) was ever registered.
+/// Misses are cached too, along with how many ids had been registered at the time, because a factory
+/// for (T, tag) might still be registered later. Such a miss stays valid until the next registration.
+template<typename T>
+size_t JFactorySet::GetFactoryId(const std::string& tag) {
+
+    if (tag.empty()) {
+        static const size_t default_tag_id = RegisterFactoryId(std::type_index(typeid(T)), "");
+        return default_tag_id;
+    }
+
+    struct TaggedId {
+        std::string tag;
+        size_t id;
+        size_t registered_count;    // Only meaningful if id is NoFactoryId
+    };
+
+    // A type rarely has more than a handful of tags, so a linear scan beats any map here
+    static thread_local std::vector<TaggedId> tagged_ids;
+    for (auto& tagged_id : tagged_ids) {
+        if (tagged_id.tag != tag) continue;
+        if (tagged_id.id != NoFactoryId) return tagged_id.id;
+        size_t registered_count = GetFactoryIdCount();
+        if (tagged_id.registered_count == registered_count) return NoFactoryId;
+        tagged_id.id = FindFactoryId(std::type_index(typeid(T)), tag);
+        tagged_id.registered_count = registered_count;
+        return tagged_id.id;
+    }
+    size_t registered_count = GetFactoryIdCount();  // Before the lookup, so that we never miss a registration
+    size_t id = FindFactoryId(std::type_index(typeid(T)), tag);
+    tagged_ids.push_back({tag, id, registered_count});
+    return id;
+}
+
+
 template<typename T>
 JFactoryT<T>* JFactorySet::GetFactory(const std::string& tag) const {
 
-    auto typed_key = std::make_pair(std::type_index(typeid(T)), tag);
-    auto typed_iter = mFactories.find(typed_key);
-    if (typed_iter != std::end(mFactories)) {
-        return static_cast<JFactoryT<T>*>(typed_iter->second);
+    size_t id = GetFactoryId<T>(tag);
+    if (id < mFactoriesById.size() && mFactoriesById[id] != nullptr) {
+        return static_cast<JFactoryT<T>*>(mFactoriesById[id]);
     }
 
-    auto untyped_key = std::make_pair(JTypeInfo::demangle<T>(), tag);
+    auto untyped_key = std::make_pair(JTypeInfo::demangle_cached<T>(), tag);
     auto untyped_iter = mFactoriesFromString.find(untyped_key);
     if (untyped_iter != std::end(mFactoriesFromString)) {
         return static_cast<JFactoryT<T>*>(untyped_iter->second);
@@ -62,16 +126,27 @@ JFactoryT<T>* JFactorySet::GetFactory(const std::string& tag) const {
 
 template<typename T>
 std::vector<JFactoryT<T>*> JFactorySet::GetAllFactories() const {
-    auto sKey = std::type_index(typeid(T));
     std::vector<JFactoryT<T>*> data;
-    for (auto it=std::begin(mFactories);it!=std::end(mFactories);it++){
-        if (it->first.first==sKey){
-            data.push_back(static_cast<JFactoryT<T>*>(it->second));
-        }
+    auto range = GetFactoryRange<T>();
+    for (auto it=range.first; it!=range.second; it++){
+        data.push_back(static_cast<JFactoryT<T>*>(it->second));
     }
     return data;
 }
 
+/// GetFactoryRange() returns the factories for T, regardless of tag. They sit next to each other in mFactories,
+/// because its keys are ordered by type first, and the empty tag comes before any other.
+template<typename T>
+std::pair<JFactorySet::FactoryMap::const_iterator, JFactorySet::FactoryMap::const_iterator> JFactorySet::GetFactoryRange() const {
+    auto type = std::type_index(typeid(T));
+    auto begin = mFactories.lower_bound(std::make_pair(type, std::string()));
+    auto end = begin;
+    while (end != mFactories.end() && end->first.first == type) {
+        ++end;
+    }
+    return std::make_pair(begin, end);
+}
+
 
 #endif // _JFactorySet_h_
 
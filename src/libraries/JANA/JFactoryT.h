@@ -8,6 +8,8 @@
 #include <JANA/JApplication.h>
 #include <JANA/JFactory.h>
 #include <JANA/JObject.h>
+#include <JANA/Utils/JEventArena.h>
+#include <JANA/Utils/JSpan.h>
 #include <JANA/Utils/JTypeInfo.h>
 
 #ifdef HAVE_ROOT
@@ -76,15 +78,24 @@ public:
     /// GetOrCreate handles all the preconditions and postconditions involved in calling the user-defined Open(),
     /// ChangeRun(), and Process() methods. These include making sure the JFactory JApplication is set, Init() is called
     /// exactly once, exceptions are tagged with the originating plugin and eventsource, ChangeRun() is
-    /// called if and only if the run number changes, etc.
+    /// called if and only if the run number changes, etc. Several threads may call this on the same event at once:
+    /// exactly one of them runs Process() and the others wait for it (see JFactory::BeginProcessing).
     PairType GetOrCreate(const std::shared_ptr<const JEvent>& event, JApplication* app, int32_t run_number) {
 
-        //std::lock_guard<std::mutex> lock(mMutex);
+        auto status = mStatus.load(std::memory_order_acquire);
+        if (status == Status::Processed || status == Status::Inserted) {
+            return std::make_pair(mData.cbegin(), mData.cend());
+        }
+        Status previous_status;
+        if (!BeginProcessing(previous_status)) {
+            return std::make_pair(mData.cbegin(), mData.cend());
+        }
+        MarkTouched();
         if (mApp == nullptr) {
             mApp = app;
         }
-        switch (mStatus) {
-            case Status::Uninitialized:
+        try {
+            if (previous_status == Status::Uninitialized) {
                 try {
                     std::call_once(mInitFlag, &JFactory::Init, this);
                 }
@@ -100,29 +111,37 @@ public:
                     ex.component_name = mFactoryName;
                     throw ex;
                 }
-            case Status::Unprocessed:
-                if (mPreviousRunNumber == -1) {
-                    // This is the very first run
-                    ChangeRun(event);
-                    BeginRun(event);
-                    mPreviousRunNumber = run_number;
-                }
-                else if (mPreviousRunNumber != run_number) {
-                    // This is a later run, and it has changed
-                    EndRun();
-                    ChangeRun(event);
-                    BeginRun(event);
-                    mPreviousRunNumber = run_number;
-                }
-                Process(event);
-                mStatus = Status::Processed;
-                mCreationStatus = CreationStatus::Created;
-            case Status::Processed:
-            case Status::Inserted:
-                return std::make_pair(mData.cbegin(), mData.cend());
-            default:
-                throw JException("Enum is set to a garbage value somehow");
+                previous_status = Status::Unprocessed;
+            }
+            if (mPreviousRunNumber == -1) {
+                // This is the very first run
+                ChangeRun(event);
+                BeginRun(event);
+                mPreviousRunNumber = run_number;
+            }
+            else if (mPreviousRunNumber != run_number) {
+                // This is a later run, and it has changed
+                EndRun();
+                ChangeRun(event);
+                BeginRun(event);
+                mPreviousRunNumber = run_number;
+            }
+            Process(event);
+        }
+        catch (...) {
+            // Let the next caller try again, like before
+            EndProcessing(previous_status);
+            throw;
         }
+        mCreationStatus = CreationStatus::Created;
+        EndProcessing(Status::Processed);
+        return std::make_pair(mData.cbegin(), mData.cend());
+    }
+
+    /// GetSpan() views whatever the factory currently holds, without copying. Unlike GetOrCreate(), it never
+    /// calls Process().
+    JSpan<const T* const> GetSpan() const {
+        return {mData.data(), mData.size()};
     }
 
     size_t Create(const std::shared_ptr<const JEvent>& event, JApplication* app, uint64_t run_number) final {
@@ -139,6 +158,7 @@ public:
             assert(casted != nullptr);
             mData.push_back(casted);
         }
+        MarkTouched();
     }
 
     /// Please use the typed setters instead whenever possible
@@ -146,29 +166,25 @@ public:
         T* casted = dynamic_cast<T*>(aDatum);
         assert(casted != nullptr);
         mData.push_back(casted);
-        mStatus = Status::Inserted;
-        mCreationStatus = CreationStatus::Inserted;
+        MarkInserted();
         // TODO: assert correct mStatus precondition
     }
 
     void Set(const std::vector<T*>& aData) {
         ClearData();
         mData = aData;
-        mStatus = Status::Inserted;
-        mCreationStatus = CreationStatus::Inserted;
+        MarkInserted();
     }
 
     void Set(std::vector<T*>&& aData) {
         ClearData();
         mData = std::move(aData);
-        mStatus = Status::Inserted;
-        mCreationStatus = CreationStatus::Inserted;
+        MarkInserted();
     }
 
     void Insert(T* aDatum) {
         mData.push_back(aDatum);
-        mStatus = Status::Inserted;
-        mCreationStatus = CreationStatus::Inserted;
+        MarkInserted();
     }
 
 
@@ -195,12 +211,23 @@ public:
             return;
         }
 
-        // Assuming we _are_ the object owner, delete the underlying jobjects
+        // Assuming we _are_ the object owner, delete the underlying jobjects,
+        // except for those living in the event's arena, which the arena destroys by itself
         if (!TestFactoryFlag(JFactory_Flags_t::NOT_OBJECT_OWNER)) {
-            for (auto p : mData) delete p;
+            if (mArena == nullptr) {
+                for (auto p : mData) delete p;
+            }
+            else {
+                for (auto p : mData) {
+                    if (!mArena->Owns(p)) delete p;
+                }
+            }
         }
         mData.clear();
-        mStatus = Status::Unprocessed;
+        if (!IsProcessing(mStatus.load(std::memory_order_relaxed))) {
+            // Process() may call Set(), which clears the data, but other threads must keep waiting until it returns
+            mStatus.store(Status::Unprocessed, std::memory_order_release);
+        }
         mCreationStatus = CreationStatus::NotCreatedYet;
     }
 
@@ -5,6 +5,7 @@
 #ifndef _JObject_h_
 #define _JObject_h_
 
+#include <algorithm>
 #include <string>
 #include <sstream>
 #include <set>
@@ -12,6 +13,7 @@
 #include <cassert>
 #include <typeinfo>
 
+#include <JANA/Utils/JSmallVector.h>
 #include <JANA/Utils/JTypeInfo.h>
 #include <JANA/JLogger.h>
 #include <JANA/JException.h>
@@ -76,10 +78,11 @@ class JObject{
 
         // Associated objects
         inline void AddAssociatedObject(const JObject *obj);
+        template<typename Range> void AddAssociatedObjects(const Range& objs);
         inline void AddAssociatedObjectAutoDelete(JObject *obj, bool auto_delete=true);
         inline void RemoveAssociatedObject(const JObject *obj);
         inline void ClearAssociatedObjects(void);
-        inline bool IsAssociated(const JObject* locObject) const {return (associated.find(locObject) != associated.end());}
+        inline bool IsAssociated(const JObject* locObject) const {return std::binary_search(associated.begin(), associated.end(), locObject);}
 
         template<class T> const T* GetSingle() const;
         template<class T> std::vector<const T*> Get() const;
@@ -106,8 +109,13 @@ class JObject{
         virtual void Summarize(JObjectSummary& summary) const;
 
     protected:
-        std::set<const JObject*> associated;
-        std::set<JObject*> auto_delete;
+        // Both are kept sorted and free of duplicates, like the std::sets they replace, but they don't allocate
+        // anything for the first few entries. Most objects have no more than a couple of associations.
+        JSmallVector<const JObject*, 2> associated;
+        JSmallVector<JObject*, 1> auto_delete;
+
+    private:
+        template<typename T, size_t N> static void InsertSorted(JSmallVector<T, N>& items, T item);
 };
 
 
@@ -118,7 +126,30 @@ void JObject::AddAssociatedObject(const JObject *obj)
 {
     /// Add a JObject to the list of associated objects
     assert(obj!=NULL);
-    associated.insert(obj);
+    InsertSorted(associated, obj);
+}
+
+//--------------------------
+// AddAssociatedObjects
+//--------------------------
+template<typename Range>
+void JObject::AddAssociatedObjects(const Range& objs)
+{
+    /// Add every JObject in objs (e.g. a std::vector<const T*> or a JSpan) to the list of associated
+    /// objects in one go. This is much cheaper than calling AddAssociatedObject() once per object
+    /// when linking many objects at once, e.g. all of a cluster's hits to the cluster.
+
+    auto old_size = associated.size();
+    associated.insert(associated.end(), objs.begin(), objs.end());
+    auto middle = associated.begin() + old_size;
+    assert(std::find(middle, associated.end(), nullptr) == associated.end());
+    if (!std::is_sorted(middle, associated.end())) {
+        std::sort(middle, associated.end());
+    }
+    if (middle != associated.begin() && middle != associated.end() && *middle < *(middle-1)) {
+        std::inplace_merge(associated.begin(), middle, associated.end());
+    }
+    associated.erase(std::unique(associated.begin(), associated.end()), associated.end());
 }
 
 //--------------------------
@@ -137,7 +168,7 @@ void JObject::AddAssociatedObjectAutoDelete(JObject *obj, bool auto_delete)
     /// be deleted.
 
     AddAssociatedObject(obj);
-    if(auto_delete) this->auto_delete.insert(obj);
+    if(auto_delete) InsertSorted(this->auto_delete, obj);
 }
 
 //--------------------------
@@ -150,9 +181,9 @@ void JObject::RemoveAssociatedObject(const JObject *obj)
     /// object was added with the AddAssociatedObjectAutoDelete(...)
     /// method with the auto_delete flag set.
 
-    auto iter = associated.find(obj);
+    auto iter = std::lower_bound(associated.begin(), associated.end(), obj);
 
-    if(iter!=associated.end()){
+    if(iter!=associated.end() && *iter==obj){
         associated.erase(iter);
     }
 }
@@ -175,6 +206,25 @@ void JObject::ClearAssociatedObjects(void)
     auto_delete.clear();
 }
 
+//--------------------------
+// InsertSorted
+//--------------------------
+template<typename T, size_t N>
+void JObject::InsertSorted(JSmallVector<T, N>& items, T item)
+{
+    /// Insert item unless it is already there, keeping items in order. Objects tend to be
+    /// allocated, and therefore associated, in increasing address order, so check the back first.
+
+    if (items.empty() || items[items.size()-1] < item) {
+        items.push_back(item);
+        return;
+    }
+    auto iter = std::lower_bound(items.begin(), items.end(), item);
+    if (*iter != item) {
+        items.insert(iter, item);
+    }
+}
+
 
 template<class T>
 const T* JObject::GetSingle() const {
@@ -198,7 +248,7 @@ const T* JObject::GetSingle() const {
         // If nothing found, attempt matching by strings.
         // Why? Because dl and RTTI aren't playing nicely together;
         // each plugin might assign a different typeid to the same class.
-        std::string classname = JTypeInfo::demangle<T>();
+        const std::string& classname = JTypeInfo::demangle_cached<T>();
         for (auto obj : associated) {
             if (obj->className() == classname) {
                 if (last_found == nullptr) {
@@ -229,7 +279,7 @@ std::vector<const T*> JObject::Get() const {
         // Why? Because dl and RTTI aren't playing nicely together;
         // each plugin might assign a different typeid to the same class.
 
-        std::string classname = JTypeInfo::demangle<T>();
+        const std::string& classname = JTypeInfo::demangle_cached<T>();
         for (auto obj : associated) {
             if (obj->className() == classname) {
                 results.push_back(reinterpret_cast<const T*>(obj));
@@ -37,26 +37,52 @@ public:
         m_transport->initialize();
     }
 
-    void GetEvent(std::shared_ptr<JEvent> event) override {
+    ~JDiscreteJoin() override {
+        delete m_next_item;
+    }
+
+    ReturnStatus TryGetEvent(std::shared_ptr<JEvent> event) override {
+
+        auto status = Prefetch();
+        if (status != ReturnStatus::Success) return status;
+
+        event->SetEventNumber(m_next_id);
+        m_next_id += 1;
+        InsertPrefetched(*event);
+        return ReturnStatus::Success;
+    }
+
+    /// Prefetch() receives the next message ahead of time, unless it already has. This lets JEventBuilder make sure
+    /// that every join has something for the next event before it builds it, instead of having to wait or give up
+    /// on an event it already started.
+    ReturnStatus Prefetch() {
+
+        if (m_next_item != nullptr) return ReturnStatus::Success;
 
         auto item = new T();  // This is why T requires a zero-arg ctor
         auto result = m_transport->receive(*item);
         switch (result) {
             case JTransport::Result::FINISHED:
-                throw JEventSource::RETURN_STATUS::kNO_MORE_EVENTS;
+                delete item;
+                return ReturnStatus::Finished;
             case JTransport::Result::TRY_AGAIN:
-                throw JEventSource::RETURN_STATUS::kTRY_AGAIN;
+                delete item;
+                return ReturnStatus::TryAgain;
             case JTransport::Result::FAILURE:
-                throw JEventSource::RETURN_STATUS::kERROR;
+                delete item;
+                throw JException("%s: Transport failed to receive", "JDiscreteJoin");
             default:
                 break;
         }
         // At this point, we know that item contains a valid Sample<T>
+        m_next_item = item;
+        return ReturnStatus::Success;
+    }
 
-        event->SetEventNumber(m_next_id);
-        m_next_id += 1;
-        event->Insert<T>(item);
-        std::cout << "Emit: " << *item << std::endl;
+    /// InsertPrefetched() hands the message that Prefetch() received over to event
+    void InsertPrefetched(JEvent& event) {
+        event.Insert<T>(m_next_item);
+        m_next_item = nullptr;
     }
 
     static std::string GetDescription() {
@@ -68,7 +94,7 @@ private:
 
     std::unique_ptr<JTransport> m_transport;
     std::unique_ptr<JTrigger> m_trigger;
-    uint64_t m_delay_ms;
+    T* m_next_item = nullptr;
     uint64_t m_next_id = 0;
 };
 
@@ -11,7 +11,7 @@
 #include <JANA/Streaming/JTransport.h>
 #include <JANA/Streaming/JTrigger.h>
 #include <JANA/Streaming/JDiscreteJoin.h>
-#include <JANA/Streaming/JWindow.h>
+#include <JANA/Streaming/JTrivialWindow.h>
 
 #include <cstdint>
 #include <cstddef>
@@ -22,7 +22,9 @@
 
 /// JEventBuilder pulls JMessages off of a user-specified JTransport, aggregates them into
 /// JEvents using the JWindow of their choice, and decides which to keep via a user-specified
-/// JTrigger.
+/// JTrigger. For triggerless streaming readout, T is a JHitMessage and the window is a JFixedWindow or
+/// JSessionWindow, which merge the detectors' hits by timestamp. The default JTrivialWindow emits one event per message.
+/// Events rejected by the trigger are recycled right away. Each event gets one message from every join.
 
 template <typename T>
 class JEventBuilder : public JEventSource {
@@ -30,12 +32,12 @@ public:
 
     JEventBuilder(std::unique_ptr<JTransport>&& transport,
                   std::unique_ptr<JTrigger>&& trigger = std::unique_ptr<JTrigger>(new JTrigger()),
-                  std::unique_ptr<JWindow<T>>&& window = std::unique_ptr<JSessionWindow<T>>(new JSessionWindow<T>()))
+                  std::unique_ptr<JWindow<T>>&& window = std::unique_ptr<JWindow<T>>(new JTrivialWindow<T>()))
 
         : JEventSource("JEventBuilder")
         , m_transport(std::move(transport))
-        , m_trigger(std::move(trigger))
-        , m_window(std::move(window)) {
+        , m_window(std::move(window))
+        , m_trigger(std::move(trigger)) {
     }
 
     void addJoin(std::unique_ptr<JDiscreteJoin<T>>&& join) {
@@ -43,7 +45,8 @@ public:
     }
 
     void Open() override {
-        for (auto join : m_joins) {
+        m_transport->initialize();
+        for (auto& join : m_joins) {
             join->Open();
         }
     }
@@ -52,32 +55,50 @@ public:
         return "JEventBuilder";
     }
 
-    void GetEvent(std::shared_ptr<JEvent> event) override {
-
-        auto item = new T();  // This is why T requires a zero-arg ctor
-        auto result = m_transport->receive(*item);
-        switch (result) {
-            case JTransport::Result::FINISHED:
-                throw JEventSource::RETURN_STATUS::kNO_MORE_EVENTS;
-            case JTransport::Result::TRY_AGAIN:
-                throw JEventSource::RETURN_STATUS::kTRY_AGAIN;
-            case JTransport::Result::FAILURE:
-                throw JEventSource::RETURN_STATUS::kERROR;
-            default:
-                break;
-        }
-        // At this point, we know that item contains a valid Sample<T>
+    ReturnStatus TryGetEvent(std::shared_ptr<JEvent> event) override {
 
-        event->SetEventNumber(m_next_id);
-        m_next_id += 1;
-        event->Insert<T>(item);
+        // Only start on an event once every join has something for it, so that we never have to wait halfway through
+        for (auto& join : m_joins) {
+            auto status = join->Prefetch();
+            if (status != ReturnStatus::Success) return status;
+        }
 
-        /// This is really bad because we have to worry about downstream HitSource returning TryAgainLater
-        /// and we really don't want to block here
-        for (auto join : m_joins) {
-            join->GetEvent(event);
+        while (true) {
+            if (m_window->pullEvent(*event)) {
+                event->SetEventNumber(m_next_id);
+                m_next_id += 1;
+                if (!m_trigger->accept(*event)) {
+                    event->GetFactorySet()->Release();
+                    continue;
+                }
+                for (auto& join : m_joins) {
+                    join->InsertPrefetched(*event);
+                }
+                return ReturnStatus::Success;
+            }
+            if (m_window->isFinished()) {
+                return ReturnStatus::Finished;
+            }
+
+            // The window needs more messages before it can emit another event
+            auto item = new T();  // This is why T requires a zero-arg ctor
+            auto result = m_transport->receive(*item);
+            switch (result) {
+                case JTransport::Result::FINISHED:
+                    delete item;
+                    m_window->finish();
+                    break;
+                case JTransport::Result::TRY_AGAIN:
+                    delete item;
+                    return ReturnStatus::TryAgain;
+                case JTransport::Result::FAILURE:
+                    delete item;
+                    throw JException("%s: Transport failed to receive", "JEventBuilder");
+                default:
+                    m_window->pushMessage(item);
+                    break;
+            }
         }
-        std::cout << "Emit: " << *item << std::endl;
     }
 
 
@@ -90,7 +111,6 @@ private:
     // since we will want these with regular EventSources as well
     std::vector<std::unique_ptr<JDiscreteJoin<T>>> m_joins;
 
-    uint64_t m_delay_ms;
     uint64_t m_next_id = 0;
 
 };
@@ -0,0 +1,69 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef JANA2_JFIXEDWINDOW_H
+#define JANA2_JFIXEDWINDOW_H
+
+#include <JANA/Streaming/JWindow.h>
+#include <JANA/Streaming/JHitMerger.h>
+
+#include <vector>
+
+/// JFixedWindow partitions time into fixed, contiguous buckets [n*width, (n+1)*width), and emits a JEvent containing
+/// all JMessages for all sources which fall into that bucket, in timestamp order. Buckets without any messages
+/// don't become events. A bucket is emitted once every detector has moved past its end (see JHitMerger), or once
+/// more than max_pending messages are waiting, in which case stragglers' messages for it get dropped as late.
+template <typename T>
+class JFixedWindow : public JWindow<T> {
+public:
+    JFixedWindow(Timestamp width, const std::vector<DetectorId>& detectors, size_t max_pending = 1000000)
+        : m_merger(detectors, max_pending)
+        , m_width(width) {
+
+        if (width == 0) throw JException("JFixedWindow: Width must be positive");
+    }
+
+    ~JFixedWindow() override {
+        for (auto message : m_outbox) delete message;
+    }
+
+    void pushMessage(T* message) final { m_merger.push(message); }
+
+    void pushWatermark(DetectorId detector, Timestamp timestamp) final { m_merger.push_watermark(detector, timestamp); }
+
+    void finish() final { m_merger.finish_all(); }
+
+    bool isFinished() const final { return m_outbox.empty() && m_merger.is_finished(); }
+
+    bool pullEvent(JEvent& event) final {
+
+        bool complete = false;
+        Timestamp timestamp;
+        while (m_merger.peek(timestamp)) {
+            Timestamp bucket_start = timestamp - timestamp % m_width;
+            if (!m_outbox.empty() && bucket_start != m_bucket_start) {
+                complete = true;  // The next message starts a later bucket
+                break;
+            }
+            m_bucket_start = bucket_start;
+            m_outbox.push_back(m_merger.pop());
+        }
+        if (m_outbox.empty()) return false;
+        if (!complete && m_merger.get_watermark() - m_bucket_start < m_width) return false;
+
+        event.Insert<T>(m_outbox);
+        m_outbox.clear();
+        return true;
+    }
+
+    const JHitMerger<T>& getMerger() const { return m_merger; }
+
+private:
+    JHitMerger<T> m_merger;
+    Timestamp m_width;
+    Timestamp m_bucket_start = 0;
+    std::vector<T*> m_outbox;  // The bucket being filled
+};
+
+#endif //JANA2_JFIXEDWINDOW_H
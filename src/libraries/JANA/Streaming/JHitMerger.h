@@ -0,0 +1,185 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef JANA2_JHITMERGER_H
+#define JANA2_JHITMERGER_H
+
+#include <JANA/JException.h>
+#include <JANA/Streaming/JMessage.h>
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
+
+/// JHitMerger merges the hit streams of several detectors into one stream ordered by Timestamp. It is what the
+/// time-based JWindows are built on. Each detector's hits are assumed to arrive in order, and are queued per detector.
+/// A k-way merge over the queues then hands them out in timestamp order, in O(log k) per hit.
+///
+/// A hit is only handed out once it is complete, i.e. once no detector can still send anything earlier. Each detector
+/// has a watermark, which is the timestamp of its latest hit, or whatever it promised via push_watermark() (e.g. on
+/// a heartbeat) if that is later. Every hit below the smallest watermark is complete. A hit which shows up below its
+/// detector's watermark is late: it is deleted and counted, because the JWindow may already have emitted its event.
+///
+/// Memory is bounded by max_pending. Whenever more hits than that are queued, e.g. because a detector has gone quiet
+/// and holds everybody up, the merger stops waiting and hands out the earliest hit anyway. Anything the stragglers
+/// send from before that point is late.
+///
+/// JHitMerger owns the hits in its queues. T is expected to be a JHitMessage. Timestamp max is reserved.
+
+template <typename T>
+class JHitMerger {
+
+    static constexpr Timestamp NONE = std::numeric_limits<Timestamp>::max();
+
+    /// MinTree is a tournament tree over one key per detector: every node holds the smaller of its children, so the
+    /// root holds the overall minimum, and changing a key costs O(log k). Ties go to the smaller detector index.
+    class MinTree {
+        size_t m_leaf_count;
+        std::vector<std::pair<Timestamp, size_t>> m_nodes;  // Leaves live at [leaf_count, 2*leaf_count)
+    public:
+        MinTree(size_t leaf_count, Timestamp key) : m_leaf_count(leaf_count), m_nodes(2 * leaf_count) {
+            for (size_t i=0; i<leaf_count; ++i) m_nodes[leaf_count + i] = {key, i};
+            for (size_t i=leaf_count-1; i>0; --i) m_nodes[i] = std::min(m_nodes[2*i], m_nodes[2*i+1]);
+        }
+        void update(size_t index, Timestamp key) {
+            size_t node = m_leaf_count + index;
+            m_nodes[node].first = key;
+            for (node /= 2; node > 0; node /= 2) {
+                m_nodes[node] = std::min(m_nodes[2*node], m_nodes[2*node+1]);
+            }
+        }
+        const std::pair<Timestamp, size_t>& min() const { return m_nodes[1]; }
+    };
+
+    struct Inbox {
+        DetectorId detector;
+        std::deque<T*> hits;
+        Timestamp watermark = 0;
+    };
+
+    std::map<DetectorId, size_t> m_indices;
+    std::vector<Inbox> m_inboxes;
+    MinTree m_heads;                    // Timestamp of each detector's earliest queued hit, or NONE
+    MinTree m_watermarks;               // Each detector's watermark
+    Timestamp m_forced_watermark = 0;   // How far we went without waiting for stragglers
+    size_t m_max_pending;
+    size_t m_pending_count = 0;
+    size_t m_late_count = 0;
+    size_t m_forced_count = 0;
+
+    Inbox& find(DetectorId detector, size_t& index) {
+        auto it = m_indices.find(detector);
+        if (it == m_indices.end()) {
+            throw JException("JHitMerger: Unexpected detector %llu", static_cast<unsigned long long>(detector));
+        }
+        index = it->second;
+        return m_inboxes[index];
+    }
+
+    void raise_watermark(Inbox& inbox, size_t index, Timestamp watermark) {
+        if (watermark > inbox.watermark) {
+            inbox.watermark = watermark;
+            m_watermarks.update(index, watermark);
+        }
+    }
+
+public:
+    /// \param detectors   Every detector whose hits are to be merged. The merger waits for all of them.
+    /// \param max_pending How many hits may be queued before the merger stops waiting for the slowest detector
+    JHitMerger(const std::vector<DetectorId>& detectors, size_t max_pending)
+        : m_heads(std::max<size_t>(1, detectors.size()), NONE)
+        , m_watermarks(std::max<size_t>(1, detectors.size()), detectors.empty() ? NONE : 0)
+        , m_max_pending(max_pending) {
+
+        for (auto detector : detectors) {
+            if (!m_indices.insert({detector, m_inboxes.size()}).second) {
+                throw JException("JHitMerger: Detector %llu listed twice", static_cast<unsigned long long>(detector));
+            }
+            m_inboxes.push_back(Inbox {detector, {}, 0});
+        }
+    }
+
+    JHitMerger(const JHitMerger&) = delete;
+    JHitMerger& operator=(const JHitMerger&) = delete;
+
+    ~JHitMerger() {
+        for (auto& inbox : m_inboxes) {
+            for (auto hit : inbox.hits) delete hit;
+        }
+    }
+
+    /// push() takes ownership of hit, and queues it unless it is late
+    void push(T* hit) {
+        size_t index;
+        Inbox& inbox = find(hit->get_source_id(), index);
+        Timestamp timestamp = hit->get_timestamp();
+        if (timestamp < inbox.watermark || timestamp < m_forced_watermark) {
+            delete hit;
+            m_late_count++;
+            return;
+        }
+        inbox.hits.push_back(hit);
+        m_pending_count++;
+        if (inbox.hits.size() == 1) {
+            m_heads.update(index, timestamp);
+        }
+        raise_watermark(inbox, index, timestamp);
+    }
+
+    /// push_watermark() records detector's promise that it won't send any hits before timestamp
+    void push_watermark(DetectorId detector, Timestamp timestamp) {
+        size_t index;
+        Inbox& inbox = find(detector, index);
+        raise_watermark(inbox, index, timestamp);
+    }
+
+    /// finish() is called once detector won't send anything more. finish_all() is called at the end of the stream.
+    void finish(DetectorId detector) { push_watermark(detector, NONE); }
+
+    void finish_all() {
+        for (size_t i=0; i<m_inboxes.size(); ++i) raise_watermark(m_inboxes[i], i, NONE);
+    }
+
+    /// Everything below the watermark is complete
+    Timestamp get_watermark() const { return std::max(m_watermarks.min().first, m_forced_watermark); }
+
+    /// peek() tells whether the next hit in timestamp order is complete, and if so, what its timestamp is
+    bool peek(Timestamp& timestamp) {
+        if (m_pending_count == 0) return false;
+        timestamp = m_heads.min().first;
+        if (m_max_pending != 0 && m_pending_count > m_max_pending && timestamp >= m_forced_watermark) {
+            // Stop waiting for the stragglers. Whatever they send from before this hit will be late.
+            m_forced_watermark = timestamp + 1;
+            m_forced_count++;
+        }
+        return timestamp < get_watermark();
+    }
+
+    /// pop() hands over the hit that peek() just found complete
+    T* pop() {
+        size_t index = m_heads.min().second;
+        auto& hits = m_inboxes[index].hits;
+        T* hit = hits.front();
+        hits.pop_front();
+        m_pending_count--;
+        m_heads.update(index, hits.empty() ? NONE : hits.front()->get_timestamp());
+        return hit;
+    }
+
+    /// Whether the stream has ended and every hit has been handed out
+    bool is_finished() const { return m_pending_count == 0 && get_watermark() == NONE; }
+
+    size_t get_pending_count() const { return m_pending_count; }
+    size_t get_late_count() const { return m_late_count; }
+    size_t get_forced_count() const { return m_forced_count; }
+};
+
+template <typename T>
+constexpr Timestamp JHitMerger<T>::NONE;
+
+
+#endif //JANA2_JHITMERGER_H
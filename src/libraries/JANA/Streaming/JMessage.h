@@ -7,10 +7,44 @@
 
 #include <JANA/JObject.h>
 
+#include <cstddef>
+
 using DetectorId = uint64_t;
 using Timestamp = uint64_t;
 
 
+/// JTransportBuffer lets a JTransport hand a message memory which the transport owns, e.g. a received zmq_msg_t,
+/// instead of copying the payload into the message's own buffer. The transport constructs its native handle in place
+/// inside `handle`, points `data` and `size` at the payload, and sets `release_fn` to whatever frees the handle.
+/// The handle is never moved, so it may point into itself. The buffer is released when the message receives again,
+/// when it is recycled, or when it is destroyed, whichever comes first.
+
+struct JTransportBuffer {
+
+    alignas(std::max_align_t) unsigned char handle[64];     ///< Room for a transport-native handle such as a zmq_msg_t
+    char* data = nullptr;                                   ///< The payload, which the handle owns
+    size_t size = 0;
+    void (*release_fn)(JTransportBuffer&) = nullptr;        ///< Frees the handle. Null while nothing is held.
+
+    JTransportBuffer() = default;
+    JTransportBuffer(const JTransportBuffer&) = delete;
+    JTransportBuffer& operator=(const JTransportBuffer&) = delete;
+    ~JTransportBuffer() { release(); }
+
+    bool is_held() const { return release_fn != nullptr; }
+
+    void release() {
+        if (release_fn != nullptr) {
+            auto fn = release_fn;
+            release_fn = nullptr;
+            fn(*this);
+        }
+        data = nullptr;
+        size = 0;
+    }
+};
+
+
 /// JMessage is an interface for data that can be streamed using JTransports.
 ///
 /// The basic goal is to have an object wrapper around an old-fashioned `char*` buffer
@@ -49,6 +83,14 @@ struct JMessage {
     /// TODO: Figure out best way to handle empty end-of-stream as well as other control signals such as change-run.
     /// \return Whether this is the last message to expect from the producer
     virtual bool is_end_of_stream() const = 0;
+
+    /// Messages which can view a buffer owned by the transport, rather than only their own, return a JTransportBuffer
+    /// here. Whenever it is held, as_buffer(), get_buffer_capacity() and get_buffer_size() have to describe it instead of the message's own
+    /// buffer. Transports which support this receive into it without copying, and fall back on as_buffer() otherwise.
+    /// \return The message's JTransportBuffer, or nullptr if it only uses its own buffer
+    virtual JTransportBuffer* get_transport_buffer() { return nullptr; }
+
+    virtual ~JMessage() = default;
 };
 
 
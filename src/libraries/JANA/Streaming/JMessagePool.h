@@ -0,0 +1,124 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef JANA2_JMESSAGEPOOL_H
+#define JANA2_JMESSAGEPOOL_H
+
+#include <JANA/JFactoryGenerator.h>
+#include <JANA/JFactoryT.h>
+#include <JANA/Streaming/JMessage.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class JApplication;
+
+/// JMessagePool recycles JMessages, along with the buffers they allocated, so that a streaming source doesn't
+/// allocate a new message for every receive(). Messages go back into the pool when the JEvent they were inserted
+/// into is recycled (see JMessagePoolFactory), at which point any JTransportBuffer they hold is released.
+/// The pool never holds more messages than were in flight at once. It is shared by the source and the factories
+/// of all of its events, so it lives as long as the last of them.
+
+template <typename MessageT>
+class JMessagePool {
+
+    std::mutex m_mutex;
+    std::vector<MessageT*> m_messages;
+    std::atomic<size_t> m_created_count {0};
+
+public:
+    JMessagePool() = default;
+    JMessagePool(const JMessagePool&) = delete;
+    JMessagePool& operator=(const JMessagePool&) = delete;
+
+    ~JMessagePool() {
+        for (auto message : m_messages) delete message;
+    }
+
+    /// get() hands out a recycled message if there is one, and otherwise makes a new one the way
+    /// JStreamingEventSource always has, via MessageT(JApplication*)
+    MessageT* get(JApplication* app) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_messages.empty()) {
+                auto message = m_messages.back();
+                m_messages.pop_back();
+                return message;
+            }
+        }
+        m_created_count++;
+        return new MessageT(app);
+    }
+
+    /// put() takes back a message which nobody uses any more
+    void put(MessageT* message) {
+        auto transport_buffer = message->get_transport_buffer();
+        if (transport_buffer != nullptr) {
+            transport_buffer->release();  // Don't hold on to the transport's memory while sitting in the pool
+        }
+        message->ClearAssociatedObjects();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_messages.push_back(message);
+    }
+
+    /// How many messages were ever allocated. Once the pool is warm, this stops growing.
+    size_t get_created_count() const { return m_created_count; }
+
+    size_t get_idle_count() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_messages.size();
+    }
+};
+
+
+/// JMessagePoolFactory holds the messages a streaming source inserted into an event. Instead of deleting them
+/// when the event is recycled, it gives them back to their JMessagePool.
+
+template <typename MessageT>
+class JMessagePoolFactory : public JFactoryT<MessageT> {
+
+    std::shared_ptr<JMessagePool<MessageT>> m_pool;
+
+    void ReturnMessages() {
+        for (auto message : this->mData) m_pool->put(message);
+        this->mData.clear();
+    }
+
+public:
+    explicit JMessagePoolFactory(std::shared_ptr<JMessagePool<MessageT>> pool) : m_pool(std::move(pool)) {
+        this->SetFactoryFlag(JFactory::NOT_OBJECT_OWNER);  // The pool owns them
+    }
+
+    ~JMessagePoolFactory() override {
+        ReturnMessages();
+    }
+
+    void ClearData() override {
+        // Same conditions under which JFactoryT would have deleted them
+        if (this->mStatus != JFactory::Status::Uninitialized && !this->TestFactoryFlag(JFactory::PERSISTENT)) {
+            ReturnMessages();
+        }
+        JFactoryT<MessageT>::ClearData();
+    }
+};
+
+
+template <typename MessageT>
+class JMessagePoolFactoryGenerator : public JFactoryGenerator {
+
+    std::shared_ptr<JMessagePool<MessageT>> m_pool;
+
+public:
+    explicit JMessagePoolFactoryGenerator(std::shared_ptr<JMessagePool<MessageT>> pool) : m_pool(std::move(pool)) {}
+
+    void GenerateFactories(JFactorySet* factory_set) override {
+        auto factory = new JMessagePoolFactory<MessageT>(m_pool);
+        factory->SetFactoryName(JTypeInfo::demangle<JMessagePoolFactory<MessageT>>());
+        factory->SetPluginName(GetPluginName());
+        factory_set->Add(factory);
+    }
+};
+
+#endif //JANA2_JMESSAGEPOOL_H
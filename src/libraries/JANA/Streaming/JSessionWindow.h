@@ -6,93 +6,76 @@
 #define JANA2_JSESSIONWINDOW_H
 
 #include <JANA/Streaming/JWindow.h>
+#include <JANA/Streaming/JHitMerger.h>
 
-#include <map>
-#include <queue>
+#include <limits>
+#include <vector>
 
 /// JSessionWindow aggregates JMessages adaptively, i.e. a JEvent's time interval starts with the
-/// first JMessage and ends once there are no more JMessages timestamped before a configurable
-/// max interval width. This is usually what is meant by 'event-building'.
+/// first JMessage and ends once there are no more JMessages timestamped within event_interval of the
+/// previous one. This is usually what is meant by 'event-building'. So that a busy detector can't make
+/// an event grow forever, an event is also cut off once it spans max_width. Messages within an event are
+/// ordered by timestamp. Like JFixedWindow, it waits for every detector, but for no more than max_pending
+/// messages' worth (see JHitMerger).
 template <typename T>
 class JSessionWindow : public JWindow<T> {
-private:
-    template <typename S>
-    struct maybe {
-        bool is_none = true;
-        S value;
-    };
-
 public:
 
-    JSessionWindow(Timestamp event_interval, const std::vector<DetectorId> &detectors)
-    : m_event_interval(event_interval) {
-        for (auto id : detectors) {
-            m_inbox.insert({id, {}});
-        }
+    JSessionWindow(Timestamp event_interval, const std::vector<DetectorId> &detectors,
+                   Timestamp max_width = std::numeric_limits<Timestamp>::max(), size_t max_pending = 1000000)
+        : m_merger(detectors, max_pending)
+        , m_event_interval(event_interval)
+        , m_max_width(max_width) {
     }
 
-    void pushMessage(T* message) final {
-        // TODO: Why was messages a vector before?
-        auto iter = m_inbox.find(message->source_id);
-        if (iter == m_inbox.end()) {
-            throw std::runtime_error("Unexpected detector!");
-        } else {
-            iter->second.push_back(message);
-        }
-    };
+    ~JSessionWindow() override {
+        for (auto message : m_outbox) delete message;
+    }
+
+    void pushMessage(T* message) final { m_merger.push(message); }
+
+    void pushWatermark(DetectorId detector, Timestamp timestamp) final { m_merger.push_watermark(detector, timestamp); }
+
+    void finish() final { m_merger.finish_all(); }
+
+    bool isFinished() const final { return m_outbox.empty() && m_merger.is_finished(); }
 
     bool pullEvent(JEvent& event) final {
-        return false;
-    };
-
-/*
-    maybe<JMessage::Timestamp> find_next_event_start() {
-        maybe<JMessage::Timestamp> result;
-        result.is_none = true;
-        if (!m_inbox.empty()) {
-            result.is_none = false;
-            auto iter = m_inbox.begin();
-            result.value = iter->second.timestamp;
-
-            while (++iter != m_inbox.end()) {
-                if (iter->second.is_none) {
-                    result.is_none = true;
-                    return result;
-                }
-                result.value = std::min(result.value, iter->second.value);
-            }
-        }
-        return result;
-    }
 
-    bool stage_next_event() {
-        if (m_next_event_start.is_none) {
-            m_next_event_start = find_next_event_start();
-            if (m_next_event_start.is_none) {
-                return false;
-            }
-        }
-        Timestamp next_event_finish = m_next_event_start.value + m_event_interval;
-        for (auto iter : m_inbox) { // for each detector
-            auto &q = iter.second;
-            while (q.front().timestamp <= next_event_finish) {
-                m_outbox.push_back(std::move(q.front()));
-                q.pop_front();
-            }
-            if (q.empty()) {
-                // we've run out of samples, so we can't say whether we have everything or not
-                return false;
+        bool complete = false;
+        Timestamp timestamp;
+        while (m_merger.peek(timestamp)) {
+            if (!m_outbox.empty() && !joins(timestamp)) {
+                complete = true;
+                break;
             }
+            if (m_outbox.empty()) m_start = timestamp;
+            m_last = timestamp;
+            m_outbox.push_back(m_merger.pop());
         }
+        if (m_outbox.empty()) return false;
+        // Nothing can join any more once every detector has moved past the point where it would have
+        if (!complete && joins(m_merger.get_watermark())) return false;
+
+        event.Insert<T>(m_outbox);
+        m_outbox.clear();
         return true;
     }
 
-*/
+    const JHitMerger<T>& getMerger() const { return m_merger; }
+
 private:
-    std::map<DetectorId, std::deque<JMessage*>> m_inbox;
-    std::vector<T *> m_outbox;
-    maybe<Timestamp> m_next_event_start;
+    /// Whether a message at timestamp belongs to the event being built
+    bool joins(Timestamp timestamp) const {
+        return timestamp - m_last <= m_event_interval && timestamp - m_start < m_max_width;
+    }
+
+    JHitMerger<T> m_merger;
+    std::vector<T*> m_outbox;   // The event being built
+    Timestamp m_start = 0;      // Timestamp of its first message
+    Timestamp m_last = 0;       // Timestamp of its latest message
     Timestamp m_event_interval; // TODO: This should be a duration
+    Timestamp m_max_width;
 };
 
 
@@ -12,6 +12,7 @@
 #include <queue>
 
 #include <JANA/JEventSource.h>
+#include <JANA/Streaming/JMessagePool.h>
 #include <JANA/Streaming/JTransport.h>
 
 /// JStreamingEventSource is a class template which simplifies streaming events into JANA.
@@ -28,12 +29,18 @@
 /// complexity is fundamentally a property of the message format anyway. However, if we are using JStreamingEventSource,
 /// it is essential that each message corresponds to one JEvent.
 ///
-/// The JStreamingEventSource owns its JTransport, but passes ownership of each JMessage to its enclosing JEvent.
+/// The JStreamingEventSource owns its JTransport. Messages come from a JMessagePool and are inserted into the JEvent,
+/// which hands them back to the pool when it is recycled, so that neither the messages nor their buffers are
+/// allocated anew for every event. For this to work, the JStreamingEventSource provides a JFactoryGenerator for
+/// MessageT's factory. If the user gives it a JFactoryGenerator of their own instead, the events own their
+/// messages and delete them, as they would any other inserted object.
 
 template <class MessageT>
 class JStreamingEventSource : public JEventSource {
 
     std::unique_ptr<JTransport> m_transport;   ///< Pointer to underlying transport
+    std::shared_ptr<JMessagePool<MessageT>> m_pool;
+    std::unique_ptr<JMessagePoolFactoryGenerator<MessageT>> m_pool_factory_generator;
     MessageT* m_next_item;     ///< An empty message buffer kept in reserve for when the next receive() succeeds
     size_t m_next_evt_nr = 1;  ///< If the event number is not encoded in the message payload, be able to assign one
 
@@ -42,34 +49,49 @@ public:
     /// The constructor requires a unique pointer to a JTransport implementation. This is a reasonable assumption to
     /// make because each JEventSource already corresponds to some unique resource. JStreamingEventSource should be free
     /// to destroy its transport object whenever it likes, so try to keep the JTransport free of weird shared state.
+    /// The pool's JFactoryGenerator is only installed if the user doesn't provide a factory_generator.
 
-    explicit JStreamingEventSource(std::unique_ptr<JTransport>&& transport)
+    explicit JStreamingEventSource(std::unique_ptr<JTransport>&& transport, JFactoryGenerator* factory_generator = nullptr)
         : JEventSource("JStreamingEventSource")
         , m_transport(std::move(transport))
+        , m_pool(std::make_shared<JMessagePool<MessageT>>())
         , m_next_item(nullptr)
     {
+        if (factory_generator == nullptr) {
+            m_pool_factory_generator.reset(new JMessagePoolFactoryGenerator<MessageT>(m_pool));
+            factory_generator = m_pool_factory_generator.get();
+        }
+        SetFactoryGenerator(factory_generator);
+    }
+
+    ~JStreamingEventSource() override {
+        if (m_next_item != nullptr) m_pool->put(m_next_item);
     }
 
+    /// The pool which recycles this source's messages
+    const std::shared_ptr<JMessagePool<MessageT>>& GetMessagePool() const { return m_pool; }
+
     /// Open delegates down to the transport, which will open a network socket or similar.
 
     void Open() override {
         m_transport->initialize();
     }
 
-    /// GetEvent attempts to receive a JEventMessage. If it succeeds, it inserts it into the JEvent and sets
-    /// the event number and run number appropriately.
+    /// TryGetEvent attempts to receive a JEventMessage. If it succeeds, it inserts it into the JEvent and sets
+    /// the event number and run number appropriately. An empty poll is the common case, so it returns TryAgain
+    /// rather than throwing.
 
-    void GetEvent(std::shared_ptr<JEvent> event) override {
+    ReturnStatus TryGetEvent(std::shared_ptr<JEvent> event) override {
 
         if (m_next_item == nullptr) {
-            m_next_item = new MessageT(GetApplication());
+            m_next_item = m_pool->get(GetApplication());
         }
 
         auto result = m_transport->receive(*m_next_item);
         switch (result) {
-            case JTransport::Result::FINISHED:   throw JEventSource::RETURN_STATUS::kNO_MORE_EVENTS;
-            case JTransport::Result::TRY_AGAIN:  throw JEventSource::RETURN_STATUS::kTRY_AGAIN;
-            case JTransport::Result::FAILURE:    throw JEventSource::RETURN_STATUS::kERROR;
+            case JTransport::Result::FINISHED:   return ReturnStatus::Finished;
+            case JTransport::Result::TRY_AGAIN:  return ReturnStatus::TryAgain;
+            case JTransport::Result::FAILURE:    throw JException("JStreamingEventSource: Transport failed to receive");
             default:                             break;
         }
 
@@ -81,7 +103,7 @@ public:
         event->SetEventNumber(evt_nr == 0 ? m_next_evt_nr++ : evt_nr);
         event->SetRunNumber(item->get_run_number());
         event->Insert<MessageT>(item);
-        std::cout << "JStreamingEventSource: Emitting " << *item << std::endl;
+        return ReturnStatus::Success;
     }
 
     static std::string GetDescription() {
@@ -29,7 +29,9 @@ struct JTransport {
     virtual Result send(const JMessage& src_msg) = 0;
 
     /// receive should return as soon as the dest_msg has been written. If there are no messages waiting,
-    /// receive should return TRY_AGAIN immediately instead of blocking.
+    /// receive should return TRY_AGAIN immediately instead of blocking. If dest_msg offers a JTransportBuffer,
+    /// a transport which owns its receive buffers should hand one over there instead of copying it into
+    /// dest_msg.as_buffer(). Either way, dest_msg may be a recycled message which still holds an old buffer.
     virtual Result receive(JMessage& dest_msg) = 0;
 
     /// It is reasonable to close sockets in the destructor, since:
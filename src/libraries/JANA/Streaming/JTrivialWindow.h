@@ -8,16 +8,34 @@
 
 #include <JANA/Streaming/JWindow.h>
 
+#include <deque>
+
 /// JTrivialWindow emits a new JEvent for each JMessage it receives. This may be useful for simple
 /// scenarios such as anomaly detection, or when events have already been built upstream so that
 /// each JMessage corresponds to one event already.
 template <typename T>
 class JTrivialWindow : public JWindow<T> {
 public:
-    void pushMessage(T* message) final;
-    bool pullEvent(JEvent& event) final;
+    ~JTrivialWindow() override {
+        for (auto message : m_pending_messages) delete message;
+    }
+
+    void pushMessage(T* message) final { m_pending_messages.push_back(message); }
+
+    bool pullEvent(JEvent& event) final {
+        if (m_pending_messages.empty()) return false;
+        event.Insert<T>(m_pending_messages.front());
+        m_pending_messages.pop_front();
+        return true;
+    }
+
+    void finish() final { m_finished = true; }
+
+    bool isFinished() const final { return m_finished && m_pending_messages.empty(); }
+
 private:
     std::deque<T*> m_pending_messages;
+    bool m_finished = false;
 };
 
 #endif //JANA2_JTRIVIALWINDOW_H
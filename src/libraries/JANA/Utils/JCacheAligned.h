@@ -0,0 +1,36 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+
+#ifndef JANA2_JCACHEALIGNED_H
+#define JANA2_JCACHEALIGNED_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#ifndef CACHE_LINE_BYTES
+#define CACHE_LINE_BYTES 64
+#endif
+
+/// JCacheAligned gives classes deriving from it allocation functions which honor cache line alignment.
+/// Until C++17, plain `new` only guarantees alignof(std::max_align_t), so a heap-allocated class which aligns
+/// its members to cache lines (to keep them from false sharing) could end up misaligned. This is what
+/// -Waligned-new warns about. Derived classes must not ask for more than CACHE_LINE_BYTES.
+struct JCacheAligned {
+
+    static void* operator new(size_t size) { return allocate(size); }
+    static void* operator new[](size_t size) { return allocate(size); }
+    static void operator delete(void* ptr) noexcept { std::free(ptr); }
+    static void operator delete[](void* ptr) noexcept { std::free(ptr); }
+
+private:
+    static void* allocate(size_t size) {
+        void* ptr = nullptr;
+        if (posix_memalign(&ptr, CACHE_LINE_BYTES, size) != 0) throw std::bad_alloc();
+        return ptr;
+    }
+};
+
+
+#endif //JANA2_JCACHEALIGNED_H
@@ -15,12 +15,6 @@ using std::vector;
 using std::string;
 using std::endl;
 
-void JCallGraphRecorder::Reset() {
-    m_call_graph.clear();
-    m_call_stack.clear();
-    m_error_call_stack.clear();
-}
-
 void JCallGraphRecorder::PrintErrorCallStack() {
 
     // Create a list of the call strings while finding the longest one
@@ -61,12 +61,20 @@ public:
     inline void AddToErrorCallStack(const JErrorCallStack &cs) {if (m_enabled) m_error_call_stack.push_back(cs);} ///< Add layer to the factory call stack
     inline std::vector<JErrorCallStack> GetErrorCallStack(){return m_error_call_stack;} ///< Get the current factory error call stack
     void PrintErrorCallStack(); ///< Print the current factory call stack
-    void Reset();
+    inline void Reset();
     std::vector<std::pair<std::string, std::string>> TopologicalSort() const;
 };
 
 
 
+/// Reset() is called every time the event gets recycled. Nothing is recorded unless recording is enabled,
+/// so it is inline: usually all it does is find three empty vectors.
+void JCallGraphRecorder::Reset() {
+    m_call_graph.clear();
+    m_call_stack.clear();
+    m_error_call_stack.clear();
+}
+
 void JCallGraphRecorder::StartFactoryCall(const std::string& callee_name, const std::string& callee_tag) {
 
     /// This is used to fill initial info into a call_stack_t stucture
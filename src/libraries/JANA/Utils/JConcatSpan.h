@@ -0,0 +1,97 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef JANA2_JCONCATSPAN_H
+#define JANA2_JCONCATSPAN_H
+
+#include <JANA/JFactorySet.h>
+
+#include <iterator>
+
+/// JConcatSpan is what JEvent::GetAllSpan<T>() returns: the objects of every JFactoryT<T>, regardless of tag,
+/// viewed as one range without copying them anywhere. It only holds on to the factories, so like a JSpan,
+/// it is valid until the event is recycled.
+template <typename T>
+class JConcatSpan {
+    using FactoryIterator = JFactorySet::FactoryMap::const_iterator;
+    FactoryIterator m_begin;
+    FactoryIterator m_end;
+
+    static JSpan<const T* const> SpanOf(FactoryIterator it) {
+        return static_cast<const JFactoryT<T>*>(it->second)->GetSpan();
+    }
+
+public:
+    class iterator {
+        FactoryIterator m_factory;
+        FactoryIterator m_end;
+        const T* const* m_item = nullptr;
+        const T* const* m_item_end = nullptr;
+
+        /// Move on to the first object of the next factory which has any
+        void skip_empty_factories() {
+            while (m_item == m_item_end && m_factory != m_end) {
+                ++m_factory;
+                if (m_factory != m_end) {
+                    auto span = SpanOf(m_factory);
+                    m_item = span.begin();
+                    m_item_end = span.end();
+                }
+                else {
+                    m_item = m_item_end = nullptr;
+                }
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = const T*;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T* const*;
+        using reference = const T* const&;
+
+        iterator(FactoryIterator factory, FactoryIterator end) : m_factory(factory), m_end(end) {
+            if (m_factory != m_end) {
+                auto span = SpanOf(m_factory);
+                m_item = span.begin();
+                m_item_end = span.end();
+                skip_empty_factories();
+            }
+        }
+
+        reference operator*() const { return *m_item; }
+
+        iterator& operator++() {
+            ++m_item;
+            skip_empty_factories();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator previous = *this;
+            ++(*this);
+            return previous;
+        }
+
+        bool operator==(const iterator& other) const { return m_factory == other.m_factory && m_item == other.m_item; }
+        bool operator!=(const iterator& other) const { return !(*this == other); }
+    };
+
+    JConcatSpan(FactoryIterator begin, FactoryIterator end) : m_begin(begin), m_end(end) {}
+
+    iterator begin() const { return iterator(m_begin, m_end); }
+    iterator end() const { return iterator(m_end, m_end); }
+
+    size_t size() const {
+        size_t size = 0;
+        for (auto it = m_begin; it != m_end; ++it) {
+            size += SpanOf(it).size();
+        }
+        return size;
+    }
+
+    bool empty() const { return begin() == end(); }
+};
+
+
+#endif //JANA2_JCONCATSPAN_H
@@ -0,0 +1,156 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+
+#ifndef JANA2_JEVENTARENA_H
+#define JANA2_JEVENTARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// JEventArena is a monotonic allocator for data which lives exactly as long as one event. Create<T>() carves
+/// objects out of large blocks instead of going to the heap one object at a time, and Reset() releases all of
+/// them at once: it runs their destructors in reverse order of creation and rewinds the blocks, which are kept
+/// for the next event. If an event ever needs more than one block, Reset() merges them into a single block big
+/// enough for the whole event, so that the arena settles on one allocation and then stops calling malloc.
+///
+/// Each JEvent owns an arena, which its JEventPool resets when the event is recycled. The arena doesn't
+/// allocate anything until it is first used. Like the rest of the JEvent, it is not thread-safe by default;
+/// SetConcurrent(true) makes Allocate() and Create() lock while several threads work on the same event.
+class JEventArena {
+
+    struct Block {
+        std::unique_ptr<char[]> memory;
+        size_t size;
+    };
+
+    struct Destructor {
+        void (*destroy)(void*);
+        void* object;
+    };
+
+    std::vector<Block> m_blocks;
+    std::vector<Destructor> m_destructors;
+    size_t m_block_size;
+    size_t m_current_block = 0;
+    size_t m_offset = 0;
+    size_t m_allocation_count = 0;  // Since the last Reset()
+    size_t m_allocated_bytes = 0;   // Since the last Reset()
+    bool m_is_concurrent = false;
+    std::mutex m_mutex;
+
+    template <typename T>
+    static void destroy(void* object) {
+        static_cast<T*>(object)->~T();
+    }
+
+    inline void destroy_all() {
+        for (auto it = m_destructors.rbegin(); it != m_destructors.rend(); ++it) {
+            it->destroy(it->object);
+        }
+        m_destructors.clear();
+    }
+
+    inline void add_block(size_t min_size) {
+        size_t size = std::max(m_block_size, min_size);
+        if (!m_blocks.empty()) {
+            size = std::max(size, 2 * m_blocks.back().size);
+        }
+        m_blocks.push_back({std::unique_ptr<char[]>(new char[size]), size});
+    }
+
+public:
+
+    explicit JEventArena(size_t block_size = 64 * 1024) : m_block_size(block_size) {}
+
+    JEventArena(const JEventArena&) = delete;
+    JEventArena& operator=(const JEventArena&) = delete;
+
+    ~JEventArena() { destroy_all(); }
+
+    /// Allocate() returns uninitialized memory, which stays valid until the next Reset()
+    inline void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        std::unique_lock<std::mutex> lock(m_mutex, std::defer_lock);
+        if (m_is_concurrent) lock.lock();
+        while (true) {
+            if (m_current_block == m_blocks.size()) {
+                add_block(size + alignment);
+            }
+            Block& block = m_blocks[m_current_block];
+            auto base = reinterpret_cast<uintptr_t>(block.memory.get());
+            auto aligned = (base + m_offset + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+            if (aligned + size <= base + block.size) {
+                m_offset = aligned + size - base;
+                m_allocation_count++;
+                m_allocated_bytes += size;
+                return reinterpret_cast<void*>(aligned);
+            }
+            m_current_block++;
+            m_offset = 0;
+        }
+    }
+
+    /// Create() constructs a T inside the arena. Its destructor will be run by Reset().
+    template <typename T, typename... Args>
+    T* Create(Args&&... args) {
+        void* memory = Allocate(sizeof(T), alignof(T));
+        T* object = new (memory) T(std::forward<Args>(args)...);
+        if (!std::is_trivially_destructible<T>::value) {
+            std::unique_lock<std::mutex> lock(m_mutex, std::defer_lock);
+            if (m_is_concurrent) lock.lock();
+            m_destructors.push_back({&destroy<T>, object});
+        }
+        return object;
+    }
+
+    /// SetConcurrent() must only be called while no other thread is using the arena
+    inline void SetConcurrent(bool is_concurrent) { m_is_concurrent = is_concurrent; }
+
+    /// Owns() tells whether ptr points into the arena, i.e. whether somebody else must refrain from deleting it
+    inline bool Owns(const void* ptr) const {
+        auto address = reinterpret_cast<uintptr_t>(ptr);
+        for (const Block& block : m_blocks) {
+            auto base = reinterpret_cast<uintptr_t>(block.memory.get());
+            if (address >= base && address < base + block.size) return true;
+        }
+        return false;
+    }
+
+    /// Reset() destroys everything created since the last Reset() and makes its memory available again
+    inline void Reset() {
+        destroy_all();
+        if (m_blocks.size() > 1) {
+            size_t total_size = 0;
+            for (const Block& block : m_blocks) total_size += block.size;
+            m_blocks.clear();
+            m_blocks.push_back({std::unique_ptr<char[]>(new char[total_size]), total_size});
+        }
+        m_current_block = 0;
+        m_offset = 0;
+        m_allocation_count = 0;
+        m_allocated_bytes = 0;
+    }
+
+    /// Number of allocations made since the last Reset(), i.e. for the current event
+    inline size_t GetAllocationCount() const { return m_allocation_count; }
+
+    /// Number of bytes requested since the last Reset(), i.e. for the current event
+    inline size_t GetAllocatedBytes() const { return m_allocated_bytes; }
+
+    /// Total size of the blocks the arena is holding on to
+    inline size_t GetCapacity() const {
+        size_t capacity = 0;
+        for (const Block& block : m_blocks) capacity += block.size;
+        return capacity;
+    }
+};
+
+
+#endif //JANA2_JEVENTARENA_H
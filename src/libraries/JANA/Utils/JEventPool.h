@@ -7,14 +7,54 @@
 #define JANA2_JEVENTPOOL_H
 
 #include <JANA/JEvent.h>
+#include <JANA/JEventSource.h>
 #include <JANA/JFactoryGenerator.h>
+#include <JANA/Engine/JWakeupSignal.h>
+#include <JANA/Utils/JCacheAligned.h>
+#include <JANA/Utils/JCpuInfo.h>
+#include <JANA/Utils/JProcessorMapping.h>
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
+/// JEventPool recycles JEvents, along with their JFactorySets, so that factory data can be reused
+/// across events. The pool is partitioned by location: each location gets its own pool_size events,
+/// which are constructed by a thread pinned to one of that location's cpus so that the OS places their
+/// memory on the right NUMA domain (first-touch). get(location) only ever hands out events from the
+/// requested location's partition, and put() always returns an event to the partition it came from,
+/// regardless of which location finished with it. put() counts whether each event was used locally
+/// or remotely, i.e. whether it ended up being processed by a worker at a different location than
+/// the one owning its memory.
+///
+/// If the pool is given a list of JEventSources, it is additionally partitioned by source: each source
+/// gets pool_size events per location, whose JFactorySets already contain that source's factories.
+/// Thus several sources can ingest concurrently without ever rebuilding a JFactorySet on the hot path.
+///
+/// Recycling an event also resets its JEventArena, which releases all of the event's arena-allocated
+/// objects in one go. The pool keeps track of how much the arenas were used per recycled event.
+///
+/// The pool owns every event it creates for as long as it lives, and hands them out as plain JEvent*,
+/// so that passing events between arrows and mailboxes never touches an atomic reference count. Each event owns
+/// itself through the shared_ptr handles which user code sees (see JEvent::mHandle), and the pool lets go of it by
+/// resetting them. Thus a handle which user code holds on to keeps its event alive, even past the pool.
+/// get() and put() used to take and return shared_ptr<JEvent>. put() still accepts one.
+///
+/// A source which finds its partition empty comes back later. put() notifies the wakeup signal, if there is one,
+/// so that any Worker which parked in the meantime retries right away instead of waiting for its timeout.
 class JEventPool {
 private:
 
-    struct alignas(64) LocalPool {
+    struct alignas(CACHE_LINE_BYTES) LocalPool : public JCacheAligned {
         std::mutex mutex;
-        std::vector<std::shared_ptr<JEvent>> events;
+        std::vector<JEvent*> events;                // Available for get()
+        std::vector<JEvent*> owned;         // Every event belonging to this partition, available or not, by mPoolIndex
+        std::atomic<size_t> local_use_count {0};
+        std::atomic<size_t> remote_use_count {0};
+        size_t recycled_count = 0;          // Guarded by mutex, like the arena counts below
+        size_t arena_allocation_count = 0;
+        size_t arena_byte_count = 0;
     };
 
     std::vector<JFactoryGenerator*>* m_generators;
@@ -22,37 +62,155 @@ private:
     size_t m_pool_size;
     size_t m_location_count;
     bool m_limit_total_events_in_flight;
-    std::unique_ptr<LocalPool[]> m_pools;
+    std::vector<JEventSource*> m_sources;   // Empty if events aren't specialized by source
+    size_t m_source_count;                  // At least 1, so that there is always a partition
+    std::unique_ptr<LocalPool[]> m_pools;   // Indexed by source * m_location_count + location
+    JWakeupSignal* m_wakeup_signal = nullptr;
+
+    /// If the pool isn't partitioned by source, every source shares partition 0
+    inline size_t find_source(JEventSource* source) const {
+        if (m_sources.empty()) return 0;
+        for (size_t i=0; i<m_sources.size(); ++i) {
+            if (m_sources[i] == source) return i;
+        }
+        throw JException("JEventPool: Event source '%s' has no partition", source == nullptr ? "(null)" : source->GetName().c_str());
+    }
+
+    inline LocalPool& get_pool(size_t source_index, size_t location) {
+        return m_pools[source_index * m_location_count + location];
+    }
+
+    /// Called with pool's lock held whenever an event comes back, so its arena counts cover the whole event
+    static inline void record_arena_usage(LocalPool& pool, const JEvent& event) {
+        pool.recycled_count++;
+        pool.arena_allocation_count += event.mArena.GetAllocationCount();
+        pool.arena_byte_count += event.mArena.GetAllocatedBytes();
+    }
+
+    /// Called with pool's lock held, unless the pool is still being filled
+    inline JEvent* make_event(size_t source_index, size_t location) {
+        auto event = std::make_shared<JEvent>();
+        if (m_sources.empty()) {
+            event->SetFactorySet(new JFactorySet(*m_generators));
+        }
+        else {
+            // Source-specific factories shadow the default ones
+            JEventSource* source = m_sources[source_index];
+            event->SetFactorySet(new JFactorySet(source->GetFactoryGenerator(), *m_generators));
+            event->SetJEventSource(source);
+        }
+        event->GetJCallGraphRecorder()->SetEnabled(m_enable_call_graph_recording);
+        event->mPoolLocation = location;
+        event->mPoolSource = source_index;
+        auto& owned = get_pool(source_index, location).owned;
+        event->mPoolIndex = owned.size();
+        owned.push_back(event.get());
+        event->mHandle = event;
+        event->mConstHandle = event;
+        return event.get();
+    }
+
+    /// release_event() resets event's handles and returns the last one, so that the caller controls when the event
+    /// gets destroyed. It survives if user code still holds a handle.
+    static inline std::shared_ptr<JEvent> release_event(JEvent* event) {
+        event->mConstHandle.reset();
+        return std::move(event->mHandle);
+    }
+
+    /// Called with pool's lock held, for surplus events which were made because the pool ran dry while
+    /// m_limit_total_events_in_flight was off. The caller destroys the event once it has let go of the lock.
+    static inline std::shared_ptr<JEvent> disown_event(LocalPool& pool, JEvent* event) {
+        JEvent* last = pool.owned.back();
+        pool.owned[event->mPoolIndex] = last;
+        last->mPoolIndex = event->mPoolIndex;
+        pool.owned.pop_back();
+        return release_event(event);
+    }
+
+    inline void fill(size_t location) {
+        for (size_t source_index=0; source_index<m_source_count; ++source_index) {
+            auto& events = get_pool(source_index, location).events;
+            for (size_t i=0; i<m_pool_size; ++i) {
+                events.push_back(make_event(source_index, location));
+            }
+        }
+    }
+
+    /// Fills location's partition from a thread pinned to cpu_id. The thread doesn't allocate anything
+    /// until it has been pinned, so that every page it touches lands on cpu_id's NUMA domain.
+    inline void fill_from_cpu(size_t location, size_t cpu_id) {
+        std::atomic_bool pinned {false};
+        std::exception_ptr error;
+        std::thread filler([&]() {
+            while (!pinned.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            try {
+                fill(location);
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+        });
+        JCpuInfo::PinThreadToCpu(&filler, cpu_id);
+        pinned.store(true, std::memory_order_release);
+        filler.join();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
 
 public:
     inline JEventPool(std::vector<JFactoryGenerator*>* generators,
                       bool enable_call_graph_recording,
                       size_t pool_size,
                       size_t location_count,
-                      bool limit_total_events_in_flight)
+                      bool limit_total_events_in_flight,
+                      const JProcessorMapping* mapping = nullptr,
+                      std::vector<JEventSource*> sources = {})
         : m_generators(generators)
         , m_enable_call_graph_recording(enable_call_graph_recording)
         , m_pool_size(pool_size)
         , m_location_count(location_count)
         , m_limit_total_events_in_flight(limit_total_events_in_flight)
+        , m_sources(std::move(sources))
+        , m_source_count(std::max<size_t>(1, m_sources.size()))
     {
         assert(m_location_count >= 1);
-        m_pools = std::unique_ptr<LocalPool[]>(new LocalPool[location_count]());
+        m_pools = std::unique_ptr<LocalPool[]>(new LocalPool[m_source_count * m_location_count]());
 
         for (size_t j=0; j<m_location_count; ++j) {
-            for (size_t i=0; i<m_pool_size; ++i) {
-                auto event = std::make_shared<JEvent>();
-                auto factory_set = new JFactorySet(*m_generators);
-                event->SetFactorySet(factory_set);
-                event->GetJCallGraphRecorder()->SetEnabled(m_enable_call_graph_recording);
-                put(event, j);
+            // Partitions are filled one at a time, because JFactoryGenerators aren't required to be thread-safe
+            std::vector<size_t> cpu_ids;
+            if (mapping != nullptr && m_location_count > 1) {
+                cpu_ids = mapping->get_cpu_ids(j);
+            }
+            if (cpu_ids.empty()) {
+                fill(j);
+            }
+            else {
+                fill_from_cpu(j, cpu_ids[0]);
+            }
+        }
+    }
+
+    inline ~JEventPool() {
+        for (size_t i=0; i<m_source_count*m_location_count; ++i) {
+            for (auto event : m_pools[i].owned) {
+                release_event(event);
             }
         }
     }
 
-    inline std::shared_ptr<JEvent> get(size_t location) {
+    JEventPool(const JEventPool&) = delete;
+    JEventPool& operator=(const JEventPool&) = delete;
+
+    /// get() hands out an event belonging to location and, if the pool is partitioned by source, to source.
+    inline JEvent* get(size_t location, JEventSource* source = nullptr) {
 
-        LocalPool& pool = m_pools[location % m_location_count];
+        location %= m_location_count;
+        size_t source_index = find_source(source);
+        LocalPool& pool = get_pool(source_index, location);
         std::lock_guard<std::mutex> lock(pool.mutex);
 
         if (pool.events.empty()) {
@@ -60,33 +218,125 @@ public:
                 return nullptr;
             }
             else {
-                auto event = std::make_shared<JEvent>();
-                auto factory_set = new JFactorySet(*m_generators);
-                event->SetFactorySet(factory_set);
-                return event;
+                // The caller is a worker at this location, so this event gets first-touched locally too
+                return make_event(source_index, location);
             }
         }
         else {
-            auto event = std::move(pool.events.back());
+            auto event = pool.events.back();
             pool.events.pop_back();
             event->mFactorySet->Release();
+            event->mArena.Reset();  // Only after Release(), since factories may still point into the arena until then
             event->mInspector.Reset();
             event->GetJCallGraphRecorder()->Reset();
             return event;
         }
     }
 
-    inline void put(std::shared_ptr<JEvent>& event, size_t location) {
+    /// put() returns event to the partition which owns it. location is where the caller is running,
+    /// and is only used to tell whether this event was used locally or remotely.
+    inline void put(JEvent* event, size_t location) {
 
-        LocalPool& pool = m_pools[location % m_location_count];
-        std::lock_guard<std::mutex> lock(pool.mutex);
+        size_t home = event->mPoolLocation % m_location_count;
+        LocalPool& pool = get_pool(event->mPoolSource % m_source_count, home);
+        if (home == location % m_location_count) {
+            pool.local_use_count.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            pool.remote_use_count.fetch_add(1, std::memory_order_relaxed);
+        }
 
+        std::shared_ptr<JEvent> surplus;  // Outlives the lock
+        std::unique_lock<std::mutex> lock(pool.mutex);
+        record_arena_usage(pool, *event);
         if (pool.events.size() < m_pool_size) {
-            pool.events.push_back(std::move(event));
+            pool.events.push_back(event);
+        }
+        else {
+            surplus = disown_event(pool, event);
+        }
+        lock.unlock();
+        if (m_wakeup_signal != nullptr) {
+            m_wakeup_signal->notify();
+        }
+    }
+
+    /// put() for callers which still hold the event by shared_ptr
+    inline void put(const std::shared_ptr<JEvent>& event, size_t location) { put(event.get(), location); }
+
+    /// put() for a whole batch of events, which only re-locks when consecutive events have different owners.
+    inline void put(std::vector<JEvent*>& events, size_t location) {
+
+        std::vector<std::shared_ptr<JEvent>> surplus;  // Outlives the lock
+        std::unique_lock<std::mutex> lock;
+        LocalPool* locked_pool = nullptr;
+        for (auto event : events) {
+            size_t home = event->mPoolLocation % m_location_count;
+            LocalPool& pool = get_pool(event->mPoolSource % m_source_count, home);
+            if (home == location % m_location_count) {
+                pool.local_use_count.fetch_add(1, std::memory_order_relaxed);
+            }
+            else {
+                pool.remote_use_count.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (&pool != locked_pool) {
+                if (lock.owns_lock()) lock.unlock();  // Never hold two partitions' locks at once
+                lock = std::unique_lock<std::mutex>(pool.mutex);
+                locked_pool = &pool;
+            }
+            record_arena_usage(pool, *event);
+            if (pool.events.size() < m_pool_size) {
+                pool.events.push_back(event);
+            }
+            else {
+                surplus.push_back(disown_event(pool, event));
+            }
         }
+        if (lock.owns_lock()) lock.unlock();
+        if (m_wakeup_signal != nullptr && !events.empty()) {
+            m_wakeup_signal->notify();
+        }
+        events.clear();
     }
 
+    /// set_wakeup_signal() tells the pool whom to notify on put. Like JMailbox::set_wakeup_signal(), this is
+    /// meant to be called during topology construction, before any worker touches the pool.
+    inline void set_wakeup_signal(JWakeupSignal* wakeup_signal) { m_wakeup_signal = wakeup_signal; }
+
     inline size_t size() { return m_pool_size; }
+
+    inline size_t get_location_count() const { return m_location_count; }
+
+    /// Number of events owned by location which were returned by a worker at that same location
+    inline size_t get_local_use_count(size_t location) const {
+        size_t count = 0;
+        for (size_t source_index=0; source_index<m_source_count; ++source_index) {
+            count += m_pools[source_index * m_location_count + location % m_location_count].local_use_count.load(std::memory_order_relaxed);
+        }
+        return count;
+    }
+
+    /// Number of events which were returned, along with the arena allocations and bytes they had made
+    inline void get_arena_usage(size_t& recycled_count, size_t& allocation_count, size_t& byte_count) {
+        recycled_count = 0;
+        allocation_count = 0;
+        byte_count = 0;
+        for (size_t i=0; i<m_source_count*m_location_count; ++i) {
+            std::lock_guard<std::mutex> lock(m_pools[i].mutex);
+            recycled_count += m_pools[i].recycled_count;
+            allocation_count += m_pools[i].arena_allocation_count;
+            byte_count += m_pools[i].arena_byte_count;
+        }
+    }
+
+    /// Number of events owned by location which were returned by a worker at some other location
+    inline size_t get_remote_use_count(size_t location) const {
+        size_t count = 0;
+        for (size_t source_index=0; source_index<m_source_count; ++source_index) {
+            count += m_pools[source_index * m_location_count + location % m_location_count].remote_use_count.load(std::memory_order_relaxed);
+        }
+        return count;
+    }
 };
 
 
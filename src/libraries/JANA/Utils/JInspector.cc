@@ -7,11 +7,13 @@
 
 JInspector::JInspector(const JEvent* event) : m_event(event) {}
 
+/// Reset() is called every time the event gets recycled, but the indices are only rebuilt if somebody
+/// actually inspects the next event
 void JInspector::Reset() {
     m_indexes_built = false;
-    m_factories.clear();
-    m_factory_index.clear();
-    m_discrepancies.clear();
+    if (!m_discrepancies.empty()) {
+        m_discrepancies.clear();
+    }
 }
 
 void JInspector::SetDiscrepancies(std::set<std::string>&& diverging_factory_keys) {
@@ -20,6 +22,8 @@ void JInspector::SetDiscrepancies(std::set<std::string>&& diverging_factory_keys
 
 void JInspector::BuildIndices() {
     if (m_indexes_built) return;
+    m_factories.clear();
+    m_factory_index.clear();
     for (auto fac: m_event->GetFactorySet()->GetAllFactories()) {
         m_factories.push_back(fac);
     }
@@ -6,6 +6,7 @@
 #include <iomanip>
 #include <unistd.h>
 #include <algorithm>
+#include <cstdint>
 
 void JProcessorMapping::initialize(AffinityStrategy affinity, LocalityStrategy locality) {
 
@@ -102,6 +103,54 @@ void JProcessorMapping::initialize(AffinityStrategy affinity, LocalityStrategy l
     m_initialized = true;
 }
 
+std::vector<size_t> JProcessorMapping::get_nearest_locations(size_t loc_id) const {
+
+    // Find the NUMA domain and socket of each location. Under every locality strategy
+    // except Global, all cpus belonging to one location share a socket.
+    std::vector<const Row*> representatives(m_loc_count, nullptr);
+    for (const Row& row : m_mapping) {
+        if (row.location_id < m_loc_count && representatives[row.location_id] == nullptr) {
+            representatives[row.location_id] = &row;
+        }
+    }
+
+    std::vector<size_t> result;
+    for (size_t i=1; i<m_loc_count; ++i) {
+        result.push_back((loc_id + i) % m_loc_count);
+    }
+    const Row* origin = (loc_id < m_loc_count) ? representatives[loc_id] : nullptr;
+    if (origin == nullptr) {
+        return result;  // No topology information, so fall back to round-robin
+    }
+
+    auto distance = [&](size_t other_id) -> size_t {
+        const Row* other = representatives[other_id];
+        if (other == nullptr) return SIZE_MAX;
+        if (other->numa_domain_id == origin->numa_domain_id) return 0;
+        size_t numa_distance = (other->numa_domain_id > origin->numa_domain_id)
+                               ? other->numa_domain_id - origin->numa_domain_id
+                               : origin->numa_domain_id - other->numa_domain_id;
+        if (other->socket_id == origin->socket_id) return numa_distance;
+        return m_loc_count + numa_distance;
+    };
+    std::stable_sort(result.begin(), result.end(),
+                     [&](size_t lhs, size_t rhs) -> bool { return distance(lhs) < distance(rhs); });
+    return result;
+}
+
+
+std::vector<size_t> JProcessorMapping::get_cpu_ids(size_t loc_id) const {
+    std::vector<size_t> result;
+    if (!m_initialized) return result;
+    for (const Row& row : m_mapping) {
+        if (row.location_id == loc_id) {
+            result.push_back(row.cpu_id);
+        }
+    }
+    return result;
+}
+
+
 std::ostream& operator<<(std::ostream& os, const JProcessorMapping::AffinityStrategy& s) {
     switch (s) {
         case JProcessorMapping::AffinityStrategy::ComputeBound: os << "compute-bound (favor fewer hyperthreads)"; break;
@@ -30,6 +30,14 @@ public:
         return (m_initialized) ? m_mapping[worker_id % m_mapping.size()].location_id : 0;
     }
 
+    /// get_nearest_locations(loc_id) lists every other location, nearest first: locations sharing
+    /// loc_id's NUMA domain, then locations on the same socket (by NUMA domain distance), then the rest.
+    std::vector<size_t> get_nearest_locations(size_t loc_id) const;
+
+    /// get_cpu_ids(loc_id) lists the cpus belonging to location loc_id. This is empty if the mapping
+    /// couldn't be initialized, in which case there is no way to tell which cpus are local to what.
+    std::vector<size_t> get_cpu_ids(size_t loc_id) const;
+
     inline AffinityStrategy get_affinity() const {
         return m_affinity_strategy;
     }
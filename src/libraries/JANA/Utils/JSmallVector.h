@@ -0,0 +1,175 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+
+#ifndef JANA2_JSMALLVECTOR_H
+#define JANA2_JSMALLVECTOR_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <type_traits>
+
+/// JSmallVector is a vector which keeps its first N elements inside the object itself, and only goes to the heap
+/// once it grows beyond that. It is meant for the many small collections which live inside individual data objects,
+/// where a std::vector or std::set would cost an allocation (or one per element) and several pointers each even
+/// while empty. It only holds trivially copyable Ts, such as pointers, which it moves around with memcpy.
+template <typename T, size_t N>
+class JSmallVector {
+    static_assert(std::is_trivially_copyable<T>::value, "JSmallVector only holds trivially copyable types");
+    static_assert(N > 0, "JSmallVector needs room for at least one element inline");
+
+    T* m_data;
+    uint32_t m_size = 0;
+    uint32_t m_capacity = N;
+    T m_inline[N];
+
+    bool is_inline() const { return m_data == m_inline; }
+
+    void grow(size_t min_capacity) {
+        size_t capacity = 2 * static_cast<size_t>(m_capacity);
+        if (capacity < min_capacity) capacity = min_capacity;
+        T* data = static_cast<T*>(::operator new(capacity * sizeof(T)));
+        std::memcpy(data, m_data, m_size * sizeof(T));
+        if (!is_inline()) ::operator delete(m_data);
+        m_data = data;
+        m_capacity = static_cast<uint32_t>(capacity);
+    }
+
+    /// Called while we hold nothing on the heap. Leaves other empty.
+    void take(JSmallVector& other) {
+        if (other.is_inline()) {
+            std::memcpy(m_inline, other.m_inline, other.m_size * sizeof(T));
+        }
+        else {
+            m_data = other.m_data;
+            m_capacity = other.m_capacity;
+            other.m_data = other.m_inline;
+            other.m_capacity = N;
+        }
+        m_size = other.m_size;
+        other.m_size = 0;
+    }
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    JSmallVector() : m_data(m_inline) {}
+
+    JSmallVector(const JSmallVector& other) : m_data(m_inline) {
+        insert(end(), other.begin(), other.end());
+    }
+
+    JSmallVector(JSmallVector&& other) noexcept : m_data(m_inline) {
+        take(other);
+    }
+
+    JSmallVector& operator=(const JSmallVector& other) {
+        if (this != &other) {
+            clear();
+            insert(end(), other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    JSmallVector& operator=(JSmallVector&& other) noexcept {
+        if (this != &other) {
+            if (!is_inline()) ::operator delete(m_data);
+            m_data = m_inline;
+            m_capacity = N;
+            take(other);
+        }
+        return *this;
+    }
+
+    ~JSmallVector() {
+        if (!is_inline()) ::operator delete(m_data);
+    }
+
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_capacity; }
+    bool empty() const { return m_size == 0; }
+
+    T* data() { return m_data; }
+    const T* data() const { return m_data; }
+
+    iterator begin() { return m_data; }
+    iterator end() { return m_data + m_size; }
+    const_iterator begin() const { return m_data; }
+    const_iterator end() const { return m_data + m_size; }
+
+    T& operator[](size_t index) {
+        assert(index < m_size);
+        return m_data[index];
+    }
+    const T& operator[](size_t index) const {
+        assert(index < m_size);
+        return m_data[index];
+    }
+
+    void reserve(size_t capacity) {
+        if (capacity > m_capacity) grow(capacity);
+    }
+
+    void push_back(const T& item) {
+        if (m_size == m_capacity) {
+            T copy = item;  // item might live inside our own buffer
+            grow(m_size + 1);
+            m_data[m_size++] = copy;
+        }
+        else {
+            m_data[m_size++] = item;
+        }
+    }
+
+    iterator insert(const_iterator position, const T& item) {
+        size_t index = position - m_data;
+        assert(index <= m_size);
+        T copy = item;
+        if (m_size == m_capacity) grow(m_size + 1);
+        std::memmove(m_data + index + 1, m_data + index, (m_size - index) * sizeof(T));
+        m_data[index] = copy;
+        m_size++;
+        return m_data + index;
+    }
+
+    /// Inserts [first, last), which must not point into this JSmallVector
+    template <typename ForwardIterator>
+    iterator insert(const_iterator position, ForwardIterator first, ForwardIterator last) {
+        size_t index = position - m_data;
+        assert(index <= m_size);
+        size_t count = std::distance(first, last);
+        if (m_size + count > m_capacity) grow(m_size + count);
+        std::memmove(m_data + index + count, m_data + index, (m_size - index) * sizeof(T));
+        T* out = m_data + index;
+        for (; first != last; ++first) {
+            *out++ = *first;
+        }
+        m_size += count;
+        return m_data + index;
+    }
+
+    iterator erase(const_iterator position) {
+        return erase(position, position + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        size_t index = first - m_data;
+        size_t count = last - first;
+        assert(index + count <= m_size);
+        std::memmove(m_data + index, m_data + index + count, (m_size - index - count) * sizeof(T));
+        m_size -= count;
+        return m_data + index;
+    }
+
+    /// clear() keeps whatever heap buffer has been allocated, so that the JSmallVector can be refilled for free
+    void clear() { m_size = 0; }
+};
+
+
+#endif //JANA2_JSMALLVECTOR_H
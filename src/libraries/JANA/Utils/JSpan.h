@@ -0,0 +1,40 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+
+#ifndef JANA2_JSPAN_H
+#define JANA2_JSPAN_H
+
+#include <cassert>
+#include <cstddef>
+
+/// JSpan is a non-owning view of a contiguous range of Ts, along the lines of C++20's std::span.
+/// It is what JANA hands out when it wants to give access to data without copying it into a new container.
+/// A JSpan is only valid for as long as the data it views, which usually means until the event is recycled.
+template <typename T>
+class JSpan {
+    T* m_data = nullptr;
+    size_t m_size = 0;
+
+public:
+    using value_type = T;
+    using iterator = T*;
+
+    JSpan() = default;
+    JSpan(T* data, size_t size) : m_data(data), m_size(size) {}
+
+    T* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    T* begin() const { return m_data; }
+    T* end() const { return m_data + m_size; }
+
+    T& operator[](size_t index) const {
+        assert(index < m_size);
+        return m_data[index];
+    }
+};
+
+
+#endif //JANA2_JSPAN_H
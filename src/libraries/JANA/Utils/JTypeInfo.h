@@ -25,6 +25,14 @@ std::string demangle(void) {
     return type;
 }
 
+/// Same as demangle(), except that the name is only computed once per type and then handed out by reference,
+/// so that it can be used on hot paths without running the demangler or allocating.
+template<typename T>
+const std::string& demangle_cached(void) {
+    static const std::string type = demangle<T>();
+    return type;
+}
+
 
 /// Macro for conveniently turning a variable name into a string. This is used by JObject::Summarize
 /// in order to play nicely with refactoring tools. Because the symbol is picked up by the
@@ -96,11 +96,15 @@ public:
     size_t get_event_number() const override { return as_indra_message()->record_counter; }
     size_t get_run_number() const override { return 1; }
     bool is_end_of_stream() const override { return as_indra_message()->flags == 1; }
-    char *as_buffer() override { return m_buffer; }
-    const char *as_buffer() const override { return m_buffer; }
-    size_t get_buffer_capacity() const override { return m_buffer_capacity; }
+    char *as_buffer() override { return data(); }
+    const char *as_buffer() const override { return data(); }
+    size_t get_buffer_capacity() const override { return m_transport_buffer.is_held() ? m_transport_buffer.size : m_buffer_capacity; }
     size_t get_buffer_size() const override { return sizeof(INDRAMessage) + as_indra_message()->payload_bytes; }
 
+    /// Lets ZmqTransport receive straight into ZeroMQ's own buffer. While that is held, everything below
+    /// views it instead of m_buffer, so the payload never needs to be copied.
+    JTransportBuffer* get_transport_buffer() override { return &m_transport_buffer; }
+
     ////////////////////////////////////////////////////////////////////////////////////////
     /// The following setters are NOT required by JStreamingEventSource, but useful for writing producers.
     /// It is always advisable to put the code for the setters close to the code for the getters.
@@ -124,26 +128,26 @@ public:
     /// region of the buffer as a char*, and converts the sizes (measured in counts of uint32_t) to and from bytes.
 
     /// Grants read/write access to any INDRAMessage members directly
-    INDRAMessage *as_indra_message() { return reinterpret_cast<INDRAMessage *>(m_buffer); }
-    const INDRAMessage *as_indra_message() const { return reinterpret_cast<INDRAMessage *>(m_buffer); }
+    INDRAMessage *as_indra_message() { return reinterpret_cast<INDRAMessage *>(data()); }
+    const INDRAMessage *as_indra_message() const { return reinterpret_cast<const INDRAMessage *>(data()); }
 
     /// Grants read-only access to the message payload as a byte array, which we need because INDRAMessage uses uint32_t instead
     void as_payload(const char **payload, size_t *payload_bytes) const {
 
-        *payload = m_buffer + sizeof(INDRAMessage);
+        *payload = data() + sizeof(INDRAMessage);
         *payload_bytes = as_indra_message()->payload_bytes;
     }
     void as_payload(char **payload, size_t *payload_bytes, size_t *payload_capacity) {
 
-        *payload = m_buffer + sizeof(INDRAMessage);
+        *payload = data() + sizeof(INDRAMessage);
         *payload_bytes = as_indra_message()->payload_bytes;
-        *payload_capacity = m_buffer_capacity - sizeof(INDRAMessage);
+        *payload_capacity = get_buffer_capacity() - sizeof(INDRAMessage);
     }
 
     /// Sets a payload size, measured in bytes
     void set_payload_size(uint32_t payload_bytes) {
 
-        if (payload_bytes > m_buffer_capacity) {
+        if (payload_bytes > get_buffer_capacity()) {
             throw JException("set_payload_size: desired size exceeds buffer capacity!");
         }
         as_indra_message()->payload_bytes = payload_bytes;
@@ -157,9 +161,13 @@ public:
 
 private:
 
+    char *data() { return m_transport_buffer.is_held() ? m_transport_buffer.data : m_buffer; }
+    const char *data() const { return m_transport_buffer.is_held() ? m_transport_buffer.data : m_buffer; }
+
     size_t m_sample_count{};
     size_t m_channel_count{};
     char *m_buffer;
+    JTransportBuffer m_transport_buffer;
     size_t m_buffer_capacity{};
     size_t m_print_freq{};
     std::string m_sub_socket{};
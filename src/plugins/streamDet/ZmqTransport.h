@@ -71,10 +71,38 @@ public:
 
     JTransport::Result receive(JMessage& dest_msg) override {
 
+        auto transport_buffer = dest_msg.get_transport_buffer();
+        if (transport_buffer != nullptr) {
+            return receive_zero_copy(dest_msg, *transport_buffer);
+        }
         int rc_length = zmq_recv(m_socket, dest_msg.as_buffer(), dest_msg.get_buffer_capacity(), ZMQ_DONTWAIT);
         if (rc_length == -1) {
             return JTransport::Result::TRY_AGAIN;
         }
+        return check_end_of_stream(dest_msg);
+    }
+
+    /// receive_zero_copy() receives into a zmq_msg_t which lives inside dest_msg until dest_msg is recycled,
+    /// so that the payload never gets copied out of the buffer ZeroMQ allocated for it.
+    JTransport::Result receive_zero_copy(JMessage& dest_msg, JTransportBuffer& buffer) {
+
+        static_assert(sizeof(zmq_msg_t) <= sizeof(buffer.handle), "zmq_msg_t doesn't fit into a JTransportBuffer");
+        buffer.release();
+        auto msg = reinterpret_cast<zmq_msg_t*>(buffer.handle);
+        zmq_msg_init(msg);
+        if (zmq_msg_recv(msg, m_socket, ZMQ_DONTWAIT) == -1) {
+            zmq_msg_close(msg);
+            return JTransport::Result::TRY_AGAIN;
+        }
+        buffer.data = static_cast<char*>(zmq_msg_data(msg));
+        buffer.size = zmq_msg_size(msg);
+        buffer.release_fn = [](JTransportBuffer& b) { zmq_msg_close(reinterpret_cast<zmq_msg_t*>(b.handle)); };
+        return check_end_of_stream(dest_msg);
+    }
+
+private:
+
+    JTransport::Result check_end_of_stream(JMessage& dest_msg) {
         if (dest_msg.is_end_of_stream()) {
             zmq_close(m_socket);
             m_socket = nullptr;
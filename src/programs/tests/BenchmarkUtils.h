@@ -0,0 +1,24 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef JANA2_BENCHMARKUTILS_H
+#define JANA2_BENCHMARKUTILS_H
+
+#include <chrono>
+#include <cstddef>
+
+/// Shared timing scaffolding for the hidden [.][performance] benchmarks.
+/// ns_per_iteration() runs body `iterations` times and returns the average wall-clock time per call. Have the body
+/// accumulate something which gets checked afterwards, so that the compiler can't optimize the work away.
+
+template <typename F>
+double ns_per_iteration(size_t iterations, F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i=0; i<iterations; ++i) {
+        body();
+    }
+    auto duration = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(duration).count() / iterations;
+}
+
+#endif // JANA2_BENCHMARKUTILS_H
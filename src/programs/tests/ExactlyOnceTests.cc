@@ -48,7 +48,28 @@ TEST_CASE("ExactlyOnceTests") {
         REQUIRE(processor->init_count == 1);
         REQUIRE(processor->finish_count == 1);
     }
-}
 
+    SECTION("New engine: Batched event processing sees every event exactly once") {
+
+        source->event_limit = 100;
+        app.SetParameterValue("jana:legacy_mode", 0);
+        app.SetParameterValue("jana:event_processor_chunksize", 8);
+        app.Run(true);
+
+        REQUIRE(processor->process_count == 99);
+        REQUIRE(processor->finish_count == 1);
+    }
 
+    SECTION("New engine: Several sources ingest concurrently, each exactly once") {
 
+        auto other_source = new SimpleSource("OtherSource", &app);
+        app.Add(other_source);
+        app.SetParameterValue("jana:legacy_mode", 0);
+        app.SetParameterValue("nthreads", 2);
+        app.Run(true);
+
+        REQUIRE(source->open_count == 1);
+        REQUIRE(other_source->open_count == 1);
+        REQUIRE(processor->process_count == 8);
+    }
+}
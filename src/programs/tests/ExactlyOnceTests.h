@@ -14,6 +14,7 @@ struct SimpleSource : public JEventSource {
 
     std::atomic_int open_count {0};
     std::atomic_int event_count {0};
+    int event_limit = 5;
 
     SimpleSource(std::string source_name, JApplication *app) : JEventSource(source_name, app)
     { }
@@ -31,7 +32,7 @@ struct SimpleSource : public JEventSource {
     }
 
     void GetEvent(std::shared_ptr<JEvent>) override {
-        if (++event_count == 5) {
+        if (++event_count == event_limit) {
             throw JEventSource::RETURN_STATUS::kNO_MORE_EVENTS;
         }
     }
@@ -42,6 +43,7 @@ struct SimpleProcessor : public JEventProcessor {
 
     std::atomic_int init_count {0};
     std::atomic_int finish_count {0};
+    std::atomic_int process_count {0};
 
     SimpleProcessor(JApplication* app) : JEventProcessor(app) {}
 
@@ -50,6 +52,7 @@ struct SimpleProcessor : public JEventProcessor {
     }
 
     void Process(const std::shared_ptr<const JEvent>&) override {
+        process_count += 1;
     }
 
     void Finish() override {
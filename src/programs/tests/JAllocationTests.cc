@@ -0,0 +1,97 @@
+// Copyright 2022, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+// These tests replace the global operator new so that they can count allocations, which is why they
+// live in their own executable, janaallocationtests, instead of janatests.
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+#include "BenchmarkUtils.h"
+#include "JCallGraphRecorderTests.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+
+/// Counts every operator new made by the current thread, so that tests can check that hot paths don't allocate
+static thread_local size_t t_allocation_count = 0;
+
+void* operator new(std::size_t size) {
+    ++t_allocation_count;
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+// std::stable_sort gets its temporary buffer from this one, and frees it with the replaced operator delete below
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    ++t_allocation_count;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+TEST_CASE("Getters don't allocate when call graph recording is disabled") {
+    JApplication app;
+    JFactorySet* factories = new JFactorySet;
+    factories->Add(new FacA());
+    factories->Add(new FacB());
+    factories->Add(new FacC());
+    factories->Add(new FacD());
+    factories->Add(new FacLong());
+    auto event = std::make_shared<JEvent>(&app);
+    event->SetFactorySet(factories);
+    REQUIRE(event->GetJCallGraphRecorder()->IsEnabled() == false);
+
+    // The first call runs the factories and caches each type's demangled name
+    event->GetIterators<ObjWithAnUnmistakablyLongName>();
+    event->GetSingle<ObjB>("WeirdBTag");
+
+    std::string tag = "WeirdBTag";
+    size_t allocations_before = t_allocation_count;
+    for (int i=0; i<100; ++i) {
+        event->GetIterators<ObjWithAnUnmistakablyLongName>();
+        event->GetSingle<ObjB>(tag);
+        event->GetSingle<ObjC>();
+    }
+    REQUIRE(t_allocation_count - allocations_before == 0);
+    REQUIRE(event->GetJCallGraphRecorder()->GetCallGraph().empty());
+}
+
+
+TEST_CASE("CallGraphRecordingBenchmark", "[.][performance]") {
+    JApplication app;
+    JFactorySet* factories = new JFactorySet;
+    factories->Add(new FacA());
+    factories->Add(new FacB());
+    factories->Add(new FacC());
+    factories->Add(new FacD());
+    factories->Add(new FacLong());
+    auto event = std::make_shared<JEvent>(&app);
+    event->SetFactorySet(factories);
+    event->GetIterators<ObjWithAnUnmistakablyLongName>();
+
+    const size_t iterations = 10000000;
+    for (bool enabled : {false, true}) {
+        event->GetJCallGraphRecorder()->SetEnabled(enabled);
+        size_t allocations_before = t_allocation_count;
+        size_t empty_count = 0;  // FacLong never inserts anything
+        auto ns = ns_per_iteration(iterations, [&]{
+            auto its = event->GetIterators<ObjWithAnUnmistakablyLongName>();
+            if (its.first == its.second) empty_count++;
+        });
+        event->GetJCallGraphRecorder()->Reset();
+        REQUIRE(empty_count == iterations);
+
+        std::cout << "GetIterators<T>() with call graph recording " << (enabled ? "enabled:  " : "disabled: ")
+                  << ns << " ns, "
+                  << double(t_allocation_count - allocations_before) / iterations << " allocations per call" << std::endl;
+    }
+}
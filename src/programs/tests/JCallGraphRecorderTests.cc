@@ -5,6 +5,7 @@
 #include <catch.hpp>
 #include <JANA/Utils/JCallGraphRecorder.h>
 #include "JANA/JEvent.h"
+#include "JCallGraphRecorderTests.h"
 
 TEST_CASE("Test topological sort algorithm in isolation") {
 
@@ -34,38 +35,6 @@ TEST_CASE("Test topological sort algorithm in isolation") {
 }
 
 
-struct ObjA {};
-struct ObjB {};
-struct ObjC {};
-struct ObjD {};
-
-struct FacA: public JFactoryT<ObjA> {
-    void Process(const std::shared_ptr<const JEvent>&) override {
-    }
-};
-
-struct FacB: public JFactoryT<ObjB> {
-    FacB() {
-        SetTag("WeirdBTag");
-    }
-    void Process(const std::shared_ptr<const JEvent>& event) override {
-        event->Get<ObjA>();
-    }
-};
-
-struct FacC: public JFactoryT<ObjC> {
-    void Process(const std::shared_ptr<const JEvent>&) override {
-    }
-};
-
-struct FacD: public JFactoryT<ObjD> {
-    void Process(const std::shared_ptr<const JEvent>& event) override {
-        event->Get<ObjB>("WeirdBTag");
-        event->Get<ObjC>();
-    }
-};
-
-
 TEST_CASE("Test topological sort algorithm using actual Factories") {
     JApplication app;
     JFactorySet* factories = new JFactorySet;
@@ -85,4 +54,3 @@ TEST_CASE("Test topological sort algorithm using actual Factories") {
     REQUIRE(result[2].second == "WeirdBTag");
     REQUIRE(result[3].first == "ObjD");
 }
-
@@ -0,0 +1,52 @@
+// Copyright 2022, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef JANA2_JCALLGRAPHRECORDERTESTS_H
+#define JANA2_JCALLGRAPHRECORDERTESTS_H
+
+#include <JANA/JEvent.h>
+#include <JANA/JFactoryT.h>
+
+/// A small web of factories: D depends on B and C, and B depends on A.
+struct ObjA {};
+struct ObjB {};
+struct ObjC {};
+struct ObjD {};
+
+struct FacA: public JFactoryT<ObjA> {
+    void Process(const std::shared_ptr<const JEvent>&) override {
+    }
+};
+
+struct FacB: public JFactoryT<ObjB> {
+    FacB() {
+        SetTag("WeirdBTag");
+    }
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        event->Get<ObjA>();
+    }
+};
+
+struct FacC: public JFactoryT<ObjC> {
+    void Process(const std::shared_ptr<const JEvent>&) override {
+    }
+};
+
+struct FacD: public JFactoryT<ObjD> {
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        event->Get<ObjB>("WeirdBTag");
+        event->Get<ObjC>();
+    }
+};
+
+/// Long enough that its name can't fit in std::string's small buffer
+struct ObjWithAnUnmistakablyLongName {};
+
+struct FacLong: public JFactoryT<ObjWithAnUnmistakablyLongName> {
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        event->Get<ObjD>();
+    }
+};
+
+
+#endif //JANA2_JCALLGRAPHRECORDERTESTS_H
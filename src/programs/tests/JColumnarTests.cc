@@ -0,0 +1,181 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+
+#include "catch.hpp"
+#include "BenchmarkUtils.h"
+#include "ExactlyOnceTests.h"
+
+#include <JANA/JApplication.h>
+#include <JANA/JColumnarFactoryT.h>
+#include <JANA/JCsvWriter.h>
+#include <JANA/JEvent.h>
+#include <JANA/JFactoryGenerator.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+
+struct ColumnarHits : public JColumnar {
+    JColumn<int> cell {this, "cell", "%d"};
+    JColumn<float> energy {this, "energy", "%f", "GeV"};
+};
+
+struct ColumnarHitFactory : public JColumnarFactoryT<ColumnarHits> {
+    size_t hit_count = 3;
+    bool make_ragged = false;
+
+    void ProcessColumns(const std::shared_ptr<const JEvent>& event, ColumnarHits& hits) override {
+        for (size_t i=0; i<hit_count; ++i) {
+            hits.cell.push_back(i);
+            hits.energy.push_back(event->GetEventNumber() + 0.5f * i);
+        }
+        if (make_ragged) hits.cell.push_back(99);
+    }
+};
+
+TEST_CASE("JColumnarTests") {
+
+    auto event = std::make_shared<JEvent>();
+    auto factory = new ColumnarHitFactory;
+    event->SetFactorySet(new JFactorySet);
+    event->GetFactorySet()->Add(factory);
+    event->SetEventNumber(10);
+
+    SECTION("Columns register themselves in declaration order") {
+        ColumnarHits hits;
+        REQUIRE(hits.GetColumns().size() == 2);
+        REQUIRE(hits.GetColumns()[0]->GetName() == "cell");
+        REQUIRE(hits.GetColumns()[1]->GetDescription() == "GeV");
+        REQUIRE(hits.Size() == 0);
+    }
+
+    SECTION("JEvent hands out the whole collection, or single columns as spans") {
+        auto& hits = event->GetColumns<ColumnarHits>();
+        REQUIRE(hits.Size() == 3);
+        REQUIRE(hits.energy[2] == 11.0f);
+
+        auto energies = event->GetColumn(&ColumnarHits::energy);
+        REQUIRE(energies.size() == 3);
+        REQUIRE(energies.data() == hits.energy.data());
+        float total = 0;
+        for (float e : energies) total += e;
+        REQUIRE(total == 31.5f);
+
+        // The factory only runs once per event
+        REQUIRE(&event->GetColumns<ColumnarHits>() == &hits);
+        REQUIRE(event->Get<ColumnarHits>().size() == 1);
+    }
+
+    SECTION("Columns are cleared between events, but keep their capacity") {
+        factory->hit_count = 100;
+        auto data = event->GetColumn(&ColumnarHits::cell).data();
+        event->GetFactorySet()->Release();
+
+        factory->hit_count = 50;
+        auto cells = event->GetColumn(&ColumnarHits::cell);
+        REQUIRE(cells.size() == 50);
+        REQUIRE(cells.data() == data);
+    }
+
+    SECTION("Columns with different lengths are rejected") {
+        factory->make_ragged = true;
+        REQUIRE_THROWS_AS(event->GetColumns<ColumnarHits>(), JException);
+    }
+
+    SECTION("JObject-based tools see lazily created row views") {
+        REQUIRE(factory->GetAs<JObject>().empty());  // Nothing has been produced yet
+
+        event->GetColumns<ColumnarHits>();
+        auto rows = factory->GetAs<JObject>();
+        REQUIRE(rows.size() == 3);
+        REQUIRE(rows[1]->className() == "ColumnarHits");
+
+        JObjectSummary summary;
+        rows[1]->Summarize(summary);
+        auto fields = summary.get_fields();
+        REQUIRE(fields.size() == 2);
+        REQUIRE(fields[0].name == "cell");
+        REQUIRE(fields[0].value == "1");
+        REQUIRE(fields[1].name == "energy");
+        REQUIRE(fields[1].type == "float");
+        REQUIRE(fields[1].value == "10.500000");
+
+        // Asking again doesn't rebuild the views
+        REQUIRE(factory->GetAs<JObject>()[1] == rows[1]);
+
+        event->GetFactorySet()->Release();
+        REQUIRE(factory->GetAs<JObject>().empty());
+    }
+}
+
+
+TEST_CASE("JCsvWriter writes columnar collections row by row") {
+
+    JApplication app;
+    auto source = new SimpleSource("SimpleSource", &app);
+    source->event_limit = 3;
+    app.Add(source);
+    app.Add(new JFactoryGeneratorT<ColumnarHitFactory>());
+    app.Add(new JCsvWriter<ColumnarHits>());
+    app.SetParameterValue("csv:dest_dir", std::string("."));
+    app.SetParameterValue("jana:extended_report", 0);
+    app.SetParameterValue("jana:nthreads", 1);
+    app.Run(true);
+
+    std::ifstream file("./ColumnarHits.csv");
+    std::string line;
+    std::vector<std::string> lines;
+    while (std::getline(file, line)) lines.push_back(line);
+    std::remove("./ColumnarHits.csv");
+
+    REQUIRE(lines.size() == 1 + 2 * 3);  // Header, then two events with three hits each
+    REQUIRE(lines[0] == "EventNr, cell, energy");
+}
+
+
+/// AosHit is the same hit as ColumnarHits, but as an individually allocated JObject
+struct AosHit : public JObject {
+    int cell;
+    float energy;
+    AosHit(int cell, float energy) : cell(cell), energy(energy) {}
+};
+
+TEST_CASE("ColumnarClusteringBenchmark", "[.][performance]") {
+
+    const size_t hit_count = 100000;
+    const size_t cell_count = 64;
+    const size_t repetitions = 200;
+
+    JFactoryT<AosHit> aos_factory;
+    ColumnarHits soa;
+    for (size_t i=0; i<hit_count; ++i) {
+        int cell = (i * 7919) % cell_count;
+        float energy = 0.001f * (i % 1000);
+        aos_factory.Insert(new AosHit(cell, energy));
+        soa.cell.push_back(cell);
+        soa.energy.push_back(energy);
+    }
+    auto aos = aos_factory.GetOrCreate(nullptr, nullptr, 0);
+
+    // "Clustering": sum up the energy above threshold in each cell
+    std::vector<float> aos_sums(cell_count), soa_sums(cell_count);
+    auto aos_ns = ns_per_iteration(repetitions, [&]{
+        for (auto it = aos.first; it != aos.second; ++it) {
+            const AosHit* hit = *it;
+            aos_sums[hit->cell] += (hit->energy > 0.1f) ? hit->energy : 0.0f;
+        }
+    });
+    auto soa_ns = ns_per_iteration(repetitions, [&]{
+        auto cells = soa.cell.Span();
+        auto energies = soa.energy.Span();
+        for (size_t i=0; i<cells.size(); ++i) {
+            soa_sums[cells[i]] += (energies[i] > 0.1f) ? energies[i] : 0.0f;
+        }
+    });
+
+    REQUIRE(aos_sums == soa_sums);
+    std::cout << "Clustering " << hit_count << " hits: AoS pointers " << aos_ns / 1000 << " us, SoA columns "
+              << soa_ns / 1000 << " us" << std::endl;
+}
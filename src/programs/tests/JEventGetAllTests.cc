@@ -187,3 +187,88 @@ TEST_CASE("JEventGetAllChildren") {
     }
 
 }
+
+struct SpanHit : public JObject {
+    int value;
+    explicit SpanHit(int value) : value(value) {}
+};
+
+class SpanHitFactory : public JFactoryT<SpanHit> {
+public:
+    int base;
+    size_t count;
+    size_t process_count = 0;
+    SpanHitFactory(const std::string& tag, int base, size_t count) : base(base), count(count) {
+        SetTag(tag);
+    }
+    void Process(const std::shared_ptr<const JEvent>&) override {
+        process_count++;
+        for (size_t i=0; i<count; ++i) {
+            Insert(new SpanHit(base + i));
+        }
+    }
+};
+
+TEST_CASE("JEventGetSpan") {
+
+    auto event = std::make_shared<JEvent>();
+    event->SetFactorySet(new JFactorySet);
+    auto untagged = new SpanHitFactory("", 0, 2);
+    auto empty = new SpanHitFactory("empty", 100, 0);
+    auto tagged = new SpanHitFactory("tagged", 10, 3);
+    event->GetFactorySet()->Add(untagged);
+    event->GetFactorySet()->Add(empty);
+    event->GetFactorySet()->Add(tagged);
+
+    SECTION("GetSpan views the factory's own storage") {
+        auto hits = event->GetSpan<SpanHit>("tagged");
+        REQUIRE(hits.size() == 3);
+        REQUIRE(hits[2]->value == 12);
+        REQUIRE(hits.data() == &*tagged->GetOrCreate(event, nullptr, 0).first);
+        REQUIRE(tagged->process_count == 1);
+
+        // The vector-returning getters are copies of the same thing
+        auto copy = event->Get<SpanHit>("tagged");
+        REQUIRE(std::vector<const SpanHit*>(hits.begin(), hits.end()) == copy);
+        REQUIRE(tagged->process_count == 1);
+        REQUIRE(event->GetSpan<SpanHit>("empty").empty());
+        REQUIRE_THROWS_AS(event->GetSpan<SpanHit>("missing"), JException);
+    }
+
+    SECTION("GetAll returns the objects of every tag") {
+        auto all = event->GetAll<SpanHit>();
+        REQUIRE(all.size() == 5);
+        std::vector<int> values;
+        for (auto hit : all) values.push_back(hit->value);
+        REQUIRE(values == std::vector<int>{0, 1, 10, 11, 12});
+
+        std::vector<const SpanHit*> destination;
+        event->GetAll(destination);
+        REQUIRE(destination == all);
+    }
+
+    SECTION("GetAllSpan walks every factory without copying, skipping the empty ones") {
+        auto all = event->GetAllSpan<SpanHit>();
+        REQUIRE(all.size() == 5);
+        REQUIRE(!all.empty());
+        std::vector<int> values;
+        for (auto hit : all) values.push_back(hit->value);
+        REQUIRE(values == std::vector<int>{0, 1, 10, 11, 12});
+        REQUIRE(*all.begin() == event->GetSpan<SpanHit>()[0]);
+        REQUIRE(untagged->process_count == 1);
+        REQUIRE(empty->process_count == 1);
+        REQUIRE(tagged->process_count == 1);
+
+        untagged->count = 0;
+        tagged->count = 0;
+        event->GetFactorySet()->Release();
+        auto none = event->GetAllSpan<SpanHit>();
+        REQUIRE(none.empty());
+        REQUIRE(none.size() == 0);
+        REQUIRE(none.begin() == none.end());
+    }
+
+    SECTION("GetAllSpan throws when there are no factories at all") {
+        REQUIRE_THROWS_AS(event->GetAllSpan<Base>(), JException);
+    }
+}
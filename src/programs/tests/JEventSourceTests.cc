@@ -0,0 +1,701 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include "catch.hpp"
+#include "BenchmarkUtils.h"
+
+#include <JANA/JApplication.h>
+#include <JANA/JEventProcessor.h>
+#include <JANA/JEventSource.h>
+#include <JANA/Engine/JEventSourceArrow.h>
+#include <JANA/Streaming/JStreamingEventSource.h>
+#include <JANA/Utils/JEventPool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <thread>
+#include <vector>
+
+
+/// Pretends to read events from a random-access file, where each thread has a file handle of its own
+struct ConcurrentFileSource : public JEventSource {
+
+    struct FileHandle : public ReaderState {
+        std::atomic_bool in_use {false};
+        size_t reads = 0;
+    };
+
+    uint64_t event_bound;
+    std::chrono::microseconds read_latency;
+    std::atomic<uint64_t> next_event_nr {0};
+    std::atomic_int concurrent_reads {0};
+    std::atomic_int max_concurrent_reads {0};
+    std::atomic_int reader_count {0};
+    std::atomic_bool reader_shared {false};
+    std::once_flag first_read;
+    std::chrono::steady_clock::time_point first_read_start;
+    std::atomic<std::chrono::steady_clock::time_point> last_read_end;
+
+    ConcurrentFileSource(JApplication* app, uint64_t event_bound, bool concurrent, std::chrono::microseconds read_latency = {})
+        : JEventSource("ConcurrentFileSource", app), event_bound(event_bound), read_latency(read_latency) {
+        if (concurrent) EnableConcurrentGetEvent();
+    }
+
+    std::unique_ptr<ReaderState> CreateReaderState() override {
+        reader_count++;
+        return std::unique_ptr<ReaderState>(new FileHandle);
+    }
+
+    ReturnStatus TryGetEvent(std::shared_ptr<JEvent> event) override {
+        FileHandle handle;
+        return GetEventWithReader(std::move(event), handle);
+    }
+
+    ReturnStatus GetEventWithReader(std::shared_ptr<JEvent> event, ReaderState& reader) override {
+        auto& handle = static_cast<FileHandle&>(reader);
+        if (handle.in_use.exchange(true)) reader_shared = true;
+        std::call_once(first_read, [&]() { first_read_start = std::chrono::steady_clock::now(); });
+        int concurrent = ++concurrent_reads;
+        int max = max_concurrent_reads;
+        while (concurrent > max && !max_concurrent_reads.compare_exchange_weak(max, concurrent)) {}
+
+        auto event_nr = next_event_nr++;
+        if (event_nr >= event_bound) {
+            concurrent_reads--;
+            handle.in_use = false;
+            return ReturnStatus::Finished;
+        }
+        if (read_latency.count() != 0) {
+            std::this_thread::sleep_for(read_latency);  // Waiting on the disk, not the CPU
+        }
+        else {
+            std::this_thread::yield();  // Give the other threads a chance to overlap with us
+        }
+        event->SetEventNumber(event_nr);
+        last_read_end = std::chrono::steady_clock::now();
+        handle.reads++;
+        concurrent_reads--;
+        handle.in_use = false;
+        return ReturnStatus::Success;
+    }
+};
+
+struct EventNumberProcessor : public JEventProcessor {
+    std::mutex mutex;
+    std::multiset<uint64_t> event_numbers;
+
+    explicit EventNumberProcessor(JApplication* app) : JEventProcessor(app) {}
+
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        event_numbers.insert(event->GetEventNumber());
+    }
+};
+
+
+TEST_CASE("JEventSourceConcurrentGetEvent") {
+
+    SECTION("DoNext() respects nskip and nevents exactly when called from several threads at once") {
+        ConcurrentFileSource source(nullptr, 1000, true);
+        source.SetRange(10, 500);
+
+        std::atomic_int success_count {0};
+        std::atomic_int finished_count {0};
+        std::vector<std::thread> threads;
+        for (int t=0; t<4; ++t) {
+            threads.emplace_back([&]() {
+                auto event = std::make_shared<JEvent>();
+                while (true) {
+                    auto status = source.DoNext(event);
+                    if (status == JEventSource::ReturnStatus::Success) success_count++;
+                    if (status == JEventSource::ReturnStatus::Finished) break;
+                }
+                finished_count++;
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        REQUIRE(success_count == 500);
+        REQUIRE(finished_count == 4);
+        REQUIRE(source.GetEventCount() == 510);
+        REQUIRE(source.next_event_nr == 510);
+        REQUIRE(source.GetStatus() == JEventSource::SourceStatus::Finished);
+        REQUIRE(!source.reader_shared);
+        REQUIRE(source.reader_count >= 1);
+        REQUIRE(source.reader_count <= 4);
+    }
+
+    SECTION("DoNext() finishes when the source runs dry before nevents") {
+        ConcurrentFileSource source(nullptr, 100, true);
+        source.SetRange(0, 500);
+        auto event = std::make_shared<JEvent>();
+        size_t success_count = 0;
+        while (source.DoNext(event) == JEventSource::ReturnStatus::Success) success_count++;
+        REQUIRE(success_count == 100);
+        REQUIRE(source.GetEventCount() == 100);
+        REQUIRE(source.DoNext(event) == JEventSource::ReturnStatus::Finished);
+    }
+
+    SECTION("Only concurrent sources get a parallel source arrow") {
+        ConcurrentFileSource sequential_source(nullptr, 1, false);
+        ConcurrentFileSource concurrent_source(nullptr, 1, true);
+        EventQueue sequential_queue;
+        EventQueue concurrent_queue;
+        JEventSourceArrow sequential_arrow("sequential", &sequential_source, &sequential_queue, nullptr);
+        JEventSourceArrow concurrent_arrow("concurrent", &concurrent_source, &concurrent_queue, nullptr);
+        REQUIRE(!sequential_arrow.is_parallel());
+        REQUIRE(concurrent_arrow.is_parallel());
+    }
+
+    SECTION("A concurrent source emits every event exactly once") {
+        JApplication app;
+        app.SetParameterValue("nthreads", 4);
+        app.SetParameterValue("jana:nskip", 5);
+        app.SetParameterValue("jana:nevents", 200);
+        app.SetParameterValue("jana:event_source_chunksize", 3);
+        app.SetParameterValue("jana:extended_report", 0);
+        auto source = new ConcurrentFileSource(&app, 1000, true, std::chrono::microseconds(50));
+        auto processor = new EventNumberProcessor(&app);
+        app.Add(source);
+        app.Add(processor);
+        app.Run(true);
+
+        REQUIRE(processor->event_numbers.size() == 200);
+        REQUIRE(std::set<uint64_t>(processor->event_numbers.begin(), processor->event_numbers.end()).size() == 200);
+        // nskip drops whichever 5 events finish reading first, which aren't necessarily the first 5 numbers
+        REQUIRE(*processor->event_numbers.rbegin() < 205);
+        REQUIRE(source->GetEventCount() == 205);
+        REQUIRE(!source->reader_shared);
+    }
+}
+
+TEST_CASE("ConcurrentSourceBenchmark", "[.][performance]") {
+
+    const uint64_t event_count = 4000;
+    for (bool concurrent : {false, true}) {
+        JApplication app;
+        app.SetParameterValue("nthreads", 8);
+        app.SetParameterValue("jana:extended_report", 0);
+        app.SetParameterValue("jana:event_source_chunksize", 4);
+        app.SetParameterValue("jana:event_pool_size", 32);  // Room for every worker to be reading a whole chunk
+        auto source = new ConcurrentFileSource(&app, event_count, concurrent, std::chrono::microseconds(200));
+        app.Add(source);
+        app.Add(new EventNumberProcessor(&app));
+
+        app.Run(true);
+        // Measured by the source itself, because the run loop only notices that we are done at its next tick
+        auto seconds = std::chrono::duration<double>(source->last_read_end.load() - source->first_read_start).count();
+        std::cout << (concurrent ? "Concurrent" : "Sequential") << " source, 200 us reads, 8 threads: "
+                  << event_count / seconds << " events/s, at most " << source->max_concurrent_reads
+                  << " reads at once" << std::endl;
+    }
+}
+
+
+/// Emits `bound` events, but only every `period`th poll finds one. Signals this the old way, by throwing.
+struct ThrowingPollingSource : public JEventSource {
+    size_t period, bound, poll_count = 0, event_count = 0;
+    ThrowingPollingSource(size_t period, size_t bound) : JEventSource("ThrowingPollingSource"), period(period), bound(bound) {}
+
+    void GetEvent(std::shared_ptr<JEvent>) override {
+        if (event_count == bound) throw RETURN_STATUS::kNO_MORE_EVENTS;
+        if (++poll_count % period != 0) throw RETURN_STATUS::kTRY_AGAIN;
+        event_count++;
+    }
+};
+
+/// Same as ThrowingPollingSource, but returns its status instead
+struct ReturningPollingSource : public JEventSource {
+    size_t period, bound, poll_count = 0, event_count = 0;
+    ReturningPollingSource(size_t period, size_t bound) : JEventSource("ReturningPollingSource"), period(period), bound(bound) {}
+
+    ReturnStatus TryGetEvent(std::shared_ptr<JEvent>) override {
+        if (event_count == bound) return ReturnStatus::Finished;
+        if (++poll_count % period != 0) return ReturnStatus::TryAgain;
+        event_count++;
+        return ReturnStatus::Success;
+    }
+};
+
+struct ErrorSource : public JEventSource {
+    ErrorSource() : JEventSource("ErrorSource") {}
+    void GetEvent(std::shared_ptr<JEvent>) override { throw RETURN_STATUS::kERROR; }
+};
+
+struct PollMessage : public JEventMessage {
+    size_t event_number = 0;
+    explicit PollMessage(JApplication*) {}
+    char* as_buffer() override { return reinterpret_cast<char*>(&event_number); }
+    const char* as_buffer() const override { return reinterpret_cast<const char*>(&event_number); }
+    size_t get_buffer_capacity() const override { return sizeof(event_number); }
+    bool is_end_of_stream() const override { return false; }
+    size_t get_event_number() const override { return event_number; }
+    size_t get_run_number() const override { return 0; }
+    friend std::ostream& operator<<(std::ostream& os, const PollMessage& msg) { return os << "PollMessage " << msg.event_number; }
+};
+
+/// A socket which has a message waiting on every `period`th receive(), like a ZMQ socket polled with ZMQ_DONTWAIT
+struct PollingTransport : public JTransport {
+    size_t period, bound, poll_count = 0, message_count = 0;
+    PollingTransport(size_t period, size_t bound) : period(period), bound(bound) {}
+    void initialize() override {}
+    Result send(const JMessage&) override { return Result::FAILURE; }
+    Result receive(JMessage& message) override {
+        if (message_count == bound) return Result::FINISHED;
+        if (++poll_count % period != 0) return Result::TRY_AGAIN;
+        static_cast<PollMessage&>(message).event_number = ++message_count;
+        return Result::SUCCESS;
+    }
+};
+
+TEST_CASE("JEventSourceTryGetEvent") {
+
+    auto event = std::make_shared<JEvent>();
+    event->SetFactorySet(new JFactorySet);
+
+    SECTION("Statuses thrown by old-style sources and returned by new ones mean the same thing") {
+        ThrowingPollingSource throwing(3, 2);
+        ReturningPollingSource returning(3, 2);
+        std::vector<JEventSource::ReturnStatus> throwing_statuses, returning_statuses;
+        for (int i=0; i<8; ++i) {
+            throwing_statuses.push_back(throwing.DoNext(event));
+            returning_statuses.push_back(returning.DoNext(event));
+        }
+        using S = JEventSource::ReturnStatus;
+        auto expected = std::vector<S>{S::TryAgain, S::TryAgain, S::Success, S::TryAgain, S::TryAgain, S::Success,
+                                       S::Finished, S::Finished};
+        REQUIRE(throwing_statuses == expected);
+        REQUIRE(returning_statuses == expected);
+        REQUIRE(throwing.GetStatus() == JEventSource::SourceStatus::Finished);
+        REQUIRE(returning.GetStatus() == JEventSource::SourceStatus::Finished);
+        REQUIRE(throwing.GetEventCount() == 2);
+        REQUIRE(returning.GetEventCount() == 2);
+    }
+
+    SECTION("The compatibility shim still turns kERROR into a JException") {
+        ErrorSource source;
+        REQUIRE_THROWS_AS(source.DoNext(event), JException);
+    }
+
+    SECTION("A source which implements neither GetEvent nor TryGetEvent fails loudly") {
+        struct EmptySource : public JEventSource { EmptySource() : JEventSource("EmptySource") {} };
+        EmptySource source;
+        REQUIRE_THROWS_AS(source.DoNext(event), JException);
+    }
+
+    SECTION("JStreamingEventSource reports empty polls without throwing") {
+        JStreamingEventSource<PollMessage> source(std::unique_ptr<JTransport>(new PollingTransport(2, 1)));
+        REQUIRE(source.TryGetEvent(event) == JEventSource::ReturnStatus::TryAgain);
+        REQUIRE(source.TryGetEvent(event) == JEventSource::ReturnStatus::Success);
+        REQUIRE(event->GetEventNumber() == 1);
+        REQUIRE(event->Get<PollMessage>().size() == 1);
+        REQUIRE(source.TryGetEvent(event) == JEventSource::ReturnStatus::Finished);
+    }
+}
+
+TEST_CASE("EmptyPollBenchmark", "[.][performance]") {
+
+    const size_t poll_count = 1000000;
+    const size_t period = 1000;  // One poll in a thousand finds a message
+    auto event = std::make_shared<JEvent>();
+    event->SetFactorySet(new JFactorySet);
+
+    auto measure = [&](const char* name, JEventSource& source) {
+        size_t success_count = 0;
+        auto ns = ns_per_iteration(poll_count, [&]{
+            if (source.DoNext(event) == JEventSource::ReturnStatus::Success) success_count++;
+        });
+        std::cout << name << ": " << ns << " ns per poll (" << success_count << " events)" << std::endl;
+    };
+
+    ThrowingPollingSource throwing(period, poll_count);
+    ReturningPollingSource returning(period, poll_count);
+    measure("GetEvent throwing kTRY_AGAIN", throwing);
+    measure("TryGetEvent returning TryAgain", returning);
+}
+
+
+/// Reads a file made of blocks of `block_size` events, the way an EVIO reader would: it can only decode whole blocks,
+/// and it has to wait for the next block to arrive every `stall_period` blocks.
+struct BlockSource : public JEventSource {
+    size_t block_size, event_bound, stall_period;
+    std::vector<uint64_t> block;      // Decoded event numbers of the current block
+    size_t block_position = 0;
+    size_t next_event_nr = 1;
+    size_t blocks_read = 0;
+    size_t get_events_calls = 0;
+    uint64_t corrupt_event_nr = 0;    // GetEvents() throws when it gets here, once
+    bool stalled = false;
+
+    BlockSource(size_t block_size, size_t event_bound, size_t stall_period = 0)
+        : JEventSource("BlockSource"), block_size(block_size), event_bound(event_bound), stall_period(stall_period) {}
+
+    bool ReadBlock() {
+        if (next_event_nr > event_bound) return false;
+        block.clear();
+        for (size_t i=0; i<block_size && next_event_nr <= event_bound; ++i) {
+            block.push_back(next_event_nr++);
+        }
+        block_position = 0;
+        blocks_read++;
+        return true;
+    }
+
+    ReturnStatus GetEvents(JSpan<const std::shared_ptr<JEvent>> events, size_t& filled_count) override {
+        get_events_calls++;
+        filled_count = 0;
+        for (const auto& event : events) {
+            if (block_position == block.size()) {
+                if (stall_period != 0 && blocks_read % stall_period == 0 && !stalled && blocks_read != 0) {
+                    stalled = true;
+                    return ReturnStatus::TryAgain;
+                }
+                stalled = false;
+                if (!ReadBlock()) return ReturnStatus::Finished;
+            }
+            if (block[block_position] == corrupt_event_nr) {
+                corrupt_event_nr = 0;
+                throw JException("Corrupt event %d", block[block_position++]);
+            }
+            event->SetEventNumber(block[block_position++]);
+            filled_count++;
+        }
+        return ReturnStatus::Success;
+    }
+};
+
+TEST_CASE("JEventSourceGetEvents") {
+
+    std::vector<std::shared_ptr<JEvent>> events;
+    for (int i=0; i<4; ++i) {
+        events.push_back(std::make_shared<JEvent>());
+    }
+    JSpan<const std::shared_ptr<JEvent>> span(events.data(), events.size());
+    size_t skip_count, emit_count;
+    using S = JEventSource::ReturnStatus;
+
+    SECTION("A whole batch is filled at once, respecting nskip and nevents") {
+        BlockSource source(10, 100);
+        source.SetRange(3, 10);
+
+        REQUIRE(source.DoNext(span, skip_count, emit_count) == S::Success);
+        REQUIRE(skip_count == 3);
+        REQUIRE(emit_count == 1);
+        REQUIRE(events[3]->GetEventNumber() == 4);
+
+        REQUIRE(source.DoNext(span, skip_count, emit_count) == S::Success);
+        REQUIRE(skip_count == 0);
+        REQUIRE(emit_count == 4);
+        REQUIRE(events[0]->GetEventNumber() == 5);
+
+        REQUIRE(source.DoNext(span, skip_count, emit_count) == S::Success);
+        REQUIRE(emit_count == 4);
+
+        // Only one more event is allowed, after which we know we are done
+        REQUIRE(source.DoNext(span, skip_count, emit_count) == S::Finished);
+        REQUIRE(skip_count == 0);
+        REQUIRE(emit_count == 1);
+        REQUIRE(events[0]->GetEventNumber() == 13);
+        REQUIRE(source.GetEventCount() == 13);
+        REQUIRE(source.GetStatus() == JEventSource::SourceStatus::Finished);
+        REQUIRE(source.get_events_calls == 4);
+    }
+
+    SECTION("A source may stop partway through a batch") {
+        BlockSource source(6, 9, 1);
+
+        REQUIRE(source.DoNext(span, skip_count, emit_count) == S::Success);
+        REQUIRE(emit_count == 4);
+
+        REQUIRE(source.DoNext(span, skip_count, emit_count) == S::TryAgain);  // The next block isn't there yet
+        REQUIRE(emit_count == 2);
+        REQUIRE(events[1]->GetEventNumber() == 6);
+
+        REQUIRE(source.DoNext(span, skip_count, emit_count) == S::TryAgain);
+        REQUIRE(emit_count == 3);
+        REQUIRE(events[2]->GetEventNumber() == 9);
+        REQUIRE(source.GetEventCount() == 9);
+
+        REQUIRE(source.DoNext(span, skip_count, emit_count) == S::Finished);
+        REQUIRE(emit_count == 0);
+        REQUIRE(source.GetStatus() == JEventSource::SourceStatus::Finished);
+    }
+
+    SECTION("Events read before GetEvents() throws still count towards nevents") {
+        BlockSource source(10, 100);
+        source.SetRange(0, 6);
+        source.corrupt_event_nr = 3;
+
+        REQUIRE_THROWS_AS(source.DoNext(span, skip_count, emit_count), JException);
+        REQUIRE(source.GetEventCount() == 2);
+
+        REQUIRE(source.DoNext(span, skip_count, emit_count) == S::Success);
+        REQUIRE(emit_count == 4);
+        REQUIRE(events[0]->GetEventNumber() == 4);
+        REQUIRE(source.GetEventCount() == 6);
+
+        REQUIRE(source.DoNext(span, skip_count, emit_count) == S::Finished);
+        REQUIRE(emit_count == 0);
+    }
+
+    SECTION("Single-event DoNext() goes through GetEvents() too") {
+        BlockSource source(3, 5);
+        source.SetRange(1, 0);
+        auto event = std::make_shared<JEvent>();
+        REQUIRE(source.DoNext(event) == S::TryAgain);  // Skipped
+        REQUIRE(source.DoNext(event) == S::Success);
+        REQUIRE(event->GetEventNumber() == 2);
+        for (int i=0; i<3; ++i) REQUIRE(source.DoNext(event) == S::Success);
+        REQUIRE(source.DoNext(event) == S::Finished);
+    }
+
+    SECTION("The source arrow hands the source a whole chunk at a time") {
+        JApplication app;
+        app.SetParameterValue("nthreads", 2);
+        app.SetParameterValue("jana:event_source_chunksize", 8);
+        app.SetParameterValue("jana:event_pool_size", 16);
+        app.SetParameterValue("jana:nskip", 5);
+        app.SetParameterValue("jana:extended_report", 0);
+        auto source = new BlockSource(10, 500, 3);
+        auto processor = new EventNumberProcessor(&app);
+        app.Add(source);
+        app.Add(processor);
+        app.Run(true);
+
+        REQUIRE(processor->event_numbers.size() == 495);
+        REQUIRE(*processor->event_numbers.begin() == 6);
+        REQUIRE(*processor->event_numbers.rbegin() == 500);
+        REQUIRE(std::set<uint64_t>(processor->event_numbers.begin(), processor->event_numbers.end()).size() == 495);
+        REQUIRE(source->get_events_calls < 500 / 2);
+    }
+
+    SECTION("When the source throws partway through a chunk, the source arrow gives every event back") {
+        BlockSource source(10, 100);
+        source.EnableConcurrentGetEvent();  // So that the arrow uses its per-worker buffers
+        source.corrupt_event_nr = 3;
+        std::vector<JFactoryGenerator*> generators;
+        auto pool = std::make_shared<JEventPool>(&generators, false, 4, 1, true);
+        EventQueue queue(100, 1);
+        JEventSourceArrow arrow("source", &source, &queue, pool);
+        arrow.set_chunksize(4);
+        arrow.initialize();
+
+        JArrowMetrics metrics;
+        REQUIRE_THROWS_AS(arrow.execute(metrics, 0), JException);
+        std::vector<JEvent*> returned;
+        for (int i=0; i<4; ++i) returned.push_back(pool->get(0));
+        REQUIRE(std::count(returned.begin(), returned.end(), nullptr) == 0);
+        pool->put(returned, 0);
+
+        // The worker's buffers start out empty again, so the next chunk carries on from the next event
+        arrow.execute(metrics, 0);
+        std::vector<JEvent*> emitted;
+        queue.pop(emitted, 4, 0);
+        REQUIRE(emitted.size() == 4);
+        REQUIRE(emitted[0]->GetEventNumber() == 4);
+    }
+}
+
+/// BlockSource's decoder, but handing out one event per call like a source without GetEvents() would
+struct SingleEventBlockSource : public BlockSource {
+    using BlockSource::BlockSource;
+    ReturnStatus TryGetEvent(std::shared_ptr<JEvent> event) override {
+        size_t filled_count;
+        return BlockSource::GetEvents(JSpan<const std::shared_ptr<JEvent>>(&event, 1), filled_count);
+    }
+    ReturnStatus GetEvents(JSpan<const std::shared_ptr<JEvent>> events, size_t& filled_count) override {
+        return JEventSource::GetEvents(events, filled_count);
+    }
+};
+
+TEST_CASE("GetEventsBenchmark", "[.][performance]") {
+
+    const size_t event_count = 10000000;
+    const size_t chunksize = 40;
+    std::vector<std::shared_ptr<JEvent>> events;
+    for (size_t i=0; i<chunksize; ++i) {
+        events.push_back(std::make_shared<JEvent>());
+    }
+    JSpan<const std::shared_ptr<JEvent>> span(events.data(), events.size());
+
+    auto measure = [&](const char* name, JEventSource& source, bool batched) {
+        size_t emitted = 0;
+        double ns;
+        if (batched) {
+            ns = ns_per_iteration(event_count / chunksize, [&]{
+                size_t skip_count, emit_count;
+                source.DoNext(span, skip_count, emit_count);
+                emitted += emit_count;
+            }) / chunksize;
+        }
+        else {
+            // What the source arrow used to do for each event of the chunk
+            ns = ns_per_iteration(event_count, [&]{
+                if (source.DoNext(events[emitted % chunksize]) == JEventSource::ReturnStatus::Success) emitted++;
+            });
+        }
+        REQUIRE(emitted == event_count);
+        std::cout << name << ": " << ns << " ns per event" << std::endl;
+    };
+
+    SingleEventBlockSource single(chunksize, event_count);
+    BlockSource batched(chunksize, event_count);
+    measure("DoNext(event) per event", single, false);
+    measure("DoNext(span) per chunk of 40", batched, true);
+}
+
+
+/// A message which owns a large buffer, like DASEventMessage, and can view the transport's memory instead of it
+struct BulkMessage : public JEventMessage {
+    std::vector<char> buffer;
+    JTransportBuffer transport_buffer;
+    explicit BulkMessage(JApplication*) : buffer(1 << 20) {}
+    char* as_buffer() override { return transport_buffer.is_held() ? transport_buffer.data : buffer.data(); }
+    const char* as_buffer() const override { return transport_buffer.is_held() ? transport_buffer.data : buffer.data(); }
+    size_t get_buffer_capacity() const override { return transport_buffer.is_held() ? transport_buffer.size : buffer.size(); }
+    bool is_end_of_stream() const override { return false; }
+    size_t get_event_number() const override { return static_cast<unsigned char>(as_buffer()[0]); }
+    size_t get_run_number() const override { return 0; }
+    JTransportBuffer* get_transport_buffer() override { return &transport_buffer; }
+    friend std::ostream& operator<<(std::ostream& os, const BulkMessage& msg) { return os << "BulkMessage " << msg.get_event_number(); }
+};
+
+/// Hands out frames it allocated itself when the message lets it, the way ZmqTransport hands out zmq_msg_ts
+struct ZeroCopyTransport : public JTransport {
+    size_t bound, message_count = 0, release_count = 0;
+    bool zero_copy;
+    ZeroCopyTransport(size_t bound, bool zero_copy) : bound(bound), zero_copy(zero_copy) {}
+    void initialize() override {}
+    Result send(const JMessage&) override { return Result::FAILURE; }
+    Result receive(JMessage& message) override {
+        if (message_count == bound) return Result::FINISHED;
+        char frame_contents = static_cast<char>(++message_count);
+        auto buffer = message.get_transport_buffer();
+        if (!zero_copy || buffer == nullptr) {
+            message.as_buffer()[0] = frame_contents;
+            return Result::SUCCESS;
+        }
+        struct Frame { ZeroCopyTransport* transport; char* data; };
+        buffer->release();
+        auto frame = new (buffer->handle) Frame {this, new char[64]};
+        frame->data[0] = frame_contents;
+        buffer->data = frame->data;
+        buffer->size = 64;
+        buffer->release_fn = [](JTransportBuffer& b) {
+            auto f = reinterpret_cast<Frame*>(b.handle);
+            delete[] f->data;
+            f->transport->release_count++;
+        };
+        return Result::SUCCESS;
+    }
+};
+
+TEST_CASE("JStreamingEventSourceMessagePool") {
+
+    SECTION("Messages go back to the pool when their event is recycled") {
+        JStreamingEventSource<PollMessage> source(std::unique_ptr<JTransport>(new PollingTransport(1, 100)));
+        auto event = std::make_shared<JEvent>();
+        event->SetFactorySet(new JFactorySet({source.GetFactoryGenerator()}));
+        for (size_t i=1; i<=100; ++i) {
+            REQUIRE(source.TryGetEvent(event) == JEventSource::ReturnStatus::Success);
+            auto messages = event->Get<PollMessage>();
+            REQUIRE(messages.size() == 1);
+            REQUIRE(messages[0]->event_number == i);
+            event->GetFactorySet()->Release();
+            REQUIRE(event->Get<PollMessage>().empty());
+        }
+        REQUIRE(source.TryGetEvent(event) == JEventSource::ReturnStatus::Finished);
+        REQUIRE(source.GetMessagePool()->get_created_count() == 1);
+    }
+
+    SECTION("The pool only grows to the number of events in flight") {
+        JStreamingEventSource<PollMessage> source(std::unique_ptr<JTransport>(new PollingTransport(1, 100)));
+        std::vector<std::shared_ptr<JEvent>> events;
+        for (int i=0; i<4; ++i) {
+            events.push_back(std::make_shared<JEvent>());
+            events.back()->SetFactorySet(new JFactorySet({source.GetFactoryGenerator()}));
+        }
+        for (size_t i=0; i<100; ++i) {
+            auto& event = events[i % 4];
+            event->GetFactorySet()->Release();
+            REQUIRE(source.TryGetEvent(event) == JEventSource::ReturnStatus::Success);
+        }
+        REQUIRE(source.GetMessagePool()->get_created_count() == 4);
+    }
+
+    SECTION("Events whose factories don't come from the source still own their messages") {
+        JStreamingEventSource<PollMessage> source(std::unique_ptr<JTransport>(new PollingTransport(1, 3)));
+        auto event = std::make_shared<JEvent>();
+        event->SetFactorySet(new JFactorySet);
+        for (int i=0; i<3; ++i) {
+            REQUIRE(source.TryGetEvent(event) == JEventSource::ReturnStatus::Success);
+            event->GetFactorySet()->Release();
+        }
+        REQUIRE(source.GetMessagePool()->get_created_count() == 3);
+        REQUIRE(source.GetMessagePool()->get_idle_count() == 0);
+    }
+
+    SECTION("A factory generator from the user is kept, and its events own their messages") {
+        JFactoryGeneratorT<JFactoryT<PollMessage>> generator;
+        JStreamingEventSource<PollMessage> source(std::unique_ptr<JTransport>(new PollingTransport(1, 3)), &generator);
+        REQUIRE(source.GetFactoryGenerator() == &generator);
+        auto event = std::make_shared<JEvent>();
+        event->SetFactorySet(new JFactorySet({source.GetFactoryGenerator()}));
+        for (int i=0; i<3; ++i) {
+            REQUIRE(source.TryGetEvent(event) == JEventSource::ReturnStatus::Success);
+            REQUIRE(event->Get<PollMessage>().size() == 1);
+            event->GetFactorySet()->Release();
+        }
+        REQUIRE(source.GetMessagePool()->get_idle_count() == 0);
+    }
+
+    SECTION("Transport buffers are handed over without copying and released on recycle") {
+        auto transport = new ZeroCopyTransport(10, true);
+        JStreamingEventSource<BulkMessage> source((std::unique_ptr<JTransport>(transport)));
+        auto event = std::make_shared<JEvent>();
+        event->SetFactorySet(new JFactorySet({source.GetFactoryGenerator()}));
+        for (size_t i=1; i<=10; ++i) {
+            REQUIRE(source.TryGetEvent(event) == JEventSource::ReturnStatus::Success);
+            auto message = event->GetSingle<BulkMessage>();
+            REQUIRE(message->transport_buffer.is_held());
+            REQUIRE(message->as_buffer() == message->transport_buffer.data);
+            REQUIRE(message->get_buffer_capacity() == 64);
+            REQUIRE(event->GetEventNumber() == i);
+            REQUIRE(transport->release_count == i - 1);
+            event->GetFactorySet()->Release();
+            REQUIRE(transport->release_count == i);
+            REQUIRE(!message->transport_buffer.is_held());
+            REQUIRE(message->get_buffer_capacity() == message->buffer.size());
+        }
+        REQUIRE(source.GetMessagePool()->get_created_count() == 1);
+    }
+}
+
+TEST_CASE("MessagePoolBenchmark", "[.][performance]") {
+
+    const size_t event_count = 20000;
+
+    auto measure = [&](bool pooled, bool zero_copy) {
+        auto transport = new ZeroCopyTransport(event_count, zero_copy);
+        JStreamingEventSource<BulkMessage> source((std::unique_ptr<JTransport>(transport)));
+        auto event = std::make_shared<JEvent>();
+        // Without the source's generator, the event gets a plain JFactoryT, which deletes every message
+        event->SetFactorySet(pooled ? new JFactorySet({source.GetFactoryGenerator()}) : new JFactorySet);
+        size_t received = 0;
+        auto ns = ns_per_iteration(event_count, [&]{
+            if (source.TryGetEvent(event) == JEventSource::ReturnStatus::Success) received++;
+            event->GetFactorySet()->Release();
+        });
+        REQUIRE(received == event_count);
+        return ns;
+    };
+
+    auto new_delete = measure(false, false);
+    auto pooled = measure(true, false);
+    auto pooled_zero_copy = measure(true, true);
+    std::cout << "new/delete 1 MiB message per event: " << new_delete << " ns per event" << std::endl;
+    std::cout << "Pooled messages:                    " << pooled << " ns per event" << std::endl;
+    std::cout << "Pooled messages, zero-copy:         " << pooled_zero_copy << " ns per event" << std::endl;
+}
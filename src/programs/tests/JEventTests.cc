@@ -4,9 +4,18 @@
 
 
 #include "catch.hpp"
+#include "BenchmarkUtils.h"
 
 #include <JANA/JEvent.h>
+#include <JANA/Utils/JEventArena.h>
+#include <JANA/Utils/JEventPool.h>
+#include <JANA/JFactoryGenerator.h>
+#include <JANA/Engine/JEventProcessorArrow.h>
+#include <JANA/Engine/JEventSourceArrow.h>
 #include "JEventTests.h"
+#include "ExactlyOnceTests.h"
+
+#include <thread>
 
 
 TEST_CASE("JEventInsertTests") {
@@ -216,3 +225,319 @@ TEST_CASE("JEventInsertTests") {
 
 }
 
+
+
+TEST_CASE("JEventPoolTests") {
+
+    std::vector<JFactoryGenerator*> generators;
+    JEventPool pool(&generators, false, 2, 3, true);
+    REQUIRE(pool.get_location_count() == 3);
+
+    SECTION("Each location gets its own partition of events") {
+        auto e0 = pool.get(0);
+        auto e1 = pool.get(0);
+        REQUIRE(e0 != nullptr);
+        REQUIRE(e1 != nullptr);
+        REQUIRE(pool.get(0) == nullptr);
+        REQUIRE(pool.get(1) != nullptr);
+        REQUIRE(pool.get(5) != nullptr);  // Locations wrap around
+    }
+
+    SECTION("Events return to the partition which owns them") {
+        auto event = pool.get(1);
+        pool.put(event, 2);
+        REQUIRE(pool.get_local_use_count(1) == 0);
+        REQUIRE(pool.get_remote_use_count(1) == 1);
+        REQUIRE(pool.get_remote_use_count(2) == 0);
+
+        auto a = pool.get(1);
+        auto b = pool.get(1);
+        REQUIRE((a == event || b == event));
+        pool.put(a, 1);
+        REQUIRE(pool.get_local_use_count(1) == 1);
+    }
+
+    SECTION("Surplus events made while the pool ran dry are destroyed once they come back") {
+        JEventPool unlimited_pool(&generators, false, 1, 1, false);
+        auto pooled = unlimited_pool.get(0);
+        auto surplus = unlimited_pool.get(0);
+        REQUIRE(surplus != nullptr);
+        REQUIRE(surplus != pooled);
+
+        bool deleted = false;
+        auto object = new FakeJObject(7);
+        object->deleted = &deleted;
+        surplus->Insert(object);
+        unlimited_pool.put(pooled, 0);
+        unlimited_pool.put(surplus, 0);
+        REQUIRE(deleted);
+        REQUIRE(unlimited_pool.get(0) == pooled);
+    }
+
+    SECTION("Surplus events are found directly, however many there are") {
+        JEventPool unlimited_pool(&generators, false, 1, 1, false);
+        std::vector<JEvent*> events;
+        for (int i=0; i<5; ++i) events.push_back(unlimited_pool.get(0));
+        // Returning them out of order moves the others around within the partition's list of owned events
+        for (size_t i : {2, 0, 4, 1}) {
+            unlimited_pool.put(events[i], 0);
+        }
+        REQUIRE(unlimited_pool.get(0) == events[2]);
+        unlimited_pool.put(std::shared_ptr<JEvent>(events[3]->shared_from_this()), 0);
+        unlimited_pool.put(events[2], 0);
+        REQUIRE(unlimited_pool.get(0) == events[3]);
+    }
+
+    SECTION("Handles which user code holds on to keep their event alive") {
+        std::shared_ptr<const JEvent> kept;
+        bool deleted = false;
+        {
+            JEventPool short_lived_pool(&generators, false, 1, 1, true);
+            auto event = short_lived_pool.get(0);
+            auto object = new FakeJObject(7);
+            object->deleted = &deleted;
+            event->Insert(object);
+            kept = event->shared_from_this();
+            REQUIRE(kept.use_count() > 1);
+        }
+        REQUIRE(!deleted);
+        REQUIRE(kept.use_count() == 1);
+        REQUIRE(kept->Get<FakeJObject>().size() == 1);
+        kept.reset();
+        REQUIRE(deleted);
+    }
+
+    SECTION("Partitions are filled even when the processor mapping has no information") {
+        JProcessorMapping mapping;
+        JEventPool mapped_pool(&generators, false, 1, 2, true, &mapping);
+        REQUIRE(mapped_pool.get(0) != nullptr);
+        REQUIRE(mapped_pool.get(1) != nullptr);
+    }
+
+    SECTION("Each source gets its own partition, with its own factories built in up front") {
+        JFactoryGeneratorT<JFactoryT<FakeJObject>> generator_a("a");
+        JFactoryGeneratorT<JFactoryT<FakeJObject>> generator_b("b");
+        SimpleSource source_a("a", nullptr), source_b("b", nullptr);
+        source_a.SetFactoryGenerator(&generator_a);
+        source_b.SetFactoryGenerator(&generator_b);
+        JEventPool source_pool(&generators, false, 2, 1, true, nullptr, {&source_a, &source_b});
+
+        auto a1 = source_pool.get(0, &source_a);
+        auto a2 = source_pool.get(0, &source_a);
+        REQUIRE(a2 != nullptr);
+        REQUIRE(a2 != a1);
+        REQUIRE(source_pool.get(0, &source_a) == nullptr);
+        auto b1 = source_pool.get(0, &source_b);
+        REQUIRE(b1 != nullptr);
+
+        REQUIRE(a1->GetJEventSource() == &source_a);
+        REQUIRE(a1->GetFactory<FakeJObject>("a") != nullptr);
+        REQUIRE(a1->GetFactory<FakeJObject>("b") == nullptr);
+        REQUIRE(b1->GetJEventSource() == &source_b);
+        REQUIRE(b1->GetFactory<FakeJObject>("b") != nullptr);
+
+        // Returned events go back to their own source's partition, with their factory sets intact
+        auto a1_factory_set = a1->GetFactorySet();
+        source_pool.put(a1, 0);
+        REQUIRE(source_pool.get(0, &source_b) != nullptr);
+        auto recycled = source_pool.get(0, &source_a);
+        REQUIRE(recycled->GetFactorySet() == a1_factory_set);
+
+        // Sources which the pool wasn't built for have no partition to fall back on
+        SimpleSource source_c("c", nullptr);
+        REQUIRE_THROWS_AS(source_pool.get(0, &source_c), JException);
+        REQUIRE_THROWS_AS(source_pool.get(0), JException);
+    }
+
+    SECTION("Partitions with known cpus are filled from a pinned thread") {
+        JProcessorMapping mapping;
+        mapping.initialize(JProcessorMapping::AffinityStrategy::None, JProcessorMapping::LocalityStrategy::CpuLocal);
+        size_t location_count = mapping.get_loc_count() + 1;  // The last location has no cpus and falls back
+        JEventPool mapped_pool(&generators, false, 1, location_count, true, &mapping);
+        for (size_t loc_id=0; loc_id<location_count; ++loc_id) {
+            auto event = mapped_pool.get(loc_id);
+            REQUIRE(event != nullptr);
+            mapped_pool.put(event, loc_id);
+            REQUIRE(mapped_pool.get_local_use_count(loc_id) == 1);
+        }
+    }
+}
+
+
+TEST_CASE("JEventArenaTests") {
+
+    SECTION("Create() respects alignment, counts allocations, and Reset() destroys in reverse order") {
+        struct alignas(32) Aligned { char c; };
+        struct Tracker {
+            std::vector<int>* destroyed; int id;
+            Tracker(std::vector<int>* destroyed, int id) : destroyed(destroyed), id(id) {}
+            ~Tracker() { destroyed->push_back(id); }
+        };
+
+        JEventArena sut(256);
+        std::vector<int> destroyed;
+        sut.Create<char>('x');
+        auto aligned = sut.Create<Aligned>();
+        REQUIRE(reinterpret_cast<uintptr_t>(aligned) % 32 == 0);
+        auto tracker = sut.Create<Tracker>(&destroyed, 1);
+        sut.Create<Tracker>(&destroyed, 2);
+        REQUIRE(sut.Owns(tracker));
+        REQUIRE(!sut.Owns(&destroyed));
+        REQUIRE(sut.GetAllocationCount() == 4);
+        REQUIRE(sut.GetAllocatedBytes() == 1 + sizeof(Aligned) + 2 * sizeof(Tracker));
+
+        sut.Reset();
+        REQUIRE(destroyed == std::vector<int>({2, 1}));
+        REQUIRE(sut.GetAllocationCount() == 0);
+        REQUIRE(sut.GetAllocatedBytes() == 0);
+    }
+
+    SECTION("Blocks which overflowed are merged into one on Reset()") {
+        JEventArena sut(64);
+        for (int i=0; i<100; ++i) {
+            sut.Create<FakeJObject>(i);
+        }
+        auto capacity = sut.GetCapacity();
+        REQUIRE(capacity >= 100 * sizeof(FakeJObject));
+        sut.Reset();
+        REQUIRE(sut.GetCapacity() == capacity);
+
+        // The next event of the same size fits in the merged block without growing
+        for (int i=0; i<100; ++i) {
+            sut.Create<FakeJObject>(i);
+        }
+        REQUIRE(sut.GetCapacity() == capacity);
+    }
+
+    SECTION("Owning factories leave arena objects to the arena, but still delete heap objects") {
+        auto event = std::make_shared<JEvent>();
+        event->SetFactorySet(new JFactorySet);
+
+        bool arena_deleted = false;
+        bool heap_deleted = false;
+        auto arena_obj = event->Create<FakeJObject>(1);
+        arena_obj->deleted = &arena_deleted;
+        auto heap_obj = new FakeJObject(2);
+        heap_obj->deleted = &heap_deleted;
+        auto factory = event->Insert(arena_obj);
+        event->Insert(heap_obj);
+        REQUIRE(event->Get<FakeJObject>().size() == 2);
+        REQUIRE(event->GetArena()->GetAllocationCount() == 1);
+
+        factory->ClearData();
+        REQUIRE(heap_deleted == true);
+        REQUIRE(arena_deleted == false);
+
+        event->GetArena()->Reset();
+        REQUIRE(arena_deleted == true);
+    }
+
+    SECTION("Non-owning factories leave both kinds of objects alone") {
+        auto event = std::make_shared<JEvent>();
+        event->SetFactorySet(new JFactorySet);
+
+        bool arena_deleted = false;
+        FakeJObject heap_obj(2);
+        auto arena_obj = event->Create<FakeJObject>(1);
+        arena_obj->deleted = &arena_deleted;
+        auto factory = event->Insert(arena_obj, "borrowed");
+        factory->SetFactoryFlag(JFactory::NOT_OBJECT_OWNER);
+        event->Insert(&heap_obj, "borrowed");
+
+        factory->ClearData();
+        REQUIRE(arena_deleted == false);
+        event->GetArena()->Reset();
+        REQUIRE(arena_deleted == true);
+    }
+
+    SECTION("Recycling an event resets its arena and records how much it was used") {
+        std::vector<JFactoryGenerator*> generators;
+        JEventPool pool(&generators, false, 1, 1, true);
+
+        bool deleted = false;
+        auto event = pool.get(0);
+        auto obj = event->Create<FakeJObject>(1);
+        obj->deleted = &deleted;
+        event->Insert(obj);
+        event->Insert(event->Create<FakeJObject>(2));
+        pool.put(event, 0);
+        REQUIRE(deleted == false);
+
+        auto recycled = pool.get(0);
+        REQUIRE(deleted == true);
+        REQUIRE(recycled->GetArena()->GetAllocationCount() == 0);
+        REQUIRE(recycled->Get<FakeJObject>().empty());
+
+        size_t recycled_count, allocation_count, byte_count;
+        pool.get_arena_usage(recycled_count, allocation_count, byte_count);
+        REQUIRE(recycled_count == 1);
+        REQUIRE(allocation_count == 2);
+        REQUIRE(byte_count == 2 * sizeof(FakeJObject));
+    }
+}
+
+
+struct HandleBenchmarkFactory : public JFactoryT<FakeJObject> {
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        Insert(event->Create<FakeJObject>(static_cast<int>(event->GetEventNumber())));
+    }
+};
+
+struct HandleBenchmarkProcessor : public JEventProcessor {
+    std::atomic<size_t> processed_count {0};
+    std::atomic<size_t> checksum {0};
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        size_t sum = 0;
+        for (int i=0; i<8; ++i) {
+            sum += event->GetSingle<FakeJObject>()->datum;
+        }
+        checksum.fetch_add(sum, std::memory_order_relaxed);
+        processed_count.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+TEST_CASE("EventHandleBenchmark", "[.][performance]") {
+
+    // Drives a source arrow and a sink arrow directly from several threads, without a scheduler, so that what
+    // gets measured is what the engine does to each event: pool, mailbox, source, factories and processors.
+    const size_t events_per_thread = 200000;
+    for (size_t nthreads : {1, 2, 4, 8}) {
+        std::vector<JFactoryGenerator*> generators {new JFactoryGeneratorT<HandleBenchmarkFactory>()};
+        auto pool = std::make_shared<JEventPool>(&generators, false, 64, nthreads, true);
+        JEventProcessorArrow::EventQueue queue(1000, nthreads);
+        SimpleSource source("SimpleSource", nullptr);
+        source.event_limit = 0;  // Never finishes
+        HandleBenchmarkProcessor processor;
+
+        JEventSourceArrow source_arrow("source", &source, &queue, pool);
+        JEventProcessorArrow sink_arrow("sink", &queue, nullptr, pool);
+        sink_arrow.add_processor(&processor);
+        source_arrow.set_chunksize(40);
+        sink_arrow.set_chunksize(40);
+        source_arrow.initialize();
+        sink_arrow.initialize();
+
+        std::mutex source_mutex;  // The source arrow is sequential, which the scheduler would normally enforce
+        // One iteration spans the whole run; dividing by the processed count gives the time per event
+        auto ns = ns_per_iteration(1, [&]{
+            std::vector<std::thread> threads;
+            for (size_t location=0; location<nthreads; ++location) {
+                threads.emplace_back([&, location]() {
+                    JArrowMetrics metrics;
+                    while (processor.processed_count < nthreads * events_per_thread) {
+                        {
+                            std::lock_guard<std::mutex> lock(source_mutex);
+                            source_arrow.execute(metrics, location);
+                        }
+                        sink_arrow.execute(metrics, location);
+                    }
+                });
+            }
+            for (auto& thread : threads) thread.join();
+        });
+        REQUIRE(processor.processed_count >= nthreads * events_per_thread);
+
+        std::cout << nthreads << " threads: " << ns / processor.processed_count << " ns per event" << std::endl;
+        delete generators[0];
+    }
+}
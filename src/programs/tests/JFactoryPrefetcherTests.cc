@@ -0,0 +1,174 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+
+#include "catch.hpp"
+#include "BenchmarkUtils.h"
+#include "ExactlyOnceTests.h"
+
+#include <JANA/JApplication.h>
+#include <JANA/JEvent.h>
+#include <JANA/JEventProcessor.h>
+#include <JANA/JFactoryGenerator.h>
+#include <JANA/Engine/JFactoryPrefetcher.h>
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+
+// A diamond: Tracks need Hits and Clusters, which don't need each other
+struct PrefetchHit : public JObject { int value; explicit PrefetchHit(int v) : value(v) {} };
+struct PrefetchCluster : public JObject { int value; explicit PrefetchCluster(int v) : value(v) {} };
+struct PrefetchTrack : public JObject { int value; explicit PrefetchTrack(int v) : value(v) {} };
+
+static std::chrono::microseconds g_prefetch_factory_delay {0};
+
+struct PrefetchHitFactory : public JFactoryT<PrefetchHit> {
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        std::this_thread::sleep_for(g_prefetch_factory_delay);
+        Insert(new PrefetchHit(event->GetEventNumber()));
+    }
+};
+
+struct PrefetchClusterFactory : public JFactoryT<PrefetchCluster> {
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        std::this_thread::sleep_for(g_prefetch_factory_delay);
+        Insert(new PrefetchCluster(2 * event->GetEventNumber()));
+    }
+};
+
+struct PrefetchTrackFactory : public JFactoryT<PrefetchTrack> {
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        auto hits = event->Get<PrefetchHit>();
+        auto clusters = event->Get<PrefetchCluster>();
+        std::this_thread::sleep_for(g_prefetch_factory_delay);
+        Insert(new PrefetchTrack(hits[0]->value + clusters[0]->value));
+    }
+};
+
+struct PrefetchProcessor : public JEventProcessor {
+    std::atomic<size_t> mismatch_count {0};
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        auto tracks = event->Get<PrefetchTrack>();
+        auto hits = event->Get<PrefetchHit>();
+        if (tracks.size() != 1 || tracks[0]->value != 3 * hits[0]->value) mismatch_count++;
+    }
+};
+
+static std::shared_ptr<JEvent> make_prefetch_event(uint64_t event_number) {
+    auto event = std::make_shared<JEvent>();
+    event->SetFactorySet(new JFactorySet);
+    event->GetFactorySet()->Add(new PrefetchHitFactory);
+    event->GetFactorySet()->Add(new PrefetchClusterFactory);
+    event->GetFactorySet()->Add(new PrefetchTrackFactory);
+    event->SetEventNumber(event_number);
+    return event;
+}
+
+
+TEST_CASE("JFactoryPrefetcherTests") {
+
+    JFactoryPrefetcher prefetcher(2, 2);
+    auto event = make_prefetch_event(7);
+    PrefetchProcessor processor;
+
+    auto run_event = [&]() {
+        prefetcher.begin_event(event.get());
+        processor.Process(event);
+        prefetcher.end_event(event.get());
+        event->GetFactorySet()->Release();
+    };
+
+    SECTION("The factories are levelled after the learning events") {
+        REQUIRE(prefetcher.is_learning());
+        run_event();
+        REQUIRE(prefetcher.is_learning());
+        REQUIRE(prefetcher.get_schedule().empty());
+        run_event();
+        REQUIRE(!prefetcher.is_learning());
+
+        auto schedule = prefetcher.get_schedule();
+        REQUIRE(schedule.size() == 2);
+        REQUIRE(schedule[0].size() == 2);
+        REQUIRE(std::count(schedule[0].begin(), schedule[0].end(), JFactoryPrefetcher::FactoryKey("PrefetchHit", "")) == 1);
+        REQUIRE(std::count(schedule[0].begin(), schedule[0].end(), JFactoryPrefetcher::FactoryKey("PrefetchCluster", "")) == 1);
+        REQUIRE(schedule[1] == std::vector<JFactoryPrefetcher::FactoryKey>{{"PrefetchTrack", ""}});
+
+        // Learning doesn't leave the call graph recorder behind
+        REQUIRE(!event->GetJCallGraphRecorder()->IsEnabled());
+        REQUIRE(event->GetJCallGraphRecorder()->GetCallGraph().empty());
+        REQUIRE(prefetcher.get_prefetched_event_count() == 0);
+    }
+
+    SECTION("Prefetched events have everything created before the processors run") {
+        run_event();
+        run_event();
+        prefetcher.begin_event(event.get());
+        REQUIRE(prefetcher.get_prefetched_event_count() == 1);
+        REQUIRE(event->GetFactory<PrefetchHit>()->GetCreationStatus() == JFactory::CreationStatus::Created);
+        REQUIRE(event->GetFactory<PrefetchCluster>()->GetCreationStatus() == JFactory::CreationStatus::Created);
+        REQUIRE(event->GetFactory<PrefetchTrack>()->GetCreationStatus() == JFactory::CreationStatus::Created);
+        processor.Process(event);
+        prefetcher.end_event(event.get());
+        REQUIRE(processor.mismatch_count == 0);
+    }
+
+    SECTION("Events whose call graph somebody else is recording are left alone") {
+        event->GetJCallGraphRecorder()->SetEnabled(true);
+        run_event();
+        run_event();
+        REQUIRE(prefetcher.is_learning());
+        REQUIRE(event->GetJCallGraphRecorder()->IsEnabled());
+    }
+}
+
+
+TEST_CASE("JFactoryPrefetcher runs inside the topology") {
+
+    JApplication app;
+    auto source = new SimpleSource("SimpleSource", &app);
+    source->event_limit = 200;
+    auto processor = new PrefetchProcessor;
+    app.Add(source);
+    app.Add(processor);
+    app.Add(new JFactoryGeneratorT<PrefetchHitFactory>());
+    app.Add(new JFactoryGeneratorT<PrefetchClusterFactory>());
+    app.Add(new JFactoryGeneratorT<PrefetchTrackFactory>());
+    app.SetParameterValue("jana:extended_report", 0);
+    app.SetParameterValue("jana:nthreads", 4);
+    app.SetParameterValue("jana:intra_event_threads", 2);
+    app.SetParameterValue("jana:intra_event_learning_events", 5);
+    app.Run(true);
+
+    REQUIRE(app.GetNEventsProcessed() == 199);
+    REQUIRE(processor->mismatch_count == 0);
+}
+
+
+TEST_CASE("FactoryPrefetchBenchmark", "[.][performance]") {
+
+    const size_t event_count = 200;
+    g_prefetch_factory_delay = std::chrono::microseconds(500);
+
+    auto measure = [&](size_t thread_count) {
+        JFactoryPrefetcher prefetcher(1, thread_count);
+        PrefetchProcessor processor;
+        auto event = make_prefetch_event(1);
+        auto ns = ns_per_iteration(event_count, [&]{
+            prefetcher.begin_event(event.get());
+            processor.Process(event);
+            prefetcher.end_event(event.get());
+            event->GetFactorySet()->Release();
+        });
+        REQUIRE(processor.mismatch_count == 0);
+        return ns;
+    };
+
+    auto sequential = measure(0);
+    auto prefetched = measure(2);
+    g_prefetch_factory_delay = std::chrono::microseconds(0);
+
+    std::cout << "Latency per event with three 500us factories: sequential " << sequential
+              << " ns, prefetched " << prefetched << " ns" << std::endl;
+}
@@ -4,10 +4,16 @@
 
 
 #include "catch.hpp"
+#include "BenchmarkUtils.h"
 #include "JFactoryTests.h"
 
 #include <JANA/JEvent.h>
 #include <JANA/JFactoryT.h>
+#include <JANA/JFactorySet.h>
+
+#include <chrono>
+#include <iostream>
+#include <thread>
 
 TEST_CASE("JFactoryTests") {
 
@@ -139,3 +145,251 @@ TEST_CASE("JFactoryTests") {
     }
 }
 
+
+
+template <typename T>
+JFactoryT<T>* make_tagged_factory(const std::string& tag) {
+    auto factory = new JFactoryT<T>();
+    factory->SetTag(tag);
+    return factory;
+}
+
+struct UnregisteredObject : public JObject {};
+
+struct ClearCountingFactory : public JFactoryT<DummyObject> {
+    int clear_count = 0;
+    explicit ClearCountingFactory(const std::string& tag) { SetTag(tag); }
+    void ClearData() override {
+        clear_count++;
+        JFactoryT<DummyObject>::ClearData();
+    }
+};
+
+TEST_CASE("JFactorySetTests") {
+
+    SECTION("Typed lookup distinguishes factories by tag") {
+        JFactorySet sut;
+        auto untagged = new JFactoryT<DummyObject>();
+        auto tagged = make_tagged_factory<DummyObject>("tagged");
+        sut.Add(untagged);
+        sut.Add(tagged);
+
+        REQUIRE(sut.GetFactory<DummyObject>() == untagged);
+        REQUIRE(sut.GetFactory<DummyObject>("tagged") == tagged);
+        REQUIRE(sut.GetFactory<DummyObject>("missing") == nullptr);
+        REQUIRE(sut.GetFactory<UnregisteredObject>() == nullptr);
+
+        // The string-keyed path still finds the same factories
+        REQUIRE(sut.GetFactory("DummyObject", "tagged") == tagged);
+    }
+
+    SECTION("Factory ids are shared across JFactorySets") {
+        auto id = JFactorySet::GetFactoryId<DummyObject>("shared");
+        REQUIRE(id == JFactorySet::NoFactoryId);
+        REQUIRE(JFactorySet::GetFactoryId<DummyObject>("shared") == JFactorySet::NoFactoryId);  // Cached miss
+
+        JFactorySet first;
+        JFactorySet second;
+        auto first_factory = make_tagged_factory<DummyObject>("shared");
+        auto second_factory = make_tagged_factory<DummyObject>("shared");
+        first.Add(first_factory);
+        second.Add(second_factory);
+
+        // A cached miss expires on the next registration, so the tag resolves as soon as some factory registers it
+        id = JFactorySet::GetFactoryId<DummyObject>("shared");
+        REQUIRE(id != JFactorySet::NoFactoryId);
+        REQUIRE(id == JFactorySet::FindFactoryId(std::type_index(typeid(DummyObject)), "shared"));
+        REQUIRE(first.GetFactory<DummyObject>("shared") == first_factory);
+        REQUIRE(second.GetFactory<DummyObject>("shared") == second_factory);
+    }
+
+    SECTION("Merge leaves only the duplicates behind, and both sets can still look them up") {
+        JFactorySet sut;
+        auto original = new JFactoryT<DummyObject>();
+        sut.Add(original);
+
+        JFactorySet other;
+        auto duplicate = new JFactoryT<DummyObject>();
+        auto distinct = make_tagged_factory<DummyObject>("distinct");
+        other.Add(duplicate);
+        other.Add(distinct);
+
+        sut.Merge(other);
+        REQUIRE(sut.GetFactory<DummyObject>() == original);
+        REQUIRE(sut.GetFactory<DummyObject>("distinct") == distinct);
+        REQUIRE(other.GetFactory<DummyObject>() == duplicate);
+        REQUIRE(other.GetFactory<DummyObject>("distinct") == nullptr);
+    }
+
+    SECTION("Release only clears the factories which were used") {
+        auto event = std::make_shared<JEvent>();
+        auto sut = new JFactorySet;
+        event->SetFactorySet(sut);
+        auto produced = new ClearCountingFactory("produced");
+        auto inserted = new ClearCountingFactory("inserted");
+        auto unused = new ClearCountingFactory("unused");
+        sut->Add(produced);
+        sut->Add(inserted);
+        sut->Add(unused);
+
+        event->Get<DummyObject>("produced");
+        event->Get<DummyObject>("produced");
+        event->Insert(new DummyObject(22), "inserted");
+        sut->Release();
+        REQUIRE(produced->clear_count == 1);
+        REQUIRE(inserted->clear_count == 1);
+        REQUIRE(unused->clear_count == 0);
+        REQUIRE(inserted->GetNumObjects() == 0);
+
+        // Nothing was used since
+        sut->Release();
+        REQUIRE(produced->clear_count == 1);
+
+        event->Insert(new DummyObject(23), "inserted");
+        sut->Release();
+        REQUIRE(inserted->clear_count == 2);
+        REQUIRE(produced->clear_count == 1);
+    }
+
+    SECTION("Merge hands over factories which already hold data") {
+        JFactorySet sut;
+        JFactorySet other;
+        auto factory = new ClearCountingFactory("merged");
+        other.Add(factory);
+        factory->Insert(new DummyObject(22));
+
+        sut.Merge(other);
+        other.Release();
+        REQUIRE(factory->clear_count == 0);
+        sut.Release();
+        REQUIRE(factory->clear_count == 1);
+        REQUIRE(factory->GetNumObjects() == 0);
+    }
+}
+
+
+template <int N>
+struct LookupBenchmarkObject : public JObject {};
+
+/// LookupBenchmarkFactorySet exposes the (typeid, tag) map lookup which typed getters used before factory ids
+struct LookupBenchmarkFactorySet : public JFactorySet {
+    template <typename T>
+    JFactoryT<T>* GetFactoryFromMap(const std::string& tag = "") const {
+        auto it = mFactories.find(std::make_pair(std::type_index(typeid(T)), tag));
+        return (it != std::end(mFactories)) ? static_cast<JFactoryT<T>*>(it->second) : nullptr;
+    }
+};
+
+template <int... Ns>
+void add_lookup_benchmark_factories(JFactorySet& factory_set) {
+    std::initializer_list<int> ignored = {
+        (factory_set.Add(new JFactoryT<LookupBenchmarkObject<Ns>>()),
+         factory_set.Add(make_tagged_factory<LookupBenchmarkObject<Ns>>("tagged")), 0)...
+    };
+    (void) ignored;
+}
+
+TEST_CASE("FactoryLookupBenchmark", "[.][performance]") {
+
+    // A reconstruction chain's worth of factories, so that the map is a few levels deep
+    LookupBenchmarkFactorySet sut;
+    add_lookup_benchmark_factories<0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,31>(sut);
+
+    const size_t iterations = 10000000;
+    size_t found = 0;
+    auto map_untagged = ns_per_iteration(iterations, [&]{ found += sut.GetFactoryFromMap<LookupBenchmarkObject<17>>() != nullptr; });
+    auto id_untagged = ns_per_iteration(iterations, [&]{ found += sut.GetFactory<LookupBenchmarkObject<17>>() != nullptr; });
+    auto map_tagged = ns_per_iteration(iterations, [&]{ found += sut.GetFactoryFromMap<LookupBenchmarkObject<17>>("tagged") != nullptr; });
+    auto id_tagged = ns_per_iteration(iterations, [&]{ found += sut.GetFactory<LookupBenchmarkObject<17>>("tagged") != nullptr; });
+    REQUIRE(found == 4 * iterations);
+
+    std::cout << "Factory lookup (64 factories)" << std::endl;
+    std::cout << "  untagged:  map " << map_untagged << " ns, id " << id_untagged << " ns" << std::endl;
+    std::cout << "  tagged:    map " << map_tagged << " ns, id " << id_tagged << " ns" << std::endl;
+}
+
+
+struct SharedEventObject : public JObject {
+    int value;
+    explicit SharedEventObject(int value) : value(value) {}
+};
+
+/// SharedEventFactory is slow enough that concurrent callers really do pile up inside Process()
+struct SharedEventFactory : public JFactoryT<SharedEventObject> {
+    std::atomic<int> process_count {0};
+    std::atomic<int> active_count {0};
+    std::atomic<int> max_active_count {0};
+    bool fail_once = false;
+
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        int active = ++active_count;
+        if (active > max_active_count) max_active_count = active;
+        process_count++;
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+        if (fail_once) {
+            fail_once = false;
+            active_count--;
+            throw JException("Failing once on purpose");
+        }
+        for (int i=0; i<10; ++i) {
+            Insert(new SharedEventObject(event->GetEventNumber() + i));
+        }
+        active_count--;
+    }
+};
+
+struct SelfDependentFactory : public JFactoryT<UnregisteredObject> {
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        event->Get<UnregisteredObject>();
+    }
+};
+
+TEST_CASE("Concurrent GetOrCreate on a shared event") {
+
+    auto event = std::make_shared<JEvent>();
+    auto factory = new SharedEventFactory;
+    event->SetFactorySet(new JFactorySet);
+    event->GetFactorySet()->Add(factory);
+    event->GetFactorySet()->SetConcurrent(true);
+
+    SECTION("Exactly one thread runs Process(), and everybody sees its complete results") {
+        const int thread_count = 8;
+        const int event_count = 200;
+        std::atomic<int> mismatch_count {0};
+
+        for (int event_nr=0; event_nr<event_count; ++event_nr) {
+            event->SetEventNumber(event_nr);
+            std::vector<std::thread> threads;
+            for (int t=0; t<thread_count; ++t) {
+                threads.emplace_back([&]() {
+                    auto objs = event->Get<SharedEventObject>();
+                    if (objs.size() != 10 || objs[9]->value != event_nr + 9) mismatch_count++;
+                });
+            }
+            for (auto& thread : threads) thread.join();
+            event->GetFactorySet()->Release();
+        }
+        REQUIRE(factory->process_count == event_count);
+        REQUIRE(factory->max_active_count == 1);
+        REQUIRE(mismatch_count == 0);
+    }
+
+    SECTION("When Process() throws, whoever asks next tries again") {
+        factory->fail_once = true;
+        REQUIRE_THROWS_AS(event->Get<SharedEventObject>(), JException);
+        REQUIRE(event->Get<SharedEventObject>().size() == 10);
+        REQUIRE(factory->process_count == 2);
+    }
+
+    SECTION("A factory which depends on itself fails instead of hanging") {
+        event->GetFactorySet()->Add(new SelfDependentFactory);
+        REQUIRE_THROWS_AS(event->Get<UnregisteredObject>(), JException);
+    }
+
+    SECTION("A factory which depends on itself fails without concurrency too") {
+        event->GetFactorySet()->SetConcurrent(false);
+        event->GetFactorySet()->Add(new SelfDependentFactory);
+        REQUIRE_THROWS_AS(event->Get<UnregisteredObject>(), JException);
+        REQUIRE(event->Get<SharedEventObject>().size() == 10);
+    }
+}
@@ -6,6 +6,8 @@
 
 #include <JANA/JObject.h>
 
+#include <algorithm>
+
 class SillyObject : public JObject {
 public:
     JOBJECT_PUBLIC(SillyObject)
@@ -17,3 +19,86 @@ TEST_CASE("JObject::className") {
     REQUIRE(sut.className() == "SillyObject");
 }
 
+
+struct AssocHit : public JObject {
+    JOBJECT_PUBLIC(AssocHit)
+    int cell;
+    explicit AssocHit(int cell) : cell(cell) {}
+};
+
+struct AssocCluster : public JObject {
+    JOBJECT_PUBLIC(AssocCluster)
+};
+
+struct DeletionTracker : public JObject {
+    bool* deleted;
+    explicit DeletionTracker(bool* deleted) : deleted(deleted) {}
+    ~DeletionTracker() override { *deleted = true; }
+};
+
+TEST_CASE("JObject associations") {
+
+    std::vector<AssocHit> hits;
+    for (int i=0; i<10; ++i) hits.emplace_back(i);
+    AssocCluster cluster;
+
+    SECTION("Associations behave like a set, whichever order they are added in") {
+        cluster.AddAssociatedObject(&hits[3]);
+        cluster.AddAssociatedObject(&hits[1]);
+        cluster.AddAssociatedObject(&hits[7]);
+        cluster.AddAssociatedObject(&hits[1]);
+        cluster.AddAssociatedObject(&hits[5]);
+
+        auto found = cluster.Get<AssocHit>();
+        REQUIRE(found.size() == 4);
+        REQUIRE(std::is_sorted(found.begin(), found.end()));
+        REQUIRE(cluster.IsAssociated(&hits[7]));
+        REQUIRE(!cluster.IsAssociated(&hits[0]));
+
+        cluster.RemoveAssociatedObject(&hits[7]);
+        cluster.RemoveAssociatedObject(&hits[0]);
+        REQUIRE(!cluster.IsAssociated(&hits[7]));
+        REQUIRE(cluster.Get<AssocHit>().size() == 3);
+
+        AssocCluster copy = cluster;
+        REQUIRE(copy.Get<AssocHit>() == cluster.Get<AssocHit>());
+    }
+
+    SECTION("AddAssociatedObjects links many objects at once, merging them with the existing ones") {
+        cluster.AddAssociatedObject(&hits[4]);
+        std::vector<const AssocHit*> batch {&hits[9], &hits[0], &hits[4], &hits[2], &hits[9]};
+        cluster.AddAssociatedObjects(batch);
+
+        auto found = cluster.Get<AssocHit>();
+        REQUIRE(found == std::vector<const AssocHit*>{&hits[0], &hits[2], &hits[4], &hits[9]});
+
+        std::vector<const AssocHit*> more {&hits[1], &hits[8]};
+        cluster.AddAssociatedObjects(more);
+        REQUIRE(cluster.Get<AssocHit>().size() == 6);
+        REQUIRE(cluster.IsAssociated(&hits[8]));
+    }
+
+    SECTION("Associations are searched recursively, and matched by name") {
+        AssocCluster supercluster;
+        supercluster.AddAssociatedObject(&cluster);
+        cluster.AddAssociatedObject(&hits[6]);
+        hits[6].AddAssociatedObject(&cluster);  // Cycles don't matter
+
+        std::vector<const AssocHit*> found;
+        supercluster.Get(found);
+        REQUIRE(found == std::vector<const AssocHit*>{&hits[6]});
+        supercluster.Get(found, "", 1);
+        REQUIRE(found.empty());
+        REQUIRE(hits[6].GetSingle<AssocCluster>() == &cluster);
+    }
+
+    SECTION("ClearAssociatedObjects deletes the objects which were added for auto-deletion") {
+        bool deleted = false;
+        cluster.AddAssociatedObjectAutoDelete(new DeletionTracker(&deleted));
+        cluster.AddAssociatedObject(&hits[0]);
+        REQUIRE(cluster.Get<DeletionTracker>().size() == 1);
+        cluster.ClearAssociatedObjects();
+        REQUIRE(deleted);
+        REQUIRE(cluster.Get<AssocHit>().empty());
+    }
+}
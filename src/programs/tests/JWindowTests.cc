@@ -0,0 +1,293 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include "catch.hpp"
+#include "BenchmarkUtils.h"
+
+#include <JANA/Streaming/JEventBuilder.h>
+#include <JANA/Streaming/JFixedWindow.h>
+#include <JANA/Streaming/JSessionWindow.h>
+#include <JANA/Streaming/JTrivialWindow.h>
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+/// A detector hit, as a streaming readout would send it
+struct TestHit : public JHitMessage {
+    DetectorId detector = 0;
+    Timestamp timestamp = 0;
+    TestHit() = default;
+    TestHit(DetectorId detector, Timestamp timestamp) : detector(detector), timestamp(timestamp) {}
+    char* as_buffer() override { return reinterpret_cast<char*>(&detector); }
+    const char* as_buffer() const override { return reinterpret_cast<const char*>(&detector); }
+    size_t get_buffer_capacity() const override { return sizeof(detector) + sizeof(timestamp); }
+    bool is_end_of_stream() const override { return false; }
+    DetectorId get_source_id() const override { return detector; }
+    Timestamp get_timestamp() const override { return timestamp; }
+    friend std::ostream& operator<<(std::ostream& os, const TestHit& hit) {
+        return os << "TestHit " << hit.detector << "@" << hit.timestamp;
+    }
+};
+
+/// Pulls an event out of window, and returns its hits as (detector, timestamp) pairs
+static bool pull(JWindow<TestHit>& window, std::vector<std::pair<DetectorId, Timestamp>>& hits) {
+    auto event = std::make_shared<JEvent>();
+    event->SetFactorySet(new JFactorySet);
+    hits.clear();
+    if (!window.pullEvent(*event)) return false;
+    for (auto hit : event->Get<TestHit>()) hits.emplace_back(hit->detector, hit->timestamp);
+    return true;
+}
+
+using Hits = std::vector<std::pair<DetectorId, Timestamp>>;
+
+
+TEST_CASE("JHitMergerTests") {
+
+    JHitMerger<TestHit> merger({10, 20, 30}, 0);
+
+    SECTION("Hits come out in timestamp order, once no detector can send anything earlier") {
+        merger.push(new TestHit(10, 5));
+        merger.push(new TestHit(10, 9));
+        merger.push(new TestHit(20, 3));
+        Timestamp timestamp;
+        REQUIRE(!merger.peek(timestamp));  // Detector 30 might still send something before 3
+        merger.push(new TestHit(30, 7));
+        REQUIRE(merger.get_watermark() == 3);
+        REQUIRE(!merger.peek(timestamp));  // Detector 20 might still send another hit at 3
+        merger.push_watermark(20, 8);
+        REQUIRE(merger.get_watermark() == 7);
+        std::vector<Timestamp> merged;
+        while (merger.peek(timestamp)) {
+            auto hit = merger.pop();
+            REQUIRE(hit->timestamp == timestamp);
+            merged.push_back(timestamp);
+            delete hit;
+        }
+        REQUIRE(merged == std::vector<Timestamp>{3, 5});
+        merger.finish_all();
+        while (merger.peek(timestamp)) {
+            merged.push_back(timestamp);
+            delete merger.pop();
+        }
+        REQUIRE(merged == std::vector<Timestamp>{3, 5, 7, 9});
+        REQUIRE(merger.is_finished());
+    }
+
+    SECTION("Hits behind their detector's watermark are dropped as late") {
+        merger.push(new TestHit(10, 5));
+        merger.push_watermark(20, 100);
+        merger.push(new TestHit(10, 4));
+        merger.push(new TestHit(20, 99));
+        merger.push(new TestHit(20, 100));
+        REQUIRE(merger.get_late_count() == 2);
+        REQUIRE(merger.get_pending_count() == 2);
+    }
+
+    SECTION("Unknown detectors are an error") {
+        TestHit* hit = new TestHit(40, 1);
+        REQUIRE_THROWS_AS(merger.push(hit), JException);
+        delete hit;
+    }
+}
+
+TEST_CASE("JFixedWindowTests") {
+
+    JFixedWindow<TestHit> window(10, {1, 2});
+    Hits hits;
+
+    SECTION("Hits from all detectors are grouped into buckets") {
+        for (auto t : {1, 4, 12, 35}) window.pushMessage(new TestHit(1, t));
+        for (auto t : {2, 8, 11, 19}) window.pushMessage(new TestHit(2, t));
+
+        REQUIRE(pull(window, hits));
+        REQUIRE(hits == Hits{{1, 1}, {2, 2}, {1, 4}, {2, 8}});
+        REQUIRE(!pull(window, hits));  // Detector 2 might still send something before 20
+        window.pushWatermark(2, 40);
+        REQUIRE(pull(window, hits));
+        REQUIRE(hits == Hits{{2, 11}, {1, 12}, {2, 19}});
+        REQUIRE(!pull(window, hits));  // The empty buckets in between are skipped, but 35 might still get company
+        REQUIRE(!window.isFinished());
+        window.finish();
+        REQUIRE(pull(window, hits));
+        REQUIRE(hits == Hits{{1, 35}});
+        REQUIRE(!pull(window, hits));
+        REQUIRE(window.isFinished());
+    }
+
+    SECTION("A quiet detector holds things up only until max_pending hits are waiting") {
+        JFixedWindow<TestHit> bounded(10, {1, 2}, 5);
+        for (Timestamp t=0; t<100; t+=5) bounded.pushMessage(new TestHit(1, t));
+        size_t event_count = 0;
+        while (pull(bounded, hits)) event_count++;
+        REQUIRE(event_count > 0);
+        REQUIRE(bounded.getMerger().get_pending_count() <= 5);
+        REQUIRE(bounded.getMerger().get_forced_count() > 0);
+        bounded.pushMessage(new TestHit(2, 1));  // Much too late
+        REQUIRE(bounded.getMerger().get_late_count() == 1);
+    }
+}
+
+TEST_CASE("JSessionWindowTests") {
+
+    Hits hits;
+
+    SECTION("Events end at the first gap longer than event_interval") {
+        JSessionWindow<TestHit> window(5, {1, 2});
+        for (auto t : {100, 104, 120, 200}) window.pushMessage(new TestHit(1, t));
+        for (auto t : {102, 109, 115, 126}) window.pushMessage(new TestHit(2, t));
+        window.pushWatermark(2, 300);
+
+        REQUIRE(pull(window, hits));
+        REQUIRE(hits == Hits{{1, 100}, {2, 102}, {1, 104}, {2, 109}});
+        REQUIRE(pull(window, hits));
+        REQUIRE(hits == Hits{{2, 115}, {1, 120}});
+        REQUIRE(pull(window, hits));
+        REQUIRE(hits == Hits{{2, 126}});
+        REQUIRE(!pull(window, hits));  // Detector 1 might still send something within 5 of 200
+        window.pushWatermark(1, 205);
+        REQUIRE(!pull(window, hits));
+        window.pushWatermark(1, 206);
+        REQUIRE(pull(window, hits));
+        REQUIRE(hits == Hits{{1, 200}});
+    }
+
+    SECTION("A continuous stream is cut into events of at most max_width") {
+        JSessionWindow<TestHit> window(5, {1}, 20);
+        for (Timestamp t=0; t<100; t+=3) window.pushMessage(new TestHit(1, t));
+        window.finish();
+        size_t hit_count = 0;
+        while (pull(window, hits)) {
+            REQUIRE(hits.back().second - hits.front().second < 20);
+            hit_count += hits.size();
+        }
+        REQUIRE(hit_count == 34);
+        REQUIRE(window.isFinished());
+    }
+}
+
+
+/// Replays a list of hits, the way a ZMQ subscription to the detectors' readout would deliver them
+struct HitReplayTransport : public JTransport {
+    std::vector<TestHit> hits;
+    size_t next = 0, poll_count = 0;
+    void initialize() override {}
+    Result send(const JMessage&) override { return Result::FAILURE; }
+    Result receive(JMessage& message) override {
+        if (next == hits.size()) return Result::FINISHED;
+        if (poll_count++ % 7 == 3) return Result::TRY_AGAIN;  // Every now and then, nothing has arrived yet
+        static_cast<TestHit&>(message) = hits[next++];
+        return Result::SUCCESS;
+    }
+};
+
+struct EvenTrigger : public JTrigger {
+    bool accept(JEvent& event) final { return event.Get<TestHit>().size() % 2 == 0; }
+};
+
+TEST_CASE("JEventBuilderTests") {
+
+    auto transport = new HitReplayTransport;
+    for (Timestamp t=0; t<1000; t+=7) {
+        transport->hits.emplace_back(1, t);
+        transport->hits.emplace_back(2, t + 3);
+    }
+    auto event = std::make_shared<JEvent>();
+    event->SetFactorySet(new JFactorySet);
+
+    auto drain = [&](JEventSource& source, size_t& hit_count) {
+        size_t event_count = 0;
+        while (true) {
+            auto status = source.TryGetEvent(event);
+            if (status == JEventSource::ReturnStatus::Finished) return event_count;
+            if (status == JEventSource::ReturnStatus::Success) {
+                REQUIRE(event->GetEventNumber() >= event_count);
+                hit_count += event->Get<TestHit>().size();
+                event_count++;
+                event->GetFactorySet()->Release();
+            }
+        }
+    };
+
+    SECTION("Fixed windows") {
+        JEventBuilder<TestHit> builder((std::unique_ptr<JTransport>(transport)), std::unique_ptr<JTrigger>(new JTrigger),
+                                       std::unique_ptr<JWindow<TestHit>>(new JFixedWindow<TestHit>(100, {1, 2})));
+        builder.Open();
+        size_t hit_count = 0;
+        REQUIRE(drain(builder, hit_count) == 10);
+        REQUIRE(hit_count == 2 * 143);
+    }
+
+    SECTION("The trigger throws away events") {
+        JEventBuilder<TestHit> builder((std::unique_ptr<JTransport>(transport)), std::unique_ptr<JTrigger>(new EvenTrigger),
+                                       std::unique_ptr<JWindow<TestHit>>(new JSessionWindow<TestHit>(2, {1, 2})));
+        builder.Open();
+        size_t hit_count = 0;
+        REQUIRE(drain(builder, hit_count) == 0);  // Every event holds one hit, because they are 3 and 4 apart
+    }
+
+    SECTION("By default, every message becomes an event") {
+        JEventBuilder<TestHit> builder((std::unique_ptr<JTransport>(transport)));
+        builder.Open();
+        size_t hit_count = 0;
+        REQUIRE(drain(builder, hit_count) == 2 * 143);
+        REQUIRE(hit_count == 2 * 143);
+    }
+}
+
+
+TEST_CASE("EventBuilderBenchmark", "[.][performance]") {
+
+    const size_t hits_per_detector = 200000;
+    const size_t batch_size = 64;  // Each detector's readout delivers its hits in batches of this many
+
+    for (size_t detector_count : {4, 16, 64}) {
+
+        // Each detector sees hits at random intervals averaging 100 ticks, so roughly detector_count hits per 100 ticks
+        std::vector<std::vector<TestHit>> streams(detector_count);
+        std::mt19937_64 rng(detector_count);
+        std::exponential_distribution<double> gaps(1.0 / 100);
+        for (size_t d=0; d<detector_count; ++d) {
+            Timestamp t = 0;
+            for (size_t i=0; i<hits_per_detector; ++i) {
+                t += 1 + static_cast<Timestamp>(gaps(rng));
+                streams[d].emplace_back(d, t);
+            }
+        }
+        std::vector<DetectorId> detectors;
+        for (size_t d=0; d<detector_count; ++d) detectors.push_back(d);
+
+        auto measure = [&](const char* name, JWindow<TestHit>& window) {
+            auto event = std::make_shared<JEvent>();
+            event->SetFactorySet(new JFactorySet);
+            size_t event_count = 0;
+            size_t hit_count = 0;
+            const size_t batch_count = (hits_per_detector + batch_size - 1) / batch_size;
+            size_t batch_start = 0;
+            auto ns_per_batch = ns_per_iteration(batch_count, [&]{
+                for (size_t d=0; d<detector_count; ++d) {
+                    for (size_t i=batch_start; i<batch_start+batch_size && i<hits_per_detector; ++i) {
+                        window.pushMessage(new TestHit(streams[d][i]));
+                    }
+                }
+                batch_start += batch_size;
+                if (batch_start >= hits_per_detector) window.finish();
+                while (window.pullEvent(*event)) {
+                    event_count++;
+                    hit_count += event->Get<TestHit>().size();
+                    event->GetFactorySet()->Release();
+                }
+            });
+            REQUIRE(hit_count == detector_count * hits_per_detector);
+            std::cout << detector_count << " detectors, " << name << ": " << ns_per_batch * batch_count / hit_count
+                      << " ns per hit, " << event_count << " events" << std::endl;
+        };
+
+        JFixedWindow<TestHit> fixed(1000, detectors);
+        measure("JFixedWindow(1000)", fixed);
+        JSessionWindow<TestHit> session(20, detectors, 2000);
+        measure("JSessionWindow(20)", session);
+    }
+}
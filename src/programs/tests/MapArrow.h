@@ -90,6 +90,10 @@ public:
     size_t get_threshold() final { return _input_queue->get_threshold(); }
 
     void set_threshold(size_t threshold) final { _input_queue->set_threshold(threshold); }
+
+    size_t get_output_pending() final { return _output_queue->size(); }
+
+    size_t get_output_threshold() final { return _output_queue->get_threshold(); }
 };
 
 
@@ -6,7 +6,12 @@
 
 #include <JANA/Engine/JArrowTopology.h>
 #include <JANA/Engine/JArrowProcessingController.h>
+#include <JANA/Engine/JWorkStealingScheduler.h>
+#include <JANA/Engine/JBackpressureScheduler.h>
 #include "PerformanceTests.h"
+#include "ExactlyOnceTests.h"
+
+#include <JANA/JApplication.h>
 
 TEST_CASE("MemoryBottleneckTest", "[.][performance]") {
 
@@ -84,3 +89,110 @@ TEST_CASE("MemoryBottleneckTest", "[.][performance]") {
 }
 
 
+/// Runs a deep pipeline to completion on nthreads, using the given scheduler, and reports
+/// throughput along with the number of events sitting in mailboxes (i.e. in flight).
+template <typename SchedulerT>
+void run_scheduler_benchmark(const std::string& name, int nthreads) {
+
+    PerfTestSource source;
+    std::vector<PerfTestMapper> mappers(4);
+    PerfTestReducer sink;
+
+    source.message_count_limit = 2000;
+    source.latency_ms = 0;
+    sink.latency_ms = 0;
+    for (auto& mapper : mappers) {
+        mapper.latency_ms = 1;
+    }
+    mappers[1].latency_ms = 2;  // Make one stage the bottleneck
+
+    JArrowTopology topology;
+    std::vector<JMailbox<Event*>*> queues;
+    for (size_t i=0; i<=mappers.size(); ++i) {
+        queues.push_back(new JMailbox<Event*>());
+    }
+    auto source_arrow = new SourceArrow<Event*>("source", source, queues[0]);
+    source_arrow->set_chunksize(1);
+    topology.sources.push_back(source_arrow);
+    topology.arrows.push_back(source_arrow);
+    for (size_t i=0; i<mappers.size(); ++i) {
+        auto arrow = new MapArrow<Event*,Event*>("map" + std::to_string(i), mappers[i], queues[i], queues[i+1]);
+        arrow->set_chunksize(1);
+        topology.arrows.push_back(arrow);
+    }
+    auto sink_arrow = new SinkArrow<Event*>("sink", sink, queues.back());
+    topology.sinks.push_back(sink_arrow);
+    topology.arrows.push_back(sink_arrow);
+    topology.set_active(true);
+
+    SchedulerT scheduler(topology.arrows);
+    scheduler.logger = JLogger(JLogger::Level::OFF);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int worker_id = 0; worker_id < nthreads; ++worker_id) {
+        threads.emplace_back([&, worker_id]() {
+            auto last_result = JArrowMetrics::Status::ComeBackLater;
+            JArrow* assignment = nullptr;
+            do {
+                assignment = scheduler.next_assignment(worker_id, assignment, last_result);
+                if (assignment != nullptr) {
+                    JArrowMetrics metrics;
+                    assignment->execute(metrics, 0);
+                    last_result = metrics.get_last_status();
+                }
+            } while (assignment != nullptr || topology.is_active());
+        });
+    }
+
+    size_t samples = 0, in_flight_sum = 0, in_flight_max = 0;
+    while (topology.is_active()) {
+        size_t in_flight = 0;
+        for (auto q : queues) in_flight += q->size();
+        in_flight_sum += in_flight;
+        in_flight_max = std::max(in_flight_max, in_flight);
+        samples++;
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << name << ": nthreads=" << nthreads
+              << ", throughput=" << source.message_count / elapsed << " Hz"
+              << ", avg in flight=" << ((samples == 0) ? 0 : in_flight_sum / samples)
+              << ", max in flight=" << in_flight_max << std::endl;
+}
+
+
+TEST_CASE("SchedulerPolicyBenchmark", "[.][performance]") {
+
+    for (int nthreads : {2, 4, 8}) {
+        run_scheduler_benchmark<JScheduler>("RoundRobin  ", nthreads);
+        run_scheduler_benchmark<JWorkStealingScheduler>("WorkStealing", nthreads);
+        run_scheduler_benchmark<JBackpressureScheduler>("Backpressure", nthreads);
+    }
+}
+
+
+TEST_CASE("EventProcessorChunksizeBenchmark", "[.][performance]") {
+
+    for (size_t chunksize : {1, 4, 16, 64}) {
+        JApplication app;
+        auto source = new SimpleSource("SimpleSource", &app);
+        source->event_limit = 2000000;
+        app.Add(source);
+        app.Add(new SimpleProcessor(&app));
+        app.SetParameterValue("jana:extended_report", 0);
+        app.SetParameterValue("jana:event_processor_chunksize", chunksize);
+        app.SetParameterValue("jana:event_pool_size", 256);  // Enough events in flight to fill every batch
+        app.SetTicker(false);
+
+        auto start = std::chrono::steady_clock::now();
+        app.Run(true);
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "event_processor_chunksize=" << chunksize
+                  << ", throughput=" << source->event_limit / elapsed << " Hz" << std::endl;
+    }
+}
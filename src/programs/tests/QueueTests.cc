@@ -3,9 +3,14 @@
 // Subject to the terms in the LICENSE file found in the top-level directory.
 
 #include <JANA/Engine/JMailbox.h>
+#include <JANA/Engine/JIdlePolicy.h>
+#include <JANA/Engine/JReorderWindow.h>
 
 #include "catch.hpp"
 
+#include <atomic>
+#include <thread>
+
 
 TEST_CASE("Queue: Basic functionality") {
     JMailbox<int> q;
@@ -35,3 +40,341 @@ TEST_CASE("Queue: Basic functionality") {
     REQUIRE(result == JMailbox<int>::Status::Ready);
 
 }
+
+
+TEST_CASE("Queue: Ring backend") {
+    JMailbox<int> q(10, 1, false, JMailbox<int>::Backend::Ring);
+    q.set_active(true);
+    REQUIRE(q.get_backend() == JMailbox<int>::Backend::Ring);
+
+    SECTION("Basic functionality matches the deque backend") {
+        int item = 22;
+        q.push(item, 0);
+        REQUIRE(q.size() == 1);
+
+        std::vector<int> items;
+        auto result = q.pop(items, 22);
+        REQUIRE(items.size() == 1);
+        REQUIRE(items[0] == 22);
+        REQUIRE(q.size() == 0);
+        REQUIRE(result == JMailbox<int>::Status::Empty);
+
+        std::vector<int> buffer {1,2,3};
+        q.push(buffer, 0);
+        REQUIRE(q.size() == 3);
+        REQUIRE(buffer.size() == 0);
+
+        items.clear();
+        result = q.pop(items, 2);
+        REQUIRE(items == std::vector<int>{1,2});
+        REQUIRE(q.size() == 1);
+        REQUIRE(result == JMailbox<int>::Status::Ready);
+
+        bool success;
+        result = q.pop(item, success);
+        REQUIRE(success);
+        REQUIRE(item == 3);
+        REQUIRE(result == JMailbox<int>::Status::Empty);
+
+        q.set_active(false);
+        result = q.pop(item, success);
+        REQUIRE(!success);
+        REQUIRE(result == JMailbox<int>::Status::Finished);
+    }
+
+    SECTION("Reservations are bounded by the threshold") {
+        REQUIRE(q.reserve(7) == 7);
+        REQUIRE(q.reserve(7) == 3);
+        REQUIRE(q.reserve(1) == 0);
+
+        std::vector<int> buffer {1,2,3,4,5};
+        auto result = q.push(buffer, 7);
+        REQUIRE(result == JMailbox<int>::Status::Ready);
+        REQUIRE(q.reserve(7) == 2);
+    }
+
+    SECTION("Pushes beyond the ring's capacity spill over without losing order") {
+        std::vector<int> buffer;
+        for (int i=0; i<100; ++i) buffer.push_back(i);
+        auto result = q.push(buffer);
+        REQUIRE(result == JMailbox<int>::Status::Full);
+        REQUIRE(q.size() == 100);
+
+        std::vector<int> items;
+        q.pop(items, 1000);
+        REQUIRE(items.size() == 100);
+        for (int i=0; i<100; ++i) {
+            REQUIRE(items[i] == i);
+        }
+        REQUIRE(q.size() == 0);
+    }
+
+    SECTION("Concurrent producers and consumers neither lose nor duplicate items") {
+        const int nthreads = 8;
+        const int items_per_thread = 5000;
+        std::atomic<long> popped_sum {0};
+        std::atomic<int> popped_count {0};
+        std::vector<std::thread> threads;
+
+        for (int t=0; t<nthreads; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int i=0; i<items_per_thread; ++i) {
+                    int item = t * items_per_thread + i;
+                    q.push(item);
+                    std::vector<int> items;
+                    q.pop(items, 2);
+                    for (int x : items) popped_sum += x;
+                    popped_count += items.size();
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+
+        std::vector<int> items;
+        q.pop(items, nthreads * items_per_thread);
+        for (int x : items) popped_sum += x;
+        popped_count += items.size();
+
+        long n = nthreads * items_per_thread;
+        REQUIRE(popped_count == n);
+        REQUIRE(popped_sum == n * (n - 1) / 2);
+        REQUIRE(q.size() == 0);
+    }
+}
+
+
+TEST_CASE("Queue: Work stealing across locations") {
+
+    using Backend = JMailbox<int>::Backend;
+    auto backend = GENERATE(Backend::Deque, Backend::Ring);
+
+    JMailbox<int> q(100, 3, true, backend);
+    q.set_active(true);
+    q.set_steal_order(0, {2, 1});
+
+    std::vector<int> far {1,2,3,4,5,6,7,8};
+    std::vector<int> near {10,20,30,40};
+    q.push(far, 0, 1);
+    q.push(near, 0, 2);
+
+    SECTION("An empty location steals a batch from its nearest sibling") {
+        std::vector<int> items;
+        auto result = q.pop(items, 1, 0);
+        REQUIRE(result == JMailbox<int>::Status::Ready);
+        REQUIRE(items == std::vector<int>{10});
+
+        // Half of the sibling's queue came over, so the surplus is now local
+        REQUIRE(q.get_steal_count(0) == 2);
+        REQUIRE(q.size(0) == 1);
+        REQUIRE(q.size(2) == 2);
+        REQUIRE(q.size(1) == 8);
+    }
+
+    SECTION("Single-item pops steal too") {
+        int item = 0;
+        bool success = false;
+        auto result = q.pop(item, success, 0);
+        REQUIRE(success);
+        REQUIRE(item == 10);
+        REQUIRE(result == JMailbox<int>::Status::Ready);
+
+        // The surplus went into our own queue, so the next pop is local
+        REQUIRE(q.size(0) == 1);
+        q.pop(item, success, 0);
+        REQUIRE(item == 20);
+        REQUIRE(q.get_steal_count(0) == 2);
+    }
+
+    SECTION("Stolen items are appended to whatever the caller's buffer already holds") {
+        std::vector<int> items {99};
+        q.pop(items, 2, 0);
+        REQUIRE(items == std::vector<int>{99,10,20});
+        REQUIRE(q.size(0) == 0);
+    }
+
+    SECTION("Once the nearest sibling is drained, farther siblings are visited") {
+        std::vector<int> items;
+        while (q.size(2) != 0 || q.size(0) != 0) {
+            q.pop(items, 4, 0);
+        }
+        REQUIRE(items == std::vector<int>{10,20,30,40});
+        items.clear();
+        q.pop(items, 4, 0);
+        REQUIRE(items == std::vector<int>{1,2,3,4});
+        REQUIRE(q.get_steal_count(0) == 8);
+        REQUIRE(q.get_steal_count(1) == 0);
+    }
+
+    SECTION("When stealing is disabled, locations stay isolated") {
+        JMailbox<int> isolated(100, 2, false, backend);
+        isolated.set_active(true);
+        std::vector<int> buffer {1,2,3};
+        isolated.push(buffer, 0, 1);
+        std::vector<int> items;
+        auto result = isolated.pop(items, 1, 0);
+        REQUIRE(items.empty());
+        REQUIRE(result == JMailbox<int>::Status::Empty);
+        REQUIRE(isolated.get_steal_count(0) == 0);
+    }
+}
+
+
+TEST_CASE("Queue: Backend throughput benchmark", "[.][performance]") {
+
+    using Backend = JMailbox<int>::Backend;
+    const size_t ops_per_thread = 100000;
+    const size_t chunksize = 4;
+
+    for (size_t nthreads : {1, 2, 4, 8, 16, 32, 64, 128}) {
+        for (Backend backend : {Backend::Deque, Backend::Ring}) {
+
+            JMailbox<int> q(1024, 1, false, backend);
+            q.set_active(true);
+            std::atomic<size_t> total_popped {0};
+            std::atomic<size_t> total_congested {0};
+            std::vector<std::thread> threads;
+
+            auto start = std::chrono::steady_clock::now();
+            for (size_t t=0; t<nthreads; ++t) {
+                threads.emplace_back([&]() {
+                    std::vector<int> buffer;
+                    size_t popped = 0, congested = 0;
+                    for (size_t i=0; i<ops_per_thread; i+=chunksize) {
+                        size_t reserved = q.reserve(chunksize);
+                        for (size_t j=0; j<reserved; ++j) buffer.push_back((int) j);
+                        q.push(buffer, reserved);
+                        buffer.clear();
+                        if (q.pop(buffer, chunksize) == JMailbox<int>::Status::Congested) {
+                            congested++;
+                        }
+                        popped += buffer.size();
+                        buffer.clear();
+                    }
+                    total_popped += popped;
+                    total_congested += congested;
+                });
+            }
+            for (auto& t : threads) t.join();
+            auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            std::cout << ((backend == Backend::Deque) ? "Deque" : "Ring ")
+                      << ": nthreads=" << nthreads
+                      << ", throughput=" << (2 * total_popped) / elapsed << " ops/s"
+                      << ", congested pops=" << total_congested << std::endl;
+        }
+    }
+}
+
+
+TEST_CASE("Queue: Pushes wake parked workers") {
+
+    JWakeupSignal signal;
+    JMailbox<int> q;
+    q.set_wakeup_signal(&signal);
+    q.set_active(true);
+
+    SECTION("A push after prepare_wait() is never missed") {
+        auto ticket = signal.prepare_wait();
+        REQUIRE(signal.get_waiter_count() == 1);
+        int item = 1;
+        q.push(item);
+        auto start = std::chrono::steady_clock::now();
+        REQUIRE(signal.wait(ticket, std::chrono::seconds(10)) == true);
+        REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+        REQUIRE(signal.get_waiter_count() == 0);
+    }
+
+    SECTION("Without a push, wait() times out") {
+        auto ticket = signal.prepare_wait();
+        REQUIRE(signal.wait(ticket, std::chrono::milliseconds(1)) == false);
+    }
+
+    SECTION("A parked thread is woken by a push from another thread") {
+        std::atomic_bool woken {false};
+        std::thread waiter([&]() {
+            auto ticket = signal.prepare_wait();
+            woken = signal.wait(ticket, std::chrono::seconds(10));
+        });
+        while (signal.get_waiter_count() == 0) {
+            std::this_thread::yield();
+        }
+        int item = 1;
+        q.push(item);
+        waiter.join();
+        REQUIRE(woken);
+    }
+
+    SECTION("Idle policy escalates from spinning to yielding to parking") {
+        JIdlePolicy policy;
+        policy.spin_tries = 2;
+        policy.yield_tries = 1;
+        REQUIRE(policy.get_phase(0) == JIdlePolicy::Phase::Spin);
+        REQUIRE(policy.get_phase(1) == JIdlePolicy::Phase::Spin);
+        REQUIRE(policy.get_phase(2) == JIdlePolicy::Phase::Yield);
+        REQUIRE(policy.get_phase(3) == JIdlePolicy::Phase::Park);
+        REQUIRE(policy.get_phase(100) == JIdlePolicy::Phase::Park);
+    }
+}
+
+
+TEST_CASE("Queue: Reorder window") {
+
+    JReorderWindow<int> window(4);
+    REQUIRE(window.get_capacity() == 4);
+
+    uint64_t indices[4];
+    for (auto& index : indices) {
+        REQUIRE(window.try_issue(index));
+    }
+
+    SECTION("Indices are issued consecutively until the window is full") {
+        REQUIRE(indices[0] == 0);
+        REQUIRE(indices[3] == 3);
+        uint64_t index;
+        REQUIRE(!window.try_issue(index));
+        REQUIRE(window.get_backpressure_count() == 1);
+    }
+
+    SECTION("Items come out in index order, no matter the order they went in") {
+        std::vector<int> out;
+        window.insert(2, 20);
+        window.insert(1, 10);
+        REQUIRE(window.pop_ready(out) == 0);
+        REQUIRE(window.get_occupancy() == 2);
+
+        window.insert(0, 0);
+        REQUIRE(window.pop_ready(out) == 3);
+        REQUIRE(out == std::vector<int>{0, 10, 20});
+        REQUIRE(window.get_occupancy() == 0);
+        REQUIRE(window.get_max_occupancy() == 3);
+
+        // Delivering items frees up room for more
+        uint64_t index;
+        REQUIRE(window.try_issue(index));
+        REQUIRE(index == 4);
+    }
+
+    SECTION("Skipped indices don't hold anything up") {
+        std::vector<int> out;
+        window.insert(1, 10);
+        window.skip(0);
+        window.insert(3, 30);
+        REQUIRE(window.pop_ready(out) == 1);
+        REQUIRE(out == std::vector<int>{10});
+        window.skip(2);
+        REQUIRE(window.pop_ready(out) == 1);
+        REQUIRE(out == std::vector<int>{10, 30});
+        REQUIRE(window.get_next_delivered() == 4);
+    }
+
+    SECTION("Head-of-line stalls are timed") {
+        REQUIRE(window.get_stall_time() == JReorderWindow<int>::clock_t::duration::zero());
+        window.insert(1, 10);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        window.insert(0, 0);
+        auto stall_time = window.get_stall_time();
+        REQUIRE(stall_time >= std::chrono::milliseconds(2));
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        REQUIRE(window.get_stall_time() == stall_time);  // No longer stalled
+    }
+}
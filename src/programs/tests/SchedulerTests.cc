@@ -6,6 +6,8 @@
 #include "catch.hpp"
 
 #include <JANA/Engine/JScheduler.h>
+#include <JANA/Engine/JWorkStealingScheduler.h>
+#include <JANA/Engine/JBackpressureScheduler.h>
 #include <TestTopologyComponents.h>
 #include <JANA/Engine/JArrowTopology.h>
 
@@ -209,3 +211,248 @@ TEST_CASE("SchedulerRoundRobinBehaviorTests") {
 }
 
 
+
+TEST_CASE("WorkStealingSchedulerTests") {
+
+    RandIntSource source;
+    MultByTwoProcessor p1;
+    SubOneProcessor p2;
+    SumSink<double> sink;
+
+    JArrowTopology topology;
+
+    auto q1 = new JMailbox<int>();
+    auto q2 = new JMailbox<double>();
+    auto q3 = new JMailbox<double>();
+
+    auto emit_rand_ints = new SourceArrow<int>("emit_rand_ints", source, q1);
+    auto multiply_by_two = new MapArrow<int,double>("multiply_by_two", p1, q1, q2);
+    auto subtract_one = new MapArrow<double,double>("subtract_one", p2, q2, q3);
+    auto sum_everything = new SinkArrow<double>("sum_everything", sink, q3);
+
+    topology.sources.push_back(emit_rand_ints);
+
+    topology.arrows.push_back(emit_rand_ints);
+    topology.arrows.push_back(multiply_by_two);
+    topology.arrows.push_back(subtract_one);
+    topology.arrows.push_back(sum_everything);
+
+    emit_rand_ints->set_chunksize(1);
+    topology.set_active(true);
+
+    JWorkStealingScheduler scheduler(topology.arrows);
+    scheduler.logger = JLogger(JLogger::Level::OFF);
+
+    SECTION("When run sequentially, WSS returns nullptr => topology finished") {
+
+        auto last_result = JArrowMetrics::Status::ComeBackLater;
+        JArrow* assignment = nullptr;
+        do {
+            assignment = scheduler.next_assignment(0, assignment, last_result);
+            if (assignment != nullptr) {
+                JArrowMetrics metrics;
+                assignment->execute(metrics, 0);
+                last_result = metrics.get_last_status();
+            }
+        } while (assignment != nullptr);
+
+        REQUIRE(emit_rand_ints->is_active() == false);
+        REQUIRE(multiply_by_two->is_active() == false);
+        REQUIRE(subtract_one->is_active() == false);
+        REQUIRE(sum_everything->is_active() == false);
+    }
+
+    SECTION("When there is only one worker, who always encounters ComeBackLater, assignments go round-robin") {
+
+        std::string ordering[] = {"emit_rand_ints", "multiply_by_two", "subtract_one", "sum_everything"};
+        JArrow* assignment = nullptr;
+        for (int i = 0; i < 10; ++i) {
+            assignment = scheduler.next_assignment(0, assignment, JArrowMetrics::Status::ComeBackLater);
+            REQUIRE(assignment != nullptr);
+            REQUIRE(assignment->get_name() == ordering[i % 4]);
+        }
+    }
+
+    SECTION("When a team of workers start off with (nullptr, ComeBackLater), sequential arrows are exclusive") {
+
+        std::map<std::string, int> assignment_counts;
+        for (int i = 0; i < 10; ++i) {
+            auto assignment = scheduler.next_assignment(i, nullptr, JArrowMetrics::Status::ComeBackLater);
+            REQUIRE (assignment != nullptr);
+            assignment_counts[assignment->get_name()]++;
+        }
+        REQUIRE(assignment_counts["emit_rand_ints"] == 1);
+        REQUIRE(assignment_counts["sum_everything"] == 1);
+        REQUIRE(assignment_counts["subtract_one"] + assignment_counts["multiply_by_two"] == 8);
+    }
+
+    SECTION("When the last worker on a finished arrow shuts down, the arrow still deactivates") {
+
+        // Drain the source, so that multiply_by_two's upstream finishes while a worker is still on it
+        JArrowMetrics metrics;
+        do {
+            emit_rand_ints->execute(metrics, 0);
+        } while (metrics.get_last_status() != JArrowMetrics::Status::Finished);
+
+        auto assignment = scheduler.next_assignment(0, nullptr, JArrowMetrics::Status::ComeBackLater);
+        REQUIRE(assignment == multiply_by_two);
+        do {
+            assignment->execute(metrics, 0);
+        } while (metrics.get_last_status() != JArrowMetrics::Status::Finished);
+        scheduler.last_assignment(0, assignment, JArrowMetrics::Status::Finished);
+        REQUIRE(multiply_by_two->get_thread_count() == 0);
+        REQUIRE(multiply_by_two->is_active() == false);
+    }
+
+    SECTION("When many threads run the topology concurrently, it still finishes") {
+
+        std::vector<std::thread> threads;
+        for (uint32_t worker_id = 0; worker_id < 8; ++worker_id) {
+            threads.emplace_back([&, worker_id]() {
+                auto last_result = JArrowMetrics::Status::ComeBackLater;
+                JArrow* assignment = nullptr;
+                do {
+                    assignment = scheduler.next_assignment(worker_id, assignment, last_result);
+                    if (assignment != nullptr) {
+                        JArrowMetrics metrics;
+                        assignment->execute(metrics, 0);
+                        last_result = metrics.get_last_status();
+                    }
+                } while (assignment != nullptr || topology.is_active());
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        REQUIRE(emit_rand_ints->get_thread_count() == 0);
+        REQUIRE(sum_everything->is_active() == false);
+    }
+}
+
+
+TEST_CASE("BackpressureSchedulerTests") {
+
+    RandIntSource source;
+    MultByTwoProcessor p1;
+    SubOneProcessor p2;
+    SumSink<double> sink;
+
+    JArrowTopology topology;
+
+    auto q1 = new JMailbox<int>();
+    auto q2 = new JMailbox<double>();
+    auto q3 = new JMailbox<double>();
+
+    auto emit_rand_ints = new SourceArrow<int>("emit_rand_ints", source, q1);
+    auto multiply_by_two = new MapArrow<int,double>("multiply_by_two", p1, q1, q2);
+    auto subtract_one = new MapArrow<double,double>("subtract_one", p2, q2, q3);
+    auto sum_everything = new SinkArrow<double>("sum_everything", sink, q3);
+
+    topology.sources.push_back(emit_rand_ints);
+
+    topology.arrows.push_back(emit_rand_ints);
+    topology.arrows.push_back(multiply_by_two);
+    topology.arrows.push_back(subtract_one);
+    topology.arrows.push_back(sum_everything);
+
+    emit_rand_ints->set_chunksize(1);
+    topology.set_active(true);
+
+    JBackpressureScheduler scheduler(topology.arrows);
+    scheduler.logger = JLogger(JLogger::Level::OFF);
+
+    SECTION("When run sequentially, BPS returns nullptr => topology finished") {
+
+        auto last_result = JArrowMetrics::Status::ComeBackLater;
+        JArrow* assignment = nullptr;
+        do {
+            assignment = scheduler.next_assignment(0, assignment, last_result);
+            if (assignment != nullptr) {
+                JArrowMetrics metrics;
+                assignment->execute(metrics, 0);
+                last_result = metrics.get_last_status();
+            }
+        } while (assignment != nullptr);
+
+        REQUIRE(emit_rand_ints->is_active() == false);
+        REQUIRE(multiply_by_two->is_active() == false);
+        REQUIRE(subtract_one->is_active() == false);
+        REQUIRE(sum_everything->is_active() == false);
+    }
+
+    SECTION("When all mailboxes are empty, the source is preferred") {
+        auto assignment = scheduler.next_assignment(0, nullptr, JArrowMetrics::Status::ComeBackLater);
+        REQUIRE(assignment == emit_rand_ints);
+    }
+
+    SECTION("When a mailbox has a backlog, its consumer is preferred over the source") {
+        std::vector<double> items(5, 1.0);
+        q2->push(items);
+        REQUIRE(scheduler.score(subtract_one, 0) > scheduler.score(emit_rand_ints, 0));
+        auto assignment = scheduler.next_assignment(0, nullptr, JArrowMetrics::Status::ComeBackLater);
+        REQUIRE(assignment == subtract_one);
+    }
+
+    SECTION("When a mailbox is full, its producer is backpressured") {
+        std::vector<int> items(q1->get_threshold(), 1);
+        q1->push(items);
+        REQUIRE(scheduler.score(emit_rand_ints, 0) == 0);
+        auto assignment = scheduler.next_assignment(0, nullptr, JArrowMetrics::Status::ComeBackLater);
+        REQUIRE(assignment == multiply_by_two);
+    }
+
+    SECTION("When a team of workers start off with (nullptr, ComeBackLater), sequential arrows are exclusive") {
+
+        std::map<std::string, int> assignment_counts;
+        for (int i = 0; i < 10; ++i) {
+            auto assignment = scheduler.next_assignment(i, nullptr, JArrowMetrics::Status::ComeBackLater);
+            REQUIRE (assignment != nullptr);
+            assignment_counts[assignment->get_name()]++;
+        }
+        REQUIRE(assignment_counts["emit_rand_ints"] == 1);
+        REQUIRE(assignment_counts["sum_everything"] == 1);
+        REQUIRE(assignment_counts["subtract_one"] + assignment_counts["multiply_by_two"] == 8);
+    }
+
+    SECTION("When the last worker on a finished arrow shuts down, the arrow still deactivates") {
+
+        // Drain the source, so that multiply_by_two's upstream finishes while a worker is still on it
+        JArrowMetrics metrics;
+        do {
+            emit_rand_ints->execute(metrics, 0);
+        } while (metrics.get_last_status() != JArrowMetrics::Status::Finished);
+
+        auto assignment = scheduler.next_assignment(0, nullptr, JArrowMetrics::Status::ComeBackLater);
+        REQUIRE(assignment == multiply_by_two);
+        do {
+            assignment->execute(metrics, 0);
+        } while (metrics.get_last_status() != JArrowMetrics::Status::Finished);
+        scheduler.last_assignment(0, assignment, JArrowMetrics::Status::Finished);
+        REQUIRE(multiply_by_two->get_thread_count() == 0);
+        REQUIRE(multiply_by_two->is_active() == false);
+    }
+
+    SECTION("When many threads run the topology concurrently, it still finishes") {
+
+        std::vector<std::thread> threads;
+        for (uint32_t worker_id = 0; worker_id < 8; ++worker_id) {
+            threads.emplace_back([&, worker_id]() {
+                auto last_result = JArrowMetrics::Status::ComeBackLater;
+                JArrow* assignment = nullptr;
+                do {
+                    assignment = scheduler.next_assignment(worker_id, assignment, last_result);
+                    if (assignment != nullptr) {
+                        JArrowMetrics metrics;
+                        assignment->execute(metrics, 0);
+                        last_result = metrics.get_last_status();
+                    }
+                } while (assignment != nullptr || topology.is_active());
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        REQUIRE(emit_rand_ints->get_thread_count() == 0);
+        REQUIRE(sum_everything->is_active() == false);
+    }
+}
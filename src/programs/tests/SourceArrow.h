@@ -90,6 +90,10 @@ public:
         }
         result.update(status, message_count, 1, latency, overhead);
     }
+
+    size_t get_output_pending() final { return _output_queue->size(); }
+
+    size_t get_output_threshold() final { return _output_queue->get_threshold(); }
 };
 
 
@@ -7,6 +7,10 @@
 #include <TestTopologyComponents.h>
 #include <JANA/Utils/JPerfUtils.h>
 #include <JANA/Engine/JArrowTopology.h>
+#include <JANA/Engine/JArrowProcessingController.h>
+#include <JANA/Engine/JTopologyBuilder.h>
+#include <JANA/JApplication.h>
+#include "ExactlyOnceTests.h"
 
 
 JArrowMetrics::Status step(JArrow* arrow) {
@@ -240,3 +244,150 @@ TEST_CASE("JTopology: Basic functionality") {
 
     }
 }
+
+
+struct ResourceProcessor : public JEventProcessor {
+
+    std::atomic_int in_flight {0};
+    std::atomic_int max_in_flight {0};
+    std::atomic_int process_count {0};
+    std::vector<uint64_t> event_indices;  // Only recorded by ordered processors, which run sequentially
+
+    explicit ResourceProcessor(std::string resource_name, bool ordered=false) {
+        SetResourceName(std::move(resource_name));
+        SetEventsOrdered(ordered);
+    }
+
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        if (AreEventsOrdered()) {
+            event_indices.push_back(event->GetEventIndex());
+        }
+        int current = ++in_flight;
+        int observed = max_in_flight;
+        while (current > observed && !max_in_flight.compare_exchange_weak(observed, current));
+        std::this_thread::yield();
+        process_count++;
+        --in_flight;
+    }
+};
+
+
+TEST_CASE("JTopology: Processors are pipelined by resource name") {
+
+    auto unnamed = new ResourceProcessor("");
+    auto root_writer = new ResourceProcessor("ROOT");
+    auto csv_writer = new ResourceProcessor("CSV");
+    auto other_root_writer = new ResourceProcessor("ROOT");
+
+    SECTION("Processors are grouped by resource name, unnamed first") {
+        auto groups = JTopologyBuilder::group_processors_by_resource({root_writer, unnamed, csv_writer, other_root_writer});
+        REQUIRE(groups.size() == 3);
+        REQUIRE(groups[0].resource_name.empty());
+        REQUIRE(groups[0].processors == std::vector<JEventProcessor*>{unnamed});
+        REQUIRE(groups[1].resource_name == "ROOT");
+        REQUIRE(groups[1].processors == std::vector<JEventProcessor*>{root_writer, other_root_writer});
+        REQUIRE(groups[2].resource_name == "CSV");
+
+        auto named_only = JTopologyBuilder::group_processors_by_resource({csv_writer});
+        REQUIRE(named_only.size() == 1);
+        REQUIRE(named_only[0].resource_name == "CSV");
+
+        auto ordered_writer = new ResourceProcessor("ROOT", true);
+        auto with_ordered = JTopologyBuilder::group_processors_by_resource({ordered_writer, root_writer});
+        REQUIRE(with_ordered.size() == 2);
+        REQUIRE(with_ordered[0].resource_name == "ROOT");
+        REQUIRE(!with_ordered[0].is_ordered);
+        REQUIRE(with_ordered[1].is_ordered);
+        REQUIRE(with_ordered[1].processors == std::vector<JEventProcessor*>{ordered_writer});
+        delete ordered_writer;
+
+        auto no_processors = JTopologyBuilder::group_processors_by_resource({});
+        REQUIRE(no_processors.size() == 1);
+        delete unnamed; delete root_writer; delete csv_writer; delete other_root_writer;
+    }
+
+    SECTION("Every stage sees every event, and resource stages never run concurrently") {
+        JApplication app;
+        auto source = new SimpleSource("SimpleSource", &app);
+        source->event_limit = 200;
+        app.Add(source);
+        app.Add(unnamed);
+        app.Add(root_writer);
+        app.Add(csv_writer);
+        app.Add(other_root_writer);
+        app.SetParameterValue("nthreads", 4);
+        app.SetParameterValue("jana:extended_report", 0);
+        app.SetParameterValue("jana:event_pool_size", 16);
+        app.SetTicker(false);
+        app.Initialize();
+        auto summary = app.GetService<JArrowProcessingController>()->measure_internal_performance();
+        std::map<std::string, bool> is_parallel;
+        for (auto& arrow : summary->arrows) {
+            is_parallel[arrow.arrow_name] = arrow.is_parallel;
+        }
+        REQUIRE(is_parallel.size() == 4);
+        REQUIRE(is_parallel["processors"] == true);
+        REQUIRE(is_parallel["processors:ROOT"] == false);
+        REQUIRE(is_parallel["processors:CSV"] == false);
+
+        app.Run(true);
+
+        for (auto proc : {unnamed, root_writer, csv_writer, other_root_writer}) {
+            REQUIRE(proc->process_count == 199);
+        }
+        REQUIRE(root_writer->max_in_flight == 1);
+        REQUIRE(csv_writer->max_in_flight == 1);
+    }
+}
+
+
+TEST_CASE("JTopology: Ordered processors see events in emission order") {
+
+    auto window_size = GENERATE(0, 3);
+
+    JApplication app;
+    auto source = new SimpleSource("SimpleSource", &app);
+    source->event_limit = 300;
+    auto unordered = new ResourceProcessor("");
+    auto ordered = new ResourceProcessor("", true);
+    app.Add(source);
+    app.Add(unordered);
+    app.Add(ordered);
+    app.SetParameterValue("nthreads", 4);
+    app.SetParameterValue("jana:extended_report", 0);
+    app.SetParameterValue("jana:event_pool_size", 16);
+    app.SetParameterValue("jana:event_reorder_window", window_size);
+    app.SetTicker(false);
+    app.Run(true);
+
+    REQUIRE(unordered->process_count == 299);
+    REQUIRE(ordered->event_indices.size() == 299);
+    for (size_t i=0; i<ordered->event_indices.size(); ++i) {
+        REQUIRE(ordered->event_indices[i] == i);
+    }
+    REQUIRE(ordered->max_in_flight == 1);
+}
+
+
+TEST_CASE("JTopology: event_pool_size bounds the whole pool") {
+
+    auto partition_size = GENERATE(0, 3);
+
+    JApplication app;
+    app.Add(new SimpleSource("SimpleSource", &app));
+    app.Add(new SimpleSource("OtherSource", &app));
+    app.SetParameterValue("nthreads", 1);
+    app.SetParameterValue("jana:event_pool_size", 8);
+    app.SetParameterValue("jana:event_pool_partition_size", partition_size);
+    app.SetTicker(false);
+    app.Initialize();
+
+    auto topology = app.GetService<JTopologyBuilder>()->build(1);
+    if (partition_size == 0) {
+        REQUIRE(topology->event_pool->size() == 4);  // Split evenly between the two sources
+    }
+    else {
+        REQUIRE(topology->event_pool->size() == 3);
+    }
+    delete topology;
+}